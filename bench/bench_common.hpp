@@ -0,0 +1,259 @@
+#ifndef BENCH_COMMON_HPP
+#define BENCH_COMMON_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstddef>
+#include <cstring>
+#include <new>
+#include <string>
+#include <vector>
+
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+///Shared helpers for the benchmark programs in this directory
+///--- ( EACH BENCHMARK IS A SINGLE TRANSLATION UNIT - THIS HEADER REPLACES GLOBAL NEW/DELETE )
+namespace bench
+{
+    ///-------------------------------------------------------------------------------------------------------
+    ///ALLOCATION TRACKING
+
+    ///Bytes currently allocated through global new and the peak since last reset
+    struct alloc_stats
+    {
+        size_t live = 0;
+        size_t peak = 0;
+    };
+
+    static alloc_stats g_alloc;
+
+    ///Resets the peak to the current live byte count
+    static inline void
+        reset_alloc_peak()
+    {
+        g_alloc.peak = g_alloc.live;
+    };
+
+    ///realloc() keeping the global new size prefix, so stripe_map slot arrays count toward live and peak bytes
+    static inline void*
+        tracked_realloc(void* ptr,
+                        const size_t size)
+    {
+        size_t* block = ptr != nullptr ? reinterpret_cast<size_t*>(static_cast<char*>(ptr) - sizeof(std::max_align_t)) : nullptr;
+        const size_t oldsize = block != nullptr ? *block : 0;
+
+        block = static_cast<size_t*>(std::realloc(block, size + sizeof(std::max_align_t)));
+        if ( block == nullptr )
+            return nullptr;
+
+        *block = size;
+        g_alloc.live = g_alloc.live - oldsize + size;
+        if ( g_alloc.live > g_alloc.peak )
+            g_alloc.peak = g_alloc.live;
+
+        return reinterpret_cast<char*>(block) + sizeof(std::max_align_t);
+    };
+    ///Frees blocks of tracked_realloc()
+    static inline void
+        tracked_free(void* ptr)
+    {
+        if ( ptr == nullptr )
+            return;
+
+        size_t* block = reinterpret_cast<size_t*>(static_cast<char*>(ptr) - sizeof(std::max_align_t));
+        g_alloc.live -= *block;
+        std::free(block);
+    };
+
+    ///-------------------------------------------------------------------------------------------------------
+    ///TIMING
+
+    using clock = std::chrono::steady_clock;
+
+    ///Nanoseconds between two clock samples
+    static inline double
+        elapsed_ns(const clock::time_point before,
+                   const clock::time_point after)
+    {
+        return std::chrono::duration<double, std::nano>(after - before).count();
+    };
+
+    ///Returns the given percentile ( 0-100 ) of samples ( SORTS SAMPLES )
+    static inline double
+        percentile(std::vector<double>& samples,
+                   const double pct)
+    {
+        if ( samples.empty() )
+            return 0.0;
+
+        std::sort(samples.begin(), samples.end());
+
+        const size_t rank = static_cast<size_t>(pct * 0.01 * (samples.size() - 1) + 0.5);
+
+        return samples[std::min(rank, samples.size() - 1)];
+    };
+
+    ///Peak resident set size of this process in bytes
+    static inline size_t
+        peak_rss_bytes()
+    {
+        rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+
+        return static_cast<size_t>(usage.ru_maxrss) * 1024;
+    };
+
+    ///-------------------------------------------------------------------------------------------------------
+    ///ISOLATION
+
+    ///Runs func in a forked child so peak RSS and allocator state are per-configuration
+    ///--- ( Returns false if the child could not be started or exited abnormally )
+    template <typename F>
+    static inline bool
+        run_isolated(F&& func)
+    {
+        std::fflush(stdout);
+
+        const pid_t child = fork();
+        if ( child < 0 )
+            return false;
+
+        if ( child == 0 )
+        {
+            func();
+            std::fflush(stdout);
+            _exit(0);
+        }
+
+        int status = 0;
+        waitpid(child, &status, 0);
+
+        return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    };
+
+    ///-------------------------------------------------------------------------------------------------------
+    ///ARGUMENTS
+
+    ///Splits a comma separated list of values
+    static inline std::vector<std::string>
+        split_list(const std::string& list)
+    {
+        std::vector<std::string> values;
+
+        size_t start = 0;
+        while ( start <= list.size() )
+        {
+            size_t comma = list.find(',', start);
+            if ( comma == std::string::npos )
+                comma = list.size();
+
+            if ( comma > start )
+                values.push_back(list.substr(start, comma - start));
+
+            start = comma + 1;
+        }
+
+        return values;
+    };
+
+    ///Parses a count allowing k|M suffixes ( 10k, 1M )
+    static inline size_t
+        parse_count(const std::string& value)
+    {
+        char* end = nullptr;
+        const double base = std::strtod(value.c_str(), &end);
+
+        double scale = 1.0;
+        if ( end != nullptr && ( *end == 'k' || *end == 'K' ) )
+            scale = 1e3;
+        else if ( end != nullptr && ( *end == 'm' || *end == 'M' ) )
+            scale = 1e6;
+
+        return static_cast<size_t>(base * scale);
+    };
+
+    ///Returns value following --name in argv, or fallback
+    static inline std::string
+        arg_value(int argc,
+                  char** argv,
+                  const char* name,
+                  const char* fallback)
+    {
+        for ( int i = 1; i + 1 < argc; i++ )
+        {
+            if ( std::strcmp(argv[i], name) == 0 )
+                return argv[i + 1];
+        }
+
+        return fallback;
+    };
+
+    ///Keeps the optimizer from discarding benchmark results
+    template <typename T>
+    static inline void
+        do_not_optimize(const T& value)
+    {
+        asm volatile("" : : "r,m"(value) : "memory");
+    };
+
+};  //end of bench namespace
+
+//stripe_map slot arrays are realloc()ed - route them through the tracked allocator ( include this header first )
+#define SMAP_SLOT_REALLOC(ptr, bytes) bench::tracked_realloc(ptr, bytes)
+#define SMAP_SLOT_FREE(ptr) bench::tracked_free(ptr)
+
+///-------------------------------------------------------------------------------------------------------
+///GLOBAL ALLOCATION REPLACEMENTS ( size-prefixed so delete can account for freed bytes )
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Warray-bounds"
+void*
+    operator new(size_t size)
+{
+    size_t* block = static_cast<size_t*>(std::malloc(size + sizeof(std::max_align_t)));
+    if ( block == nullptr )
+        throw std::bad_alloc();
+
+    *block = size;
+    bench::g_alloc.live += size;
+    if ( bench::g_alloc.live > bench::g_alloc.peak )
+        bench::g_alloc.peak = bench::g_alloc.live;
+
+    return reinterpret_cast<char*>(block) + sizeof(std::max_align_t);
+}
+void*
+    operator new[](size_t size)
+{
+    return operator new(size);
+}
+void
+    operator delete(void* ptr) noexcept
+{
+    if ( ptr == nullptr )
+        return;
+
+    size_t* block = reinterpret_cast<size_t*>(static_cast<char*>(ptr) - sizeof(std::max_align_t));
+    bench::g_alloc.live -= *block;
+    std::free(block);
+}
+void
+    operator delete[](void* ptr) noexcept
+{
+    operator delete(ptr);
+}
+void
+    operator delete(void* ptr, size_t) noexcept
+{
+    operator delete(ptr);
+}
+void
+    operator delete[](void* ptr, size_t) noexcept
+{
+    operator delete(ptr);
+}
+#pragma GCC diagnostic pop
+
+#endif // BENCH_COMMON_HPP
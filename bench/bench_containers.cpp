@@ -0,0 +1,901 @@
+///Microbenchmark comparing stripe_map against std containers and a uniform grid
+///--- ( Writes CSV rows to stdout - one per container / operation / configuration )
+///
+///  g++ -std=c++17 -O2 -DNDEBUG -Isrc/include bench/bench_containers.cpp -o bench_containers
+///  ./bench_containers --n 1k,100k,1M --dist uniform,clusters,zipf --stripes 100,1000
+///  ./bench_containers --n 1M --only stripe_map --prefetch 0,4,8,16,32      ( stripe_map rows per prefetch distance )
+///  ./bench_containers --n 100k --only soa,soa_u32,multimap                  ( --only takes exact runner names )
+///
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <type_traits>
+#include <unordered_map>
+
+#include "bench_common.hpp"
+
+#include <stripe_map.hpp>
+#include <stripe_builder.hpp>
+#include <stripe_map_2d.hpp>
+#include <stripe_grid.hpp>
+#include <uti_FindGridLocation.hpp>
+#include <_Utilities/uti_WorkloadGenerator.h>
+
+namespace
+{
+    struct Item
+    {
+        int x = 0;
+        int y = 0;
+        int w = 0;
+        int h = 0;
+    };
+
+    ///Benchmark configuration for a single CSV block
+    struct config
+    {
+        size_t n        = 0;
+        std::string dist;
+        size_t stripes  = 1000;
+        size_t width    = 8;
+        size_t depth    = 500000;
+        size_t reps     = 5;
+        size_t batch    = 64;
+        size_t qbatch   = 4096;
+        size_t queries  = 10000;
+        int radius      = 1000;
+        size_t prefetch = qmap::implem::SMAP_INIT_PREFETCH_DISTANCE;
+        size_t budget   = 0;
+        size_t chunk    = 65536;
+        uint64_t seed   = 1;
+    };
+
+    ///Collected samples for a single operation
+    struct op_samples
+    {
+        std::vector<double> ns;     ///< nanoseconds per operation, one entry per sample
+        double bytes = 0.0;         ///< bytes per element after the operation ( 0 if not applicable )
+    };
+
+    ///-------------------------------------------------------------------------------------------------------
+    ///ITEM GENERATION
+
+    ///Builds item list with keys drawn from named distribution ( any uti_WorkloadGenerator name or sorted )
+    std::vector<Item>
+        make_items(const config& cfg)
+    {
+        uti_WorkloadGenerator generator(cfg.seed);
+
+        uti_WorkloadGenerator::Settings settings;
+        //sorted keeps uniform y and lays x out in order below ( names are checked in main )
+        if ( cfg.dist != "sorted" )
+            ParseWorkloadDistribution(cfg.dist.c_str(), settings.distribution);
+        settings.depthMax     = cfg.depth;
+        settings.stripeDepth  = std::max<size_t>(1, cfg.depth / cfg.stripes);
+
+        std::vector<Prs::xyPr<int>> points(cfg.n);
+        generator.GeneratePoints(settings, points.data(), points.size());
+
+        std::vector<Item> items(cfg.n);
+        for ( size_t i = 0; i < cfg.n; i++ )
+        {
+            Item& item = items[i];
+            item.x = points[i].x;
+            item.y = points[i].y;
+            item.w = 350;
+            item.h = 350;
+
+            if ( cfg.dist == "sorted" )
+                item.x = static_cast<int>(( i * cfg.depth ) / cfg.n);
+        }
+
+        return items;
+    };
+
+    ///-------------------------------------------------------------------------------------------------------
+    ///CONTAINER ADAPTERS
+
+    ///Key projection of Item* for storage_projected
+    struct item_key_x
+    {
+        size_t operator()(const Item* item) const { return static_cast<size_t>(item->x); };
+    };
+
+    ///CSV name of each benched stripe_map storage
+    constexpr const char* storage_name(qmap::storage_aos<>*){ return "stripe_map"; };
+    constexpr const char* storage_name(qmap::storage_aos<uint32_t>*){ return "stripe_map u32"; };
+    constexpr const char* storage_name(qmap::storage_soa<>*){ return "stripe_map soa"; };
+    constexpr const char* storage_name(qmap::storage_soa<uint32_t>*){ return "stripe_map soa u32"; };
+    constexpr const char* storage_name(qmap::storage_projected<item_key_x, uint32_t>*){ return "stripe_map projected"; };
+    #if SMAP_HAS_MMAP
+    constexpr const char* storage_name(qmap::storage_mapped<uint32_t>*){ return "stripe_map mapped"; };
+    #endif
+
+    ///stripe_map keyed by x ( key/value pairs, parallel key and value arrays or values with projected key )
+    template <typename Storage>
+    struct adapter_stripe_map
+    {
+        typedef qmap::stripe_map<Item*, qmap::growth_double, qmap::index_adaptive, Storage> map_type;
+
+        static constexpr const char* name = storage_name(static_cast<Storage*>(nullptr));
+        static constexpr bool has_restripe = true;
+
+        explicit adapter_stripe_map(const config& cfg):
+            smap(cfg.depth, cfg.stripes, cfg.width)
+        {
+            smap.set_prefetch_distance(cfg.prefetch);
+        };
+
+        void reset(){ smap.reset(); };
+        typename map_type::item_type
+            make_item(Item& item)
+        {
+            if constexpr ( std::is_same<Storage, qmap::storage_projected<item_key_x, uint32_t>>::value )
+                return &item;
+            else
+                return typename map_type::value_type(item.x, &item);
+        };
+        void add(Item& item){ smap.add(make_item(item)); };
+        void finish(){ smap.shrink(); };
+        const char* finish_name(){ return "shrink"; };
+        size_t slots(){ return smap.slots(); };
+
+        void
+            bulk(std::vector<Item>& items)
+        {
+            smap.reset();
+            for ( auto & item : items )
+                add(item);
+            smap.shrink();
+        };
+        ///Bulk loader : one load() call over every item
+        void
+            load(std::vector<Item>& items)
+        {
+            smap.reset();
+
+            std::vector<typename map_type::item_type> staging;
+            staging.reserve(items.size());
+            for ( auto & item : items )
+                staging.push_back(make_item(item));
+
+            smap.load(staging.data(), staging.size());
+        };
+        ///Streaming builder : items fed in chunks of chunkItems under budgetBytes ( 0 if unbounded )
+        void
+            stream(std::vector<Item>& items,
+                   const size_t chunkItems,
+                   const size_t budgetBytes)
+        {
+            smap.reset();
+
+            std::vector<typename map_type::item_type> chunk;
+            chunk.reserve(chunkItems);
+
+            qmap::stripe_builder<map_type> builder(smap, budgetBytes);
+            for ( size_t i = 0; i < items.size(); i += chunkItems )
+            {
+                chunk.clear();
+                for ( size_t c = i; c < std::min(items.size(), i + chunkItems); c++ )
+                    chunk.push_back(make_item(items[c]));
+
+                builder.feed(chunk.data(), chunk.size());
+            }
+            builder.finish();
+        };
+        size_t
+            lookup(const size_t lo,
+                   const size_t hi)
+        {
+            const auto e = smap.end(hi);
+
+            size_t found = 0;
+            for ( auto i = smap.begin(lo); i != e; i++ )
+                found++;
+
+            return found;
+        };
+        template <typename F>
+        void
+            range(const size_t lo,
+                  const size_t hi,
+                  const Item&,
+                  F&& fn)
+        {
+            smap.query(lo, hi, [&](const auto& item){ fn(*item._2); });
+        };
+        ///Batched neighbour query : fn(rangeIndex, other) from one query_batch() sweep over every range
+        template <typename F>
+        void
+            range_batch(const std::vector<Prs::tpsPr<size_t, size_t>>& ranges,
+                        F&& fn)
+        {
+            smap.query_batch(ranges.data(), ranges.size(), [&](const size_t r, const auto& item){ fn(r, *item._2); });
+        };
+        int64_t
+            iterate()
+        {
+            int64_t sum = 0;
+            smap.for_each([&](const auto& item){ sum += item._2->x; });
+
+            return sum;
+        };
+
+        map_type smap;
+    };
+
+    ///stripe_map_2d keyed by Morton / Hilbert code of ( x, y ) - neighbour queries are 2D rect queries
+    template <typename Curve>
+    struct adapter_stripe_map_2d
+    {
+        static constexpr const char* name = std::is_same<Curve, qmap::implem::curve_morton>::value ? "stripe_map_2d morton"
+                                                                                                    : "stripe_map_2d hilbert";
+        static constexpr bool has_restripe = true;
+
+        explicit adapter_stripe_map_2d(const config& cfg):
+            smap(cfg.depth, cfg.stripes, cfg.width),
+            depth(static_cast<int>(cfg.depth))
+        {};
+
+        void reset(){ smap.reset(); };
+        void add(Item& item){ smap.add(item.x, item.y, &item); };
+        void finish(){ smap.shrink(); };
+        const char* finish_name(){ return "shrink"; };
+        size_t slots(){ return smap.map().slots(); };
+
+        void
+            bulk(std::vector<Item>& items)
+        {
+            smap.reset();
+            for ( auto & item : items )
+                smap.add(item.x, item.y, &item);
+            smap.shrink();
+        };
+        size_t
+            lookup(const size_t lo,
+                   const size_t hi)
+        {
+            return smap.query(static_cast<int>(lo), 0, static_cast<int>(hi), depth - 1,
+                              [](const Prs::tpsPr<size_t, Item*>&){});
+        };
+        template <typename F>
+        void
+            range(const size_t lo,
+                  const size_t hi,
+                  const Item& probe,
+                  F&& fn)
+        {
+            const int r = static_cast<int>(hi - probe.x);
+            smap.query(static_cast<int>(lo), probe.y - r, static_cast<int>(hi), probe.y + r,
+                       [&](const Prs::tpsPr<size_t, Item*>& entry)
+                       {
+                           if ( static_cast<size_t>(entry._2->x) >= lo && static_cast<size_t>(entry._2->x) <= hi )
+                               fn(*entry._2);
+                       });
+        };
+        int64_t
+            iterate()
+        {
+            int64_t sum = 0;
+            const auto e = smap.map().end();
+            for ( auto i = smap.map().begin(); i != e; i++ )
+                sum += i->_2->x;
+
+            return sum;
+        };
+
+        qmap::stripe_map_2d<Item*, Curve> smap;
+        int depth;
+    };
+
+    ///stripe_grid with cells twice the query radius wide - neighbour queries visit the 3x3 cells around the probe
+    struct adapter_stripe_grid
+    {
+        static constexpr const char* name = "stripe_grid";
+        static constexpr bool has_restripe = true;
+
+        explicit adapter_stripe_grid(const config& cfg):
+            sgrid(cfg.depth, cfg.depth,
+                  std::max<size_t>(1, cfg.depth / ( 2 * cfg.radius )),
+                  std::max<size_t>(1, cfg.depth / ( 2 * cfg.radius )),
+                  cfg.width),
+            depth(static_cast<int>(cfg.depth))
+        {};
+
+        void reset(){ sgrid.reset(); };
+        void add(Item& item){ sgrid.add(item.x, item.y, &item); };
+        void finish(){ sgrid.shrink(); };
+        const char* finish_name(){ return "shrink"; };
+        size_t slots(){ return sgrid.slots(); };
+
+        void
+            bulk(std::vector<Item>& items)
+        {
+            sgrid.reset();
+            for ( auto & item : items )
+                sgrid.add(item.x, item.y, &item);
+            sgrid.shrink();
+        };
+        size_t
+            lookup(const size_t lo,
+                   const size_t hi)
+        {
+            return sgrid.query_rect(static_cast<int>(lo), 0, static_cast<int>(hi), depth - 1,
+                                    [](const Prs::tpsPr<size_t, Item*>&){});
+        };
+        template <typename F>
+        void
+            range(const size_t lo,
+                  const size_t hi,
+                  const Item& probe,
+                  F&& fn)
+        {
+            sgrid.query_neighbours(probe.x, probe.y,
+                                   [&](const Prs::tpsPr<size_t, Item*>& entry)
+                                   {
+                                       if ( static_cast<size_t>(entry._2->x) >= lo && static_cast<size_t>(entry._2->x) <= hi )
+                                           fn(*entry._2);
+                                   });
+        };
+        int64_t
+            iterate()
+        {
+            int64_t sum = 0;
+            sgrid.query_rect(0, 0, depth - 1, depth - 1,
+                             [&](const Prs::tpsPr<size_t, Item*>& entry){ sum += entry._2->x; });
+
+            return sum;
+        };
+
+        qmap::stripe_grid<Item*> sgrid;
+        int depth;
+    };
+
+    ///std::multimap keyed by x ( keys repeat, so the multi variant is required )
+    struct adapter_map
+    {
+        static constexpr const char* name = "std::multimap";
+        static constexpr bool has_restripe = false;
+
+        explicit adapter_map(const config&){};
+
+        void reset(){ map.clear(); };
+        void add(Item& item){ map.emplace(item.x, &item); };
+        void finish(){};
+        const char* finish_name(){ return nullptr; };
+        size_t slots(){ return 0; };
+
+        void
+            bulk(std::vector<Item>& items)
+        {
+            map.clear();
+            for ( auto & item : items )
+                map.emplace_hint(map.end(), item.x, &item);
+        };
+        size_t
+            lookup(const size_t lo,
+                   const size_t hi)
+        {
+            return std::distance(map.lower_bound(lo), map.upper_bound(hi));
+        };
+        template <typename F>
+        void
+            range(const size_t lo,
+                  const size_t hi,
+                  const Item&,
+                  F&& fn)
+        {
+            const auto e = map.upper_bound(hi);
+            for ( auto i = map.lower_bound(lo); i != e; i++ )
+                fn(*i->second);
+        };
+        int64_t
+            iterate()
+        {
+            int64_t sum = 0;
+            for ( auto & entry : map )
+                sum += entry.second->x;
+
+            return sum;
+        };
+
+        std::multimap<size_t, Item*> map;
+    };
+
+    ///std::unordered_multimap keyed by x ( range lookups probe each key in range )
+    struct adapter_unordered_map
+    {
+        static constexpr const char* name = "std::unordered_multimap";
+        static constexpr bool has_restripe = false;
+
+        explicit adapter_unordered_map(const config&){};
+
+        void reset(){ map.clear(); };
+        void add(Item& item){ map.emplace(item.x, &item); };
+        void finish(){};
+        const char* finish_name(){ return nullptr; };
+        size_t slots(){ return 0; };
+
+        void
+            bulk(std::vector<Item>& items)
+        {
+            map.clear();
+            map.reserve(items.size());
+            for ( auto & item : items )
+                map.emplace(item.x, &item);
+        };
+        size_t
+            lookup(const size_t lo,
+                   const size_t hi)
+        {
+            size_t found = 0;
+            for ( size_t k = lo; k <= hi; k++ )
+                found += map.count(k);
+
+            return found;
+        };
+        template <typename F>
+        void
+            range(const size_t lo,
+                  const size_t hi,
+                  const Item&,
+                  F&& fn)
+        {
+            for ( size_t k = lo; k <= hi; k++ )
+            {
+                const auto found = map.equal_range(k);
+                for ( auto i = found.first; i != found.second; i++ )
+                    fn(*i->second);
+            }
+        };
+        int64_t
+            iterate()
+        {
+            int64_t sum = 0;
+            for ( auto & entry : map )
+                sum += entry.second->x;
+
+            return sum;
+        };
+
+        std::unordered_multimap<size_t, Item*> map;
+    };
+
+    ///std::vector of pairs sorted by x after loading
+    struct adapter_sorted_vector
+    {
+        static constexpr const char* name = "sorted std::vector";
+        static constexpr bool has_restripe = false;
+
+        using entry = std::pair<size_t, Item*>;
+
+        explicit adapter_sorted_vector(const config&){};
+
+        void reset(){ vec.clear(); };
+        void add(Item& item){ vec.emplace_back(item.x, &item); };
+        void
+            finish()
+        {
+            std::sort(vec.begin(), vec.end(),
+                      [](const entry& a, const entry& b){ return a.first < b.first; });
+        };
+        const char* finish_name(){ return "sort"; };
+        size_t slots(){ return vec.capacity(); };
+
+        void
+            bulk(std::vector<Item>& items)
+        {
+            vec.clear();
+            vec.reserve(items.size());
+            for ( auto & item : items )
+                vec.emplace_back(item.x, &item);
+            finish();
+        };
+        std::vector<entry>::iterator
+            lower(const size_t key)
+        {
+            return std::lower_bound(vec.begin(), vec.end(), key,
+                                    [](const entry& a, const size_t k){ return a.first < k; });
+        };
+        size_t
+            lookup(const size_t lo,
+                   const size_t hi)
+        {
+            return std::distance(lower(lo), lower(hi + 1));
+        };
+        template <typename F>
+        void
+            range(const size_t lo,
+                  const size_t hi,
+                  const Item&,
+                  F&& fn)
+        {
+            for ( auto i = lower(lo); i != vec.end() && i->first <= hi; i++ )
+                fn(*i->second);
+        };
+        int64_t
+            iterate()
+        {
+            int64_t sum = 0;
+            for ( auto & e : vec )
+                sum += e.second->x;
+
+            return sum;
+        };
+
+        std::vector<entry> vec;
+    };
+
+    ///Uniform 2D grid of cells ( rows x cols ) - neighbour queries visit the cells overlapping the query box
+    struct adapter_grid
+    {
+        static constexpr const char* name = "uniform grid";
+        static constexpr bool has_restripe = false;
+
+        explicit adapter_grid(const config& cfg):
+            size(static_cast<int>(cfg.depth)),
+            dim(std::max<int>(1, static_cast<int>(std::sqrt(static_cast<double>(cfg.stripes))))),
+            cellsize(std::max(1, size / dim)),
+            cells(dim * dim)
+        {};
+
+        size_t
+            cell_of(const int loc)
+        {
+            return std::min<size_t>(GridMapUtils::FindGridLoc(loc, size, cellsize), dim - 1);
+        };
+
+        void
+            reset()
+        {
+            for ( auto & cell : cells )
+                cell.clear();
+        };
+        void add(Item& item){ cells[cell_of(item.y) * dim + cell_of(item.x)].push_back(&item); };
+        void finish(){};
+        const char* finish_name(){ return nullptr; };
+        size_t slots(){ return 0; };
+
+        void
+            bulk(std::vector<Item>& items)
+        {
+            reset();
+            for ( auto & item : items )
+                add(item);
+        };
+        size_t
+            lookup(const size_t lo,
+                   const size_t hi)
+        {
+            size_t found = 0;
+            for ( size_t col = cell_of(lo); col <= cell_of(hi); col++ )
+                for ( int row = 0; row < dim; row++ )
+                    found += cells[row * dim + col].size();
+
+            return found;
+        };
+        template <typename F>
+        void
+            range(const size_t lo,
+                  const size_t hi,
+                  const Item& probe,
+                  F&& fn)
+        {
+            const int r = static_cast<int>(hi - probe.x);
+            const size_t rowlo = cell_of(std::max(probe.y - r, 0));
+            const size_t rowhi = cell_of(std::min(probe.y + r, size - 1));
+
+            for ( size_t row = rowlo; row <= rowhi; row++ )
+                for ( size_t col = cell_of(lo); col <= cell_of(hi); col++ )
+                    for ( Item* item : cells[row * dim + col] )
+                        fn(*item);
+        };
+        int64_t
+            iterate()
+        {
+            int64_t sum = 0;
+            for ( auto & cell : cells )
+                for ( Item* item : cell )
+                    sum += item->x;
+
+            return sum;
+        };
+
+        int size;
+        int dim;
+        int cellsize;
+        std::vector<std::vector<Item*>> cells;
+    };
+
+    ///True if adapter A offers range_batch() ( 1D stripe_map storages )
+    template <typename A, typename = void>
+    struct has_range_batch : std::false_type {};
+    template <typename A>
+    struct has_range_batch<A, std::void_t<decltype(&A::template range_batch<int(*)(size_t, const Item&)>)>> : std::true_type {};
+
+    ///True if adapter A offers load() and stream() ( 1D stripe_map storages )
+    template <typename A, typename = void>
+    struct has_stream : std::false_type {};
+    template <typename A>
+    struct has_stream<A, std::void_t<decltype(&A::stream)>> : std::true_type {};
+
+    ///-------------------------------------------------------------------------------------------------------
+    ///MEASUREMENT
+
+    ///Writes single CSV row for the given operation samples
+    void
+        report(const config& cfg,
+               const char* container,
+               const char* op,
+               op_samples& samples)
+    {
+        const size_t count = samples.ns.size();
+        const double median = bench::percentile(samples.ns, 50.0);
+        const double p99    = bench::percentile(samples.ns, 99.0);
+
+        std::printf("%s,%s,%zu,%s,%zu,%zu,%zu,%.2f,%.2f,%.2f,%zu,%zu\n",
+                    container, op, cfg.n, cfg.dist.c_str(), cfg.stripes, cfg.width,
+                    count, median, p99, samples.bytes, bench::peak_rss_bytes(), cfg.prefetch);
+    };
+
+    ///Runs all operations for container adapter A and reports them
+    template <typename A>
+    void
+        run_container(const config& cfg)
+    {
+        std::vector<Item> items = make_items(cfg);
+        std::vector<Item> probes(items.begin(), items.begin() + std::min(cfg.queries, items.size()));
+
+        const size_t baseline = bench::g_alloc.live;
+        A adapter(cfg);
+
+        op_samples addops, restripeops, finishops, bulkops, loadops, streamops, lookupops, iterops, neighbourops, batchops;
+
+        for ( size_t rep = 0; rep < cfg.reps; rep++ )
+        {
+            ///ADD ( timed in batches - same loop for every container )
+            adapter.reset();
+            for ( size_t i = 0; i < items.size(); )
+            {
+                const size_t batchend = std::min(items.size(), i + cfg.batch);
+                const auto before = bench::clock::now();
+                for ( size_t b = i; b < batchend; b++ )
+                    adapter.add(items[b]);
+                const auto after = bench::clock::now();
+
+                addops.ns.push_back(bench::elapsed_ns(before, after) / ( batchend - i ));
+                i = batchend;
+            }
+
+            ///RESTRIPE ( separate pass so add samples carry no per item timing - single adds that grow the map )
+            if ( A::has_restripe )
+            {
+                adapter.reset();
+                for ( size_t i = 0; i < items.size(); i++ )
+                {
+                    const size_t slotsnow = adapter.slots();
+                    const auto before = bench::clock::now();
+                    adapter.add(items[i]);
+                    const auto after = bench::clock::now();
+                    if ( adapter.slots() != slotsnow && i != 0 )
+                        restripeops.ns.push_back(bench::elapsed_ns(before, after));
+                }
+            }
+
+            ///SHRINK / SORT
+            {
+                const auto before = bench::clock::now();
+                adapter.finish();
+                const auto after = bench::clock::now();
+                finishops.ns.push_back(bench::elapsed_ns(before, after) / items.size());
+                finishops.bytes = double(bench::g_alloc.live - baseline) / items.size();
+            }
+
+            ///BULK LOAD
+            {
+                const auto before = bench::clock::now();
+                adapter.bulk(items);
+                const auto after = bench::clock::now();
+                bulkops.ns.push_back(bench::elapsed_ns(before, after) / items.size());
+                bulkops.bytes = double(bench::g_alloc.live - baseline) / items.size();
+                addops.bytes  = bulkops.bytes;
+            }
+
+            ///LOAD / STREAM ( stripe_map only - bytes are the allocation peak during the op, input excluded )
+            if constexpr ( has_stream<A>::value )
+            {
+                adapter.reset();
+                bench::reset_alloc_peak();
+                const auto loadbefore = bench::clock::now();
+                adapter.load(items);
+                const auto loadafter  = bench::clock::now();
+                loadops.ns.push_back(bench::elapsed_ns(loadbefore, loadafter) / items.size());
+                loadops.bytes = double(bench::g_alloc.peak - baseline) / items.size();
+
+                adapter.reset();
+                bench::reset_alloc_peak();
+                const auto streambefore = bench::clock::now();
+                adapter.stream(items, cfg.chunk, cfg.budget);
+                const auto streamafter  = bench::clock::now();
+                streamops.ns.push_back(bench::elapsed_ns(streambefore, streamafter) / items.size());
+                streamops.bytes = double(bench::g_alloc.peak - baseline) / items.size();
+            }
+
+            ///BEGIN(DEPTH) / END(DEPTH) LOOKUP
+            for ( size_t i = 0; i < probes.size(); )
+            {
+                const size_t batchend = std::min(probes.size(), i + cfg.batch);
+                size_t found = 0;
+                const auto before = bench::clock::now();
+                for ( size_t b = i; b < batchend; b++ )
+                {
+                    const size_t key = probes[b].x;
+                    found += adapter.lookup(key, key);
+                }
+                const auto after = bench::clock::now();
+                bench::do_not_optimize(found);
+
+                lookupops.ns.push_back(bench::elapsed_ns(before, after) / ( batchend - i ));
+                i = batchend;
+            }
+
+            ///FULL ITERATION
+            {
+                const auto before = bench::clock::now();
+                const int64_t sum = adapter.iterate();
+                const auto after = bench::clock::now();
+                bench::do_not_optimize(sum);
+                iterops.ns.push_back(bench::elapsed_ns(before, after) / items.size());
+            }
+
+            ///NEIGHBOUR QUERY ( +-radius on x, candidates filtered on y )
+            for ( size_t i = 0; i < probes.size(); )
+            {
+                const size_t batchend = std::min(probes.size(), i + cfg.batch);
+                size_t hits = 0;
+                const auto before = bench::clock::now();
+                for ( size_t b = i; b < batchend; b++ )
+                {
+                    const Item& probe = probes[b];
+                    const size_t lo = probe.x > cfg.radius ? probe.x - cfg.radius : 0;
+                    const size_t hi = probe.x + cfg.radius;
+
+                    adapter.range(lo, hi, probe,
+                                  [&](const Item& other)
+                                  {
+                                      if ( std::abs(other.y - probe.y) <= cfg.radius )
+                                          hits++;
+                                  });
+                }
+                const auto after = bench::clock::now();
+                bench::do_not_optimize(hits);
+
+                neighbourops.ns.push_back(bench::elapsed_ns(before, after) / ( batchend - i ));
+                i = batchend;
+            }
+
+            ///BATCHED NEIGHBOUR QUERY ( same probes, one query_batch() sweep per --qbatch probes )
+            if constexpr ( has_range_batch<A>::value )
+            {
+                std::vector<Prs::tpsPr<size_t, size_t>> ranges;
+                for ( size_t i = 0; i < probes.size(); )
+                {
+                    const size_t batchend = std::min(probes.size(), i + cfg.qbatch);
+                    size_t hits = 0;
+                    const auto before = bench::clock::now();
+                    ranges.clear();
+                    for ( size_t b = i; b < batchend; b++ )
+                    {
+                        const size_t lo = probes[b].x > cfg.radius ? probes[b].x - cfg.radius : 0;
+                        ranges.push_back(Prs::tpsPr<size_t, size_t>(lo, probes[b].x + cfg.radius));
+                    }
+
+                    adapter.range_batch(ranges,
+                                        [&](const size_t r, const Item& other)
+                                        {
+                                            if ( std::abs(other.y - probes[i + r].y) <= cfg.radius )
+                                                hits++;
+                                        });
+                    const auto after = bench::clock::now();
+                    bench::do_not_optimize(hits);
+
+                    batchops.ns.push_back(bench::elapsed_ns(before, after) / ( batchend - i ));
+                    i = batchend;
+                }
+            }
+        }
+
+        report(cfg, A::name, "add", addops);
+        if ( A::has_restripe )
+            report(cfg, A::name, "restripe", restripeops);
+        if ( adapter.finish_name() != nullptr )
+            report(cfg, A::name, adapter.finish_name(), finishops);
+        report(cfg, A::name, "bulk_load", bulkops);
+        if ( has_stream<A>::value )
+        {
+            report(cfg, A::name, "load", loadops);
+            report(cfg, A::name, "stream", streamops);
+        }
+        report(cfg, A::name, "lookup", lookupops);
+        report(cfg, A::name, "iterate", iterops);
+        report(cfg, A::name, "neighbour", neighbourops);
+        if ( has_range_batch<A>::value )
+            report(cfg, A::name, "neighbour_batch", batchops);
+    };
+
+};  //end of anonymous namespace
+
+int main(int argc, char** argv)
+{
+    const auto counts    = bench::split_list(bench::arg_value(argc, argv, "--n", "1k,10k,100k"));
+    const auto dists     = bench::split_list(bench::arg_value(argc, argv, "--dist", "uniform,clusters,zipf,sorted"));
+    const auto stripes   = bench::split_list(bench::arg_value(argc, argv, "--stripes", "1000"));
+    const auto only      = bench::split_list(bench::arg_value(argc, argv, "--only", ""));
+    const auto prefetch  = bench::split_list(bench::arg_value(argc, argv, "--prefetch", "0,32"));
+
+    config base;
+    base.width   = bench::parse_count(bench::arg_value(argc, argv, "--width", "8"));
+    base.depth   = bench::parse_count(bench::arg_value(argc, argv, "--depth", "500k"));
+    base.reps    = bench::parse_count(bench::arg_value(argc, argv, "--reps", "5"));
+    base.queries = bench::parse_count(bench::arg_value(argc, argv, "--queries", "10k"));
+    base.radius  = static_cast<int>(bench::parse_count(bench::arg_value(argc, argv, "--radius", "1000")));
+    base.seed    = bench::parse_count(bench::arg_value(argc, argv, "--seed", "1"));
+    base.chunk   = bench::parse_count(bench::arg_value(argc, argv, "--chunk", "64k"));
+    base.budget  = bench::parse_count(bench::arg_value(argc, argv, "--budget", "0"));
+    base.qbatch  = std::max<size_t>(1, bench::parse_count(bench::arg_value(argc, argv, "--qbatch", "4k")));
+
+    for ( const auto & dist : dists )
+    {
+        uti_WorkloadGenerator::Distribution parsed;
+        if ( dist != "sorted" && !ParseWorkloadDistribution(dist.c_str(), parsed) )
+        {
+            std::fprintf(stderr, "unknown --dist %s ( uniform|clusters|zipf|corridor|one_stripe|beyond_max|sorted )\n", dist.c_str());
+            return 1;
+        }
+    }
+
+    std::printf("container,op,n,dist,stripes,width,samples,median_ns,p99_ns,bytes_per_elem,peak_rss_bytes,prefetch\n");
+
+    for ( const auto & count : counts )
+    for ( const auto & dist : dists )
+    for ( const auto & stripe : stripes )
+    {
+        config cfg = base;
+        cfg.n       = bench::parse_count(count);
+        cfg.dist    = dist;
+        cfg.stripes = bench::parse_count(stripe);
+
+        auto runif = [&](const char* name, auto runner)
+        {
+            if ( only.empty() || std::find(only.begin(), only.end(), name) != only.end() )
+                bench::run_isolated(runner);
+        };
+
+        //Prefetch distance only applies to the 1D stripe_map storages
+        for ( const auto & distance : prefetch )
+        {
+            cfg.prefetch = bench::parse_count(distance);
+
+            runif("stripe_map", [&]{ run_container<adapter_stripe_map<qmap::storage_aos<>>>(cfg); });
+            runif("u32",        [&]{ run_container<adapter_stripe_map<qmap::storage_aos<uint32_t>>>(cfg); });
+            runif("soa",        [&]{ run_container<adapter_stripe_map<qmap::storage_soa<>>>(cfg); });
+            runif("soa_u32",    [&]{ run_container<adapter_stripe_map<qmap::storage_soa<uint32_t>>>(cfg); });
+            runif("projected",  [&]{ run_container<adapter_stripe_map<qmap::storage_projected<item_key_x, uint32_t>>>(cfg); });
+            #if SMAP_HAS_MMAP
+            runif("mapped",     [&]{ run_container<adapter_stripe_map<qmap::storage_mapped<uint32_t>>>(cfg); });
+            #endif
+        }
+        cfg.prefetch = 0;
+
+        runif("morton",     [&]{ run_container<adapter_stripe_map_2d<qmap::implem::curve_morton>>(cfg); });
+        runif("hilbert",    [&]{ run_container<adapter_stripe_map_2d<qmap::implem::curve_hilbert>>(cfg); });
+        runif("stripe_grid", [&]{ run_container<adapter_stripe_grid>(cfg); });
+        runif("multimap",   [&]{ run_container<adapter_map>(cfg); });
+        runif("unordered",  [&]{ run_container<adapter_unordered_map>(cfg); });
+        runif("vector",     [&]{ run_container<adapter_sorted_vector>(cfg); });
+        runif("grid",       [&]{ run_container<adapter_grid>(cfg); });
+    }
+
+    return 0;
+}
@@ -0,0 +1,460 @@
+///End-to-end frame simulation benchmark with per-frame tail latency
+///--- ( Evolves N moving rects, rebuilding the stripe_map and running neighbour queries every frame )
+///
+///  g++ -std=c++17 -O2 -DNDEBUG -Isrc/include bench/bench_frame_sim.cpp -o bench_frame_sim
+///  ./bench_frame_sim --n 5000 --frames 2000 --velocity 200 --dist zipf --rebuild reset
+///  ./bench_frame_sim --maxsize 20000 --large 0.02 --container loose
+///  ./bench_frame_sim --container indexed --narrowphase batch
+///
+#include <cmath>
+#include <cstdint>
+
+#include "bench_common.hpp"
+
+#include <stripe_map.hpp>
+#include <stripe_map_loose.hpp>
+#include <stripe_map_indexed.hpp>
+#include <_Utilities/uti_FindInside.hpp>
+#include <_Utilities/uti_FindInsideBatch.hpp>
+#include <_Utilities/uti_WorkloadGenerator.h>
+
+namespace
+{
+    struct Rect
+    {
+        int x = 0;
+        int y = 0;
+        int w = 0;
+        int h = 0;
+    };
+
+    struct Body
+    {
+        Rect rect;
+        int vx = 0;
+        int vy = 0;
+    };
+
+    ///Simulation configuration
+    struct config
+    {
+        size_t n          = 5000;
+        size_t frames     = 2000;
+        size_t warmup     = 50;
+        size_t stripes    = 1000;
+        size_t width      = 8;
+        int worldsize     = 500000;
+        int rectsize      = 350;
+        int maxsize       = 0;          ///< largest rect size of the large population ( 0 keeps every rect at rectsize )
+        double large      = 0.05;       ///< fraction of rects drawn in [rectsize, maxsize] when maxsize is set
+        int velocity      = 200;        ///< max speed per frame on each axis
+        std::string dist  = "uniform";  ///< uti_WorkloadGenerator distribution name for start positions
+        size_t clusters   = 0;          ///< overrides dist with this many gaussian clusters when non-zero
+        double spread     = 0.01;       ///< cluster standard deviation as fraction of world size
+        int margin        = 1000;       ///< neighbour stripe margin on x
+        std::string rebuild = "reset";  ///< reset ( free + rebuild ) or clear ( keep slots )
+        std::string narrowphase = "scalar"; ///< scalar ( FindInside_Radius_Q ) or batch ( FindInside_Radius_Batch )
+        std::string container = "stripe_map"; ///< stripe_map ( one worst-case margin ), loose ( stripe_map_loose levels ) or indexed ( stripe_map_indexed over x/y/w columns )
+        uint64_t seed     = 1;
+    };
+
+    ///Per-frame latency histogram in log2 nanosecond buckets plus the raw samples for percentiles
+    struct frame_histogram
+    {
+        static constexpr size_t BUCKETS = 48;
+
+        void
+            record(const double ns)
+        {
+            samples.push_back(ns);
+
+            size_t bucket = 0;
+            if ( ns >= 1.0 )
+                bucket = std::min<size_t>(BUCKETS - 1, static_cast<size_t>(std::log2(ns)));
+            buckets[bucket]++;
+        };
+
+        std::vector<double> samples;
+        size_t buckets[BUCKETS] = {};
+    };
+
+    ///SoA candidate block fed to the batched narrowphase kernels
+    struct candidate_block
+    {
+        void
+            clear()
+        {
+            x.clear();
+            y.clear();
+            w.clear();
+        };
+        void
+            push(const Rect& rect)
+        {
+            x.push_back(rect.x);
+            y.push_back(rect.y);
+            w.push_back(rect.w);
+        };
+        size_t size() const { return x.size(); };
+
+        std::vector<int> x;
+        std::vector<int> y;
+        std::vector<int> w;
+    };
+
+    ///-------------------------------------------------------------------------------------------------------
+    ///WORLD SETUP AND STEP
+
+    std::vector<Body>
+        make_bodies(const config& cfg)
+    {
+        uti_WorkloadGenerator generator(cfg.seed);
+
+        uti_WorkloadGenerator::Settings settings;
+        ParseWorkloadDistribution(cfg.dist.c_str(), settings.distribution);     //checked in main
+        settings.depthMax      = cfg.worldsize;
+        settings.stripeDepth   = std::max<size_t>(1, cfg.worldsize / cfg.stripes);
+        settings.clusterSpread = cfg.spread;
+        if ( cfg.clusters != 0 )
+        {
+            settings.distribution = uti_WorkloadGenerator::Distribution::Clusters;
+            settings.clusters     = cfg.clusters;
+        }
+
+        std::vector<Prs::xyPr<int>> points(cfg.n);
+        generator.GeneratePoints(settings, points.data(), points.size());
+
+        std::vector<Body> bodies(cfg.n);
+        for ( size_t i = 0; i < cfg.n; i++ )
+        {
+            Body& body = bodies[i];
+            body.rect.x = std::min(points[i].x, cfg.worldsize - 1);
+            body.rect.y = points[i].y;
+            body.rect.w = cfg.rectsize;
+            if ( cfg.maxsize > cfg.rectsize && generator.NextUnit() < cfg.large )
+                body.rect.w += static_cast<int>(generator.NextBounded(cfg.maxsize - cfg.rectsize + 1));
+            body.rect.h = body.rect.w;
+            body.vx = static_cast<int>(generator.NextBounded(2 * cfg.velocity + 1)) - cfg.velocity;
+            body.vy = static_cast<int>(generator.NextBounded(2 * cfg.velocity + 1)) - cfg.velocity;
+        }
+
+        return bodies;
+    };
+
+    ///Moves all bodies by their velocity and reflects them off world edges
+    void
+        step(std::vector<Body>& bodies,
+             const int worldsize)
+    {
+        for ( auto & body : bodies )
+        {
+            body.rect.x += body.vx;
+            body.rect.y += body.vy;
+
+            if ( body.rect.x < 0 || body.rect.x >= worldsize )
+            {
+                body.vx = -body.vx;
+                body.rect.x = std::min(std::max(body.rect.x, 0), worldsize - 1);
+            }
+            if ( body.rect.y < 0 || body.rect.y >= worldsize )
+            {
+                body.vy = -body.vy;
+                body.rect.y = std::min(std::max(body.rect.y, 0), worldsize - 1);
+            }
+        }
+    };
+
+    ///Writes percentile summary row for phase
+    void
+        report(const config& cfg,
+               const char* phase,
+               frame_histogram& hist,
+               const size_t candidates)
+    {
+        const double p50  = bench::percentile(hist.samples, 50.0);
+        const double p99  = bench::percentile(hist.samples, 99.0);
+        const double p999 = bench::percentile(hist.samples, 99.9);
+        const double max  = hist.samples.empty() ? 0.0 : hist.samples.back();
+
+        const std::string dist = cfg.clusters != 0 ? "clusters:" + std::to_string(cfg.clusters) : cfg.dist;
+
+        std::printf("summary,%s,%zu,%zu,%d,%s,%s,%s,%s,%.0f,%.0f,%.0f,%.0f,%zu,%zu\n",
+                    phase, cfg.n, hist.samples.size(), cfg.velocity, dist.c_str(), cfg.rebuild.c_str(), cfg.narrowphase.c_str(),
+                    cfg.container.c_str(),
+                    p50, p99, p999, max, candidates, bench::peak_rss_bytes());
+    };
+
+    ///Writes non-empty histogram buckets for phase
+    void
+        report_buckets(const char* phase,
+                       const frame_histogram& hist)
+    {
+        for ( size_t i = 0; i < frame_histogram::BUCKETS; i++ )
+        {
+            if ( hist.buckets[i] != 0 )
+                std::printf("bucket,%s,%.0f,%zu\n", phase, std::ldexp(1.0, static_cast<int>(i)), hist.buckets[i]);
+        }
+    };
+
+    ///Runs the full simulation and reports both phases
+    void
+        run_simulation(const config& cfg,
+                       const bool printBuckets)
+    {
+        std::vector<Body> bodies = make_bodies(cfg);
+        qmap::stripe_map<Rect*> smap(cfg.worldsize, cfg.stripes, cfg.width);
+        qmap::stripe_map_loose<Rect*> lmap(cfg.worldsize,
+                                           std::max<size_t>(1, cfg.worldsize / cfg.stripes),
+                                           0,
+                                           cfg.width);
+        const bool loose = cfg.container == "loose";
+
+        //Engine side x/y/w columns refreshed each frame, gathered into stripe order by stripe_map_indexed
+        enum { COL_X, COL_Y, COL_W, COL_AMOUNT };
+        qmap::stripe_map_indexed<int, COL_AMOUNT> imap(cfg.worldsize, cfg.stripes, cfg.width);
+        const bool indexed = cfg.container == "indexed";
+        std::vector<int> colx(bodies.size());
+        std::vector<int> coly(bodies.size());
+        std::vector<int> colw(bodies.size());
+        imap.bind_column(COL_X, colx.data());
+        imap.bind_column(COL_Y, coly.data());
+        imap.bind_column(COL_W, colw.data());
+
+        //Single stripe_map has to widen every probe by the largest rect
+        int largest = 0;
+        for ( auto & body : bodies )
+            largest = std::max(largest, body.rect.w);
+
+        frame_histogram buildhist;
+        frame_histogram queryhist;
+        size_t candidates = 0;
+        size_t collisions = 0;
+
+        const bool batched = cfg.narrowphase == "batch";
+        candidate_block block;
+        std::vector<uint64_t> masks;
+
+        for ( size_t frame = 0; frame < cfg.frames + cfg.warmup; frame++ )
+        {
+            step(bodies, cfg.worldsize);
+
+            ///BUILD PHASE ( rebuild + shrink )
+            const auto buildbefore = bench::clock::now();
+            if ( indexed )
+            {
+                if ( cfg.rebuild == "clear" )
+                    imap.clear();
+                else
+                    imap.reset();
+
+                for ( size_t i = 0; i < bodies.size(); i++ )
+                {
+                    colx[i] = bodies[i].rect.x;
+                    coly[i] = bodies[i].rect.y;
+                    colw[i] = bodies[i].rect.w;
+                    imap.add(bodies[i].rect.x, static_cast<uint32_t>(i));
+                }
+
+                imap.shrink();
+            }
+            else if ( loose )
+            {
+                if ( cfg.rebuild == "clear" )
+                    lmap.clear();
+                else
+                    lmap.reset();
+
+                for ( auto & body : bodies )
+                    lmap.add(body.rect.x, body.rect.w, &body.rect);
+
+                lmap.shrink();
+            }
+            else
+            {
+                if ( cfg.rebuild == "clear" )
+                    smap.clear();
+                else
+                    smap.reset();
+
+                for ( auto & body : bodies )
+                    smap.emplace(body.rect.x, &body.rect);
+
+                smap.shrink();
+            }
+            const auto buildafter = bench::clock::now();
+
+            ///QUERY PHASE ( neighbour stripes on x, narrowphase on both axes )
+            const auto querybefore = bench::clock::now();
+            for ( auto & body : bodies )
+            {
+                const Rect & testItem = body.rect;
+
+                if ( indexed )
+                {
+                    const int margin = std::max(cfg.margin, ( testItem.w + largest ) / 2 + 1);
+                    const size_t beforestripe = testItem.x > margin ? testItem.x - margin : 0;
+                    const size_t afterstripe  = testItem.x + margin;
+
+                    //Whole stripes of contiguous gathered rows - counted with the same x filter and self exclusion as the other containers
+                    const uint32_t self = static_cast<uint32_t>(&body - bodies.data());
+                    imap.query_spans(beforestripe,
+                                     afterstripe,
+                                     [&](const size_t rowBegin, const size_t rowEnd, const auto& cols)
+                                     {
+                                         const int* x = cols[COL_X];
+                                         const int* y = cols[COL_Y];
+                                         const int* w = cols[COL_W];
+                                         if ( batched )
+                                         {
+                                             masks.resize(( rowEnd - rowBegin + 63 ) / 64 + 1);
+                                             collisions += ColliderUtils::FindInside_Radius_Batch(testItem, x + rowBegin, y + rowBegin,
+                                                                                                  w + rowBegin, rowEnd - rowBegin, masks.data());
+
+                                             //Kernel ran on whole stripes - excluded rows give back their hit bit
+                                             for ( size_t row = rowBegin; row < rowEnd; row++ )
+                                             {
+                                                 if ( std::abs(testItem.x - x[row]) >= margin || imap.index_of(row) == self )
+                                                 {
+                                                     const size_t bit = row - rowBegin;
+                                                     collisions -= ( masks[bit >> 6] >> ( bit & 63 ) ) & 1;
+                                                     continue;
+                                                 }
+
+                                                 candidates++;
+                                             }
+                                             return;
+                                         }
+
+                                         for ( size_t row = rowBegin; row < rowEnd; row++ )
+                                         {
+                                             if ( std::abs(testItem.x - x[row]) >= margin || imap.index_of(row) == self )
+                                                 continue;
+
+                                             candidates++;
+                                             if ( ColliderUtils::FindInside_Radius_Exact(testItem.x, testItem.y, testItem.w,
+                                                                                         x[row], y[row], w[row]) )
+                                                 collisions++;
+                                         }
+                                     });
+                    continue;
+                }
+
+                //Calls visit on every x-filtered candidate of testItem
+                auto candidates_of = [&](auto&& visit)
+                {
+                    if ( loose )
+                    {
+                        //Each level widens by its own largest extent only
+                        const int half = testItem.w / 2;
+                        lmap.query(testItem.x > half ? testItem.x - half : 0,
+                                   testItem.x + half,
+                                   [&](const Prs::tpsPr<size_t, Rect*>& entry)
+                                   {
+                                       const Rect* checkItem = entry._2;
+                                       if ( &testItem == checkItem )
+                                           return;
+
+                                       if ( std::abs(testItem.x - checkItem->x) > ( testItem.w + checkItem->w ) / 2 )
+                                           return;
+
+                                       visit(*checkItem);
+                                   });
+                        return;
+                    }
+
+                    const int margin = std::max(cfg.margin, ( testItem.w + largest ) / 2 + 1);
+                    const size_t beforestripe = testItem.x > margin ? testItem.x - margin : 0;
+                    const size_t afterstripe  = testItem.x + margin;
+
+                    const auto endstripe = smap.end(afterstripe);
+                    for ( auto i = smap.begin(beforestripe); i != endstripe; i++ )
+                    {
+                        const Rect* checkItem = i->_2;
+                        if ( &testItem == checkItem )
+                            continue;
+
+                        if ( std::abs(testItem.x - checkItem->x) >= margin )
+                            continue;
+
+                        visit(*checkItem);
+                    }
+                };
+
+                if ( batched )
+                {
+                    //Gather x-filtered candidates into SoA block, then test them 8 at a time
+                    block.clear();
+                    candidates_of([&](const Rect& checkItem){ block.push(checkItem); });
+
+                    candidates += block.size();
+                    masks.resize(( block.size() + 63 ) / 64 + 1);
+                    collisions += ColliderUtils::FindInside_Radius_Batch(testItem, block.x.data(), block.y.data(),
+                                                                         block.w.data(), block.size(), masks.data());
+                    continue;
+                }
+
+                candidates_of([&](const Rect& checkItem)
+                {
+                    candidates++;
+                    if ( ColliderUtils::FindInside_Radius_Q(testItem, checkItem) )
+                        collisions++;
+                });
+            }
+            const auto queryafter = bench::clock::now();
+
+            if ( frame < cfg.warmup )
+                continue;
+
+            buildhist.record(bench::elapsed_ns(buildbefore, buildafter));
+            queryhist.record(bench::elapsed_ns(querybefore, queryafter));
+        }
+
+        bench::do_not_optimize(collisions);
+
+        report(cfg, "build", buildhist, 0);
+        report(cfg, "query", queryhist, candidates);
+
+        if ( printBuckets )
+        {
+            report_buckets("build", buildhist);
+            report_buckets("query", queryhist);
+        }
+    };
+
+};  //end of anonymous namespace
+
+int main(int argc, char** argv)
+{
+    config cfg;
+    cfg.n         = bench::parse_count(bench::arg_value(argc, argv, "--n", "5000"));
+    cfg.frames    = bench::parse_count(bench::arg_value(argc, argv, "--frames", "2000"));
+    cfg.warmup    = bench::parse_count(bench::arg_value(argc, argv, "--warmup", "50"));
+    cfg.stripes   = bench::parse_count(bench::arg_value(argc, argv, "--stripes", "1000"));
+    cfg.width     = bench::parse_count(bench::arg_value(argc, argv, "--width", "8"));
+    cfg.dist      = bench::arg_value(argc, argv, "--dist", "uniform");
+    cfg.clusters  = bench::parse_count(bench::arg_value(argc, argv, "--clusters", "0"));
+    cfg.spread    = std::strtod(bench::arg_value(argc, argv, "--spread", "0.01").c_str(), nullptr);
+    cfg.velocity  = static_cast<int>(bench::parse_count(bench::arg_value(argc, argv, "--velocity", "200")));
+    cfg.margin    = static_cast<int>(bench::parse_count(bench::arg_value(argc, argv, "--margin", "1000")));
+    cfg.rebuild   = bench::arg_value(argc, argv, "--rebuild", "reset");
+    cfg.narrowphase = bench::arg_value(argc, argv, "--narrowphase", "scalar");
+    cfg.container = bench::arg_value(argc, argv, "--container", "stripe_map");
+    cfg.maxsize   = static_cast<int>(bench::parse_count(bench::arg_value(argc, argv, "--maxsize", "0")));
+    cfg.large     = std::strtod(bench::arg_value(argc, argv, "--large", "0.05").c_str(), nullptr);
+    cfg.seed      = bench::parse_count(bench::arg_value(argc, argv, "--seed", "1"));
+
+    const bool printbuckets = bench::arg_value(argc, argv, "--histogram", "0") != "0";
+
+    uti_WorkloadGenerator::Distribution parsed;
+    if ( !ParseWorkloadDistribution(cfg.dist.c_str(), parsed) )
+    {
+        std::fprintf(stderr, "unknown --dist %s ( uniform|clusters|zipf|corridor|one_stripe|beyond_max )\n", cfg.dist.c_str());
+        return 1;
+    }
+
+    std::printf("row,phase,n,frames,velocity,dist,rebuild,narrowphase,container,p50_ns,p99_ns,p999_ns,max_ns,candidates,peak_rss_bytes\n");
+
+    run_simulation(cfg, printbuckets);
+
+    return 0;
+}
@@ -3,7 +3,7 @@
 #include <assert.h>
 
 #include <stripe_map.hpp>
-#include <_Utilities/uti_RandomGenerator.h>
+#include <_Utilities/uti_WorkloadGenerator.h>
 #include <_Utilities/uti_FindInside.hpp>
 
 static constexpr size_t TOTAL_AMOUNT = 5000;
@@ -13,12 +13,10 @@ const int mapWidth  = 500000;
 const int mapHeight = 500000;
 const int mapCols = 12;
 const int mapRows = 12;
-const int mapWidth_s  = mapWidth / 1000;
-const int mapHeight_s = mapHeight / 1000;
 
 const int rectSize = 350;
 
-uti_RandomGenerator uti_RandomGenerator::instance;
+static constexpr uint64_t WORKLOAD_SEED = 1;
 
 struct Rect
 {
@@ -29,8 +27,45 @@ struct Rect
 
 };  //test struct
 
+///Fields of Rect read by the quick distance check - copied inline next to each key
+struct RectHot
+{
+    int x = 0;
+    int y = 0;
+    int w = 0;
+
+};  //hot projection
+
+struct RectHotProj
+{
+    inline RectHot
+        operator()(Rect* const& rect) const {
+        return RectHot{ rect->x, rect->y, rect->w };
+    };
+};
+
+///Secondary axis and extent of Rect for per-stripe bounds
+struct RectY
+{
+    inline int64_t
+        operator()(Rect* const& rect) const {
+        return rect->y;
+    };
+};
+struct RectW
+{
+    inline int64_t
+        operator()(Rect* const& rect) const {
+        return rect->w;
+    };
+};
+
 std::vector<Rect> stripeLoadList;
-qmap::stripe_map<Rect*> stripeMap(mapWidth, 1000);
+qmap::stripe_map<Rect*,
+                 qmap::growth_double,
+                 qmap::index_adaptive,
+                 qmap::storage_hot<RectHotProj, uint32_t>,
+                 qmap::bounds_tracked<RectY, RectW>> stripeMap(mapWidth, 1000);
 
 ///-------------------------------------------------------------------------------------------------------
 ///STRIPE_MAP TEST
@@ -44,11 +79,13 @@ namespace CheckStripeMap
 
         const uint64_t totalAmount = TOTAL_AMOUNT;
 
+        uti_WorkloadGenerator generator(WORKLOAD_SEED);
+
         for ( uint64_t i = 0; i < totalAmount; i++ )
         {
             Rect tLoc;
-            tLoc.x = uti_RandomGenerator::Instance().GenerateRandom() * mapWidth_s;
-            tLoc.y = uti_RandomGenerator::Instance().GenerateRandom() * mapHeight_s;
+            tLoc.x = generator.NextBounded(mapWidth);
+            tLoc.y = generator.NextBounded(mapHeight);
             tLoc.w = rectSize;
             tLoc.h = rectSize;
 
@@ -62,7 +99,7 @@ namespace CheckStripeMap
                                         (afterTime - beforeTime);
 
         //REPORT TIME FOR BUILDING LIST
-        std::cout << "Time to build stripe_map load list: " << listBuildTime.count() << "ms" << std::endl;
+        std::cout << "Time to build stripe_map load list: " << listBuildTime.count() << "us" << std::endl;
     };
     ///
     void
@@ -84,7 +121,7 @@ namespace CheckStripeMap
             stripeMap.reset();
 
             for ( auto & item : stripeLoadList )
-                stripeMap.add(Prs::tpsPr<size_t, Rect*>(item.x, &item));
+                stripeMap.emplace(item.x, &item);
 
             stripeMap.shrink();
 
@@ -96,24 +133,27 @@ namespace CheckStripeMap
             //Checks all items in list against all other items
             for ( auto & testItem : stripeLoadList )
             {
-                int beforestripe = 0;
-                if ( testItem.x > 1000 )
-                    beforestripe = testItem.x - 1000;
-                int afterstripe = mapWidth;
-                if ( testItem.x < mapWidth - 1000 )
-                    testItem.x += 1000;
-
-                const auto beginstripe = stripeMap.begin(beforestripe);
-                const auto endstripe   = stripeMap.end(afterstripe);
-
-                for ( auto i = beginstripe; i != endstripe; i++ )
+                //Neighbour margin from largest extent held instead of a fixed guess
+                const int margin = ( testItem.w + stripeMap.query_margin() ) / 2 + 1;
+
+                const size_t beforestripe = testItem.x > margin ? testItem.x - margin : 0;
+                const size_t afterstripe  = testItem.x + margin;
+
+                //Stripes whose y bounds cannot reach testItem are skipped whole
+                //Quick distance runs on the inline copy - Rect is only read for candidates that pass it
+                stripeMap.query_bounded_hot(beforestripe,
+                                            afterstripe,
+                                            testItem.y - testItem.w / 2,
+                                            testItem.y + testItem.w / 2,
+                                            [&](const RectHot& hot)
                 {
-                    const auto & checkItem = i->_2;
-                    if ( &testItem == checkItem ) continue;
-
-                    const int distCheck = abs(testItem.x - checkItem->x) - 1000;
-                    if ( !std::signbit(distCheck) )
-                        continue;
+                    return ColliderUtils::FindQuickDistance(hot.x - testItem.x,
+                                                           hot.y - testItem.y) <= testItem.w + hot.w;
+                },
+                                            [&](const auto& i)
+                {
+                    const auto & checkItem = i._2;
+                    if ( &testItem == checkItem ) return;
 
                     bool inside = ColliderUtils::FindInside_Radius_Q(testItem,
                                                                      *checkItem);
@@ -121,7 +161,7 @@ namespace CheckStripeMap
                         collisions++;
 
                     itemsChecked_total++;
-                }
+                });
                 itemsChecked++;
             }
 
@@ -132,7 +172,7 @@ namespace CheckStripeMap
                                         (afterTime - beforeTime);
 
         //REPORT TIME FOR RUNNING DISTANCE CHECK
-        std::cout << "Time to check distance: " << distCheckTime.count() << "ms" << std::endl;
+        std::cout << "Time to check distance: " << distCheckTime.count() << "us" << std::endl;
         std::cout << "Items Checked: " << itemsChecked << std::endl;
         std::cout << "Total Items Checked: " << itemsChecked_total << std::endl;
         std::cout << "Total Collisions: " << collisions << std::endl;
@@ -29,10 +29,10 @@ namespace ColliderUtils
                                                 abs(target.y - self.y) - total_half.y);
 
         //not inside X can return no collision
-        if ( !signbit(distance.x) )
+        if ( !std::signbit(distance.x) )
             return false;
         //not inside Y can return no collision
-        if ( !signbit(distance.y) )
+        if ( !std::signbit(distance.y) )
             return false;
 
         //collision
@@ -0,0 +1,204 @@
+#ifndef UTI_FINDINSIDEBATCH_H
+#define UTI_FINDINSIDEBATCH_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#if defined(__AVX2__) && !defined(COLLIDER_NO_SIMD)
+    #include <immintrin.h>
+    #define COLLIDER_BATCH_AVX2 1
+#endif
+
+///Batched narrowphase - one probe against a SoA block of candidates ( x | y | w | h arrays )
+///--- ( Integer-exact versions of FindInside_Radius_Q / FindInside_Square without sqrt )
+///--- ( Coordinates are expected within +-2^30 so per-axis differences fit in int )
+namespace ColliderUtils
+{
+    namespace implem
+    {
+        ///Spreads 4 bits to even bit positions ( b0..b3 -> bits 0,2,4,6 )
+        static constexpr uint8_t SPREAD_EVEN[16] = { 0x00, 0x01, 0x04, 0x05, 0x10, 0x11, 0x14, 0x15,
+                                                     0x40, 0x41, 0x44, 0x45, 0x50, 0x51, 0x54, 0x55 };
+    };
+
+    ///-------------------------------------------------------------------------------------------------------
+    ///SCALAR KERNELS                                              ------------------------------------------
+
+    ///Radius test matching FindInside_Radius_Q for combined widths >= 3
+    ///--- ( trunc(sqrt(d2)) <= H  <=>  d2 < (H + 1)^2  with H = (selfW + targetW) / 2 )
+    static inline bool
+        FindInside_Radius_Exact(const int selfX, const int selfY, const int selfW,
+                                const int targX, const int targY, const int targW)
+    {
+        const int64_t dx = targX - selfX;
+        const int64_t dy = targY - selfY;
+        const int64_t limit = ( ( selfW + targW ) >> 1 ) + 1;
+
+        return dx * dx + dy * dy < limit * limit;
+    };
+
+    ///Square test matching FindInside_Square ( halves truncated like the unsigned casts there )
+    static inline bool
+        FindInside_Square_Exact(const int selfX, const int selfY, const int selfW, const int selfH,
+                                const int targX, const int targY, const int targW, const int targH)
+    {
+        const int halfx = ( selfW >> 1 ) + ( targW >> 1 );
+        const int halfy = ( selfH >> 1 ) + ( targH >> 1 );
+
+        return abs(targX - selfX) < halfx && abs(targY - selfY) < halfy;
+    };
+
+    ///-------------------------------------------------------------------------------------------------------
+    ///8-WIDE KERNELS ( AVX2 WHEN AVAILABLE, SCALAR OTHERWISE )     ------------------------------------------
+
+    ///Returns bitmask of which of the 8 candidates lie inside self's radius ( bit i = candidate i )
+    template <typename T>
+    static inline uint32_t
+        FindInside_Radius_Q8(const T& self,     ///<Expects structure with w|x|y members
+                             const int* x,
+                             const int* y,
+                             const int* w)
+    {
+    #if defined(COLLIDER_BATCH_AVX2)
+        const __m256i dx = _mm256_sub_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(x)),
+                                            _mm256_set1_epi32(self.x));
+        const __m256i dy = _mm256_sub_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(y)),
+                                            _mm256_set1_epi32(self.y));
+        const __m256i lim = _mm256_add_epi32(_mm256_srai_epi32(_mm256_add_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(w)),
+                                                                                _mm256_set1_epi32(self.w)), 1),
+                                             _mm256_set1_epi32(1));
+
+        //Even lanes squared into 64 bit, then odd lanes shifted down and squared
+        const __m256i d2even  = _mm256_add_epi64(_mm256_mul_epi32(dx, dx), _mm256_mul_epi32(dy, dy));
+        const __m256i lim2even = _mm256_mul_epi32(lim, lim);
+
+        const __m256i dxodd  = _mm256_srli_epi64(dx, 32);
+        const __m256i dyodd  = _mm256_srli_epi64(dy, 32);
+        const __m256i limodd = _mm256_srli_epi64(lim, 32);
+        const __m256i d2odd   = _mm256_add_epi64(_mm256_mul_epi32(dxodd, dxodd), _mm256_mul_epi32(dyodd, dyodd));
+        const __m256i lim2odd = _mm256_mul_epi32(limodd, limodd);
+
+        const uint32_t even = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(lim2even, d2even)));
+        const uint32_t odd  = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(lim2odd, d2odd)));
+
+        return implem::SPREAD_EVEN[even] | ( implem::SPREAD_EVEN[odd] << 1 );
+    #else
+        uint32_t mask = 0;
+        for ( int i = 0; i < 8; i++ )
+            mask |= uint32_t(FindInside_Radius_Exact(self.x, self.y, self.w, x[i], y[i], w[i])) << i;
+
+        return mask;
+    #endif
+    };
+
+    ///Returns bitmask of which of the 8 candidates overlap self's rectangle ( bit i = candidate i )
+    template <typename T>
+    static inline uint32_t
+        FindInside_Square8(const T& self,       ///<Expects structure with w|h|x|y members
+                           const int* x,
+                           const int* y,
+                           const int* w,
+                           const int* h)
+    {
+    #if defined(COLLIDER_BATCH_AVX2)
+        const __m256i adx = _mm256_abs_epi32(_mm256_sub_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(x)),
+                                                              _mm256_set1_epi32(self.x)));
+        const __m256i ady = _mm256_abs_epi32(_mm256_sub_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(y)),
+                                                              _mm256_set1_epi32(self.y)));
+        const __m256i halfx = _mm256_add_epi32(_mm256_srai_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(w)), 1),
+                                               _mm256_set1_epi32(self.w >> 1));
+        const __m256i halfy = _mm256_add_epi32(_mm256_srai_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(h)), 1),
+                                               _mm256_set1_epi32(self.h >> 1));
+
+        const __m256i inside = _mm256_and_si256(_mm256_cmpgt_epi32(halfx, adx),
+                                                _mm256_cmpgt_epi32(halfy, ady));
+
+        return _mm256_movemask_ps(_mm256_castsi256_ps(inside));
+    #else
+        uint32_t mask = 0;
+        for ( int i = 0; i < 8; i++ )
+            mask |= uint32_t(FindInside_Square_Exact(self.x, self.y, self.w, self.h,
+                                                     x[i], y[i], w[i], h[i])) << i;
+
+        return mask;
+    #endif
+    };
+
+    ///-------------------------------------------------------------------------------------------------------
+    ///BLOCK KERNELS                                               ------------------------------------------
+
+    ///Tests count candidates against self radius, writing hit bits into masks ( ceil(count / 64) words )
+    ///--- ( Returns number of hits )
+    template <typename T>
+    static inline size_t
+        FindInside_Radius_Batch(const T& self,
+                                const int* x,
+                                const int* y,
+                                const int* w,
+                                const size_t count,
+                                uint64_t* masks)
+    {
+        size_t hits = 0;
+        size_t i = 0;
+
+        for ( size_t word = 0; word < ( count + 63 ) / 64; word++ )
+            masks[word] = 0;
+
+        for ( ; i + 8 <= count; i += 8 )
+        {
+            const uint64_t m = FindInside_Radius_Q8(self, x + i, y + i, w + i);
+            masks[i >> 6] |= m << ( i & 63 );
+            hits += __builtin_popcount(static_cast<uint32_t>(m));
+        }
+        for ( ; i < count; i++ )
+        {
+            if ( FindInside_Radius_Exact(self.x, self.y, self.w, x[i], y[i], w[i]) )
+            {
+                masks[i >> 6] |= uint64_t(1) << ( i & 63 );
+                hits++;
+            }
+        }
+
+        return hits;
+    };
+
+    ///Tests count candidates against self rectangle, writing hit bits into masks ( ceil(count / 64) words )
+    ///--- ( Returns number of hits )
+    template <typename T>
+    static inline size_t
+        FindInside_Square_Batch(const T& self,
+                                const int* x,
+                                const int* y,
+                                const int* w,
+                                const int* h,
+                                const size_t count,
+                                uint64_t* masks)
+    {
+        size_t hits = 0;
+        size_t i = 0;
+
+        for ( size_t word = 0; word < ( count + 63 ) / 64; word++ )
+            masks[word] = 0;
+
+        for ( ; i + 8 <= count; i += 8 )
+        {
+            const uint64_t m = FindInside_Square8(self, x + i, y + i, w + i, h + i);
+            masks[i >> 6] |= m << ( i & 63 );
+            hits += __builtin_popcount(static_cast<uint32_t>(m));
+        }
+        for ( ; i < count; i++ )
+        {
+            if ( FindInside_Square_Exact(self.x, self.y, self.w, self.h, x[i], y[i], w[i], h[i]) )
+            {
+                masks[i >> 6] |= uint64_t(1) << ( i & 63 );
+                hits++;
+            }
+        }
+
+        return hits;
+    };
+
+};
+
+#endif // UTI_FINDINSIDEBATCH_H
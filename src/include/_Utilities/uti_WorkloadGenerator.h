@@ -0,0 +1,419 @@
+#ifndef UTI_WORKLOADGENERATOR_H
+#define UTI_WORKLOADGENERATOR_H
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <stdint.h>
+#include <vector>
+
+#include <str_PairedValues.hpp>
+
+///Seeded key/point generator for benchmarks and tests
+///--- ( Unlike uti_RandomGenerator this is not a singleton - every instance owns an explicit seed + stream )
+class uti_WorkloadGenerator
+{
+    public:
+        ///Shapes of generated key sets
+        enum class Distribution
+        {
+            Uniform,        ///< uniform over [0, depthMax)
+            Clusters,       ///< gaussian clusters around random centres
+            Zipf,           ///< zipf-ranked hotspots with small jitter
+            Corridor,       ///< points along a narrow diagonal line/corridor
+            OneStripe,      ///< adversarial - every key lands in the same stripe
+            BeyondMax       ///< adversarial - every key is >= depthMax
+        };
+
+        ///Generation settings - centres and hotspot tables are derived from the generator seed
+        struct Settings
+        {
+            Distribution distribution = Distribution::Uniform;
+            size_t depthMax       = 500000;     ///< exclusive upper bound of keys ( and of both point axes )
+            size_t stripeDepth    = 500;        ///< depth per stripe, used by OneStripe
+            size_t clusters       = 16;         ///< cluster count for Clusters
+            double clusterSpread  = 0.01;       ///< cluster standard deviation as fraction of depthMax
+            size_t hotspots       = 64;         ///< hotspot count for Zipf
+            double zipfSkew       = 1.1;        ///< zipf exponent for Zipf
+            double corridorWidth  = 0.01;       ///< corridor half-width as fraction of depthMax
+        };
+
+        ///Makes generator for given seed and independent stream ( ex: thread index )
+        uti_WorkloadGenerator(const uint64_t seed,
+                              const uint64_t stream = 0)
+        {
+            uint64_t sm = seed;
+            for ( auto & word : state )
+                word = SplitMix64(sm);
+
+            //Each stream is 2^128 draws apart from the previous one
+            for ( uint64_t i = 0; i < stream; i++ )
+                Jump();
+        };
+
+        ///-------------------------------------------------------------------------------------------------------
+        ///RAW GENERATION
+
+        ///Next 64 random bits ( xoshiro256** )
+        inline uint64_t
+            Next()
+        {
+            const uint64_t result = RotL(state[1] * 5, 7) * 9;
+            const uint64_t t = state[1] << 17;
+
+            state[2] ^= state[0];
+            state[3] ^= state[1];
+            state[1] ^= state[2];
+            state[0] ^= state[3];
+            state[2] ^= t;
+            state[3] = RotL(state[3], 45);
+
+            return result;
+        };
+        ///Unbiased value in [0, range) ( Lemire multiply-shift with rejection )
+        inline uint64_t
+            NextBounded(const uint64_t range)
+        {
+            if ( range == 0 )
+                return 0;
+
+            unsigned __int128 m = static_cast<unsigned __int128>(Next()) * range;
+            uint64_t low = static_cast<uint64_t>(m);
+            if ( low < range )
+            {
+                const uint64_t threshold = -range % range;
+                while ( low < threshold )
+                {
+                    m = static_cast<unsigned __int128>(Next()) * range;
+                    low = static_cast<uint64_t>(m);
+                }
+            }
+
+            return static_cast<uint64_t>(m >> 64);
+        };
+        ///Uniform double in [0, 1)
+        inline double
+            NextUnit()
+        {
+            return ( Next() >> 11 ) * 0x1.0p-53;
+        };
+        ///Standard normal value ( Marsaglia polar method, second value cached )
+        inline double
+            NextGaussian()
+        {
+            if ( hasSpare )
+            {
+                hasSpare = false;
+                return spare;
+            }
+
+            double u, v, s;
+            do
+            {
+                u = NextUnit() * 2.0 - 1.0;
+                v = NextUnit() * 2.0 - 1.0;
+                s = u * u + v * v;
+            } while ( s >= 1.0 || s == 0.0 );
+
+            const double scale = std::sqrt(-2.0 * std::log(s) / s);
+
+            spare    = v * scale;
+            hasSpare = true;
+
+            return u * scale;
+        };
+
+        ///Approximately normal value from a single draw ( Irwin-Hall sum of four 16 bit uniforms, tails cut at +-3.46 )
+        ///--- ( Used for cluster jitter where transcendental calls would dominate generation time )
+        inline double
+            NextQuickGaussian()
+        {
+            const uint64_t bits = Next();
+            const uint64_t sum  = ( bits & 0xffff ) + ( ( bits >> 16 ) & 0xffff )
+                                + ( ( bits >> 32 ) & 0xffff ) + ( bits >> 48 );
+
+            //Sum of four U(0,1) has mean 2 and variance 1/3
+            return ( sum * ( 1.0 / 65536.0 ) - 2.0 ) * 1.7320508075688772;
+        };
+
+        ///-------------------------------------------------------------------------------------------------------
+        ///WORKLOAD GENERATION
+
+        ///Fills out with count keys drawn from settings.distribution
+        inline void
+            GenerateKeys(const Settings& settings,
+                         size_t* out,
+                         const size_t count)
+        {
+            Prepare(settings);
+
+            switch ( settings.distribution )
+            {
+                case Distribution::Uniform:
+                    for ( size_t i = 0; i < count; i++ )
+                        out[i] = NextBounded(settings.depthMax);
+                    break;
+
+                case Distribution::OneStripe:
+                    for ( size_t i = 0; i < count; i++ )
+                        out[i] = oneStripeStart + NextBounded(std::max<size_t>(1, settings.stripeDepth));
+                    break;
+
+                case Distribution::BeyondMax:
+                    for ( size_t i = 0; i < count; i++ )
+                        out[i] = settings.depthMax + NextBounded(BeyondSpan(settings.depthMax));
+                    break;
+
+                default:
+                    for ( size_t i = 0; i < count; i++ )
+                        out[i] = static_cast<size_t>(NextPoint(settings).x);
+                    break;
+            }
+        };
+        ///Fills out with count 2D points ( both axes within [0, depthMax) except BeyondMax on x, saturating at INT_MAX )
+        inline void
+            GeneratePoints(const Settings& settings,
+                           Prs::xyPr<int>* out,
+                           const size_t count)
+        {
+            Prepare(settings);
+
+            for ( size_t i = 0; i < count; i++ )
+                out[i] = NextPoint(settings);
+        };
+        ///Returns vector of count keys ( convenience wrapper )
+        inline std::vector<size_t>
+            Keys(const Settings& settings,
+                 const size_t count)
+        {
+            std::vector<size_t> keys(count);
+            GenerateKeys(settings, keys.data(), count);
+
+            return keys;
+        };
+
+    private:
+        static inline uint64_t
+            RotL(const uint64_t x,
+                 const int k)
+        {
+            return ( x << k ) | ( x >> ( 64 - k ) );
+        };
+        static inline uint64_t
+            SplitMix64(uint64_t& x)
+        {
+            uint64_t z = ( x += 0x9e3779b97f4a7c15ULL );
+            z = ( z ^ ( z >> 30 ) ) * 0xbf58476d1ce4e5b9ULL;
+            z = ( z ^ ( z >> 27 ) ) * 0x94d049bb133111ebULL;
+            return z ^ ( z >> 31 );
+        };
+        ///Advances state by 2^128 draws ( reference xoshiro256 jump polynomial )
+        inline void
+            Jump()
+        {
+            static const uint64_t JUMP[] = { 0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL,
+                                             0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL };
+            uint64_t s[4] = { 0, 0, 0, 0 };
+            for ( const uint64_t jump : JUMP )
+            {
+                for ( int b = 0; b < 64; b++ )
+                {
+                    if ( jump & ( 1ULL << b ) )
+                    {
+                        s[0] ^= state[0];
+                        s[1] ^= state[1];
+                        s[2] ^= state[2];
+                        s[3] ^= state[3];
+                    }
+                    Next();
+                }
+            }
+
+            std::copy(s, s + 4, state);
+        };
+        ///Returns true if a and b derive the same centres / zipf tables ( every field Prepare reads )
+        static inline bool
+            SamePrepare(const Settings& a,
+                        const Settings& b)
+        {
+            return a.distribution == b.distribution
+                && a.depthMax     == b.depthMax
+                && a.stripeDepth  == b.stripeDepth
+                && a.clusters     == b.clusters
+                && a.hotspots     == b.hotspots
+                && a.zipfSkew     == b.zipfSkew;
+        };
+        ///Builds cluster centres / zipf tables once per distinct settings
+        inline void
+            Prepare(const Settings& settings)
+        {
+            if ( prepared && SamePrepare(preparedSettings, settings) )
+                return;
+
+            prepared         = true;
+            preparedSettings = settings;
+
+            centres.clear();
+
+            if ( settings.distribution == Distribution::Clusters )
+            {
+                for ( size_t i = 0; i < std::max<size_t>(1, settings.clusters); i++ )
+                    centres.push_back(Prs::xyPr<int>(NextBounded(settings.depthMax),
+                                                     NextBounded(settings.depthMax)));
+            }
+            else if ( settings.distribution == Distribution::OneStripe )
+            {
+                const size_t stripedepth = std::max<size_t>(1, settings.stripeDepth);
+                oneStripeStart = NextBounded(std::max<size_t>(1, settings.depthMax / stripedepth)) * stripedepth;
+            }
+            else if ( settings.distribution == Distribution::Zipf )
+            {
+                const size_t hotspots = std::max<size_t>(1, settings.hotspots);
+
+                std::vector<double> weights(hotspots);
+                double total = 0.0;
+                for ( size_t i = 0; i < hotspots; i++ )
+                {
+                    centres.push_back(Prs::xyPr<int>(NextBounded(settings.depthMax),
+                                                     NextBounded(settings.depthMax)));
+                    weights[i] = 1.0 / std::pow(i + 1.0, settings.zipfSkew);
+                    total += weights[i];
+                }
+
+                BuildAliasTable(weights, total);
+            }
+        };
+        ///Builds Walker alias table so zipf ranks are drawn in O(1)
+        inline void
+            BuildAliasTable(std::vector<double>& weights,
+                            const double total)
+        {
+            const size_t count = weights.size();
+            aliasProb.assign(count, 1.0);
+            aliasIndex.assign(count, 0);
+
+            std::vector<size_t> small, large;
+            for ( size_t i = 0; i < count; i++ )
+            {
+                weights[i] = weights[i] * count / total;
+                aliasIndex[i] = i;
+                ( weights[i] < 1.0 ? small : large ).push_back(i);
+            }
+
+            while ( !small.empty() && !large.empty() )
+            {
+                const size_t lo = small.back(); small.pop_back();
+                const size_t hi = large.back();
+
+                aliasProb[lo]  = weights[lo];
+                aliasIndex[lo] = hi;
+
+                weights[hi] -= 1.0 - weights[lo];
+                if ( weights[hi] < 1.0 )
+                {
+                    large.pop_back();
+                    small.push_back(hi);
+                }
+            }
+        };
+        ///Span of BeyondMax keys above depthMax that cannot wrap size_t
+        static inline size_t
+            BeyondSpan(const size_t depthMax){
+            return std::min<size_t>(depthMax, SIZE_MAX - depthMax);
+        };
+        ///Saturates unsigned coordinate at INT_MAX
+        static inline int
+            Axis(const uint64_t v){
+            return static_cast<int>(std::min<uint64_t>(v, INT_MAX));
+        };
+        ///Clamps value into [0, depthMax)
+        static inline int
+            Clamp(const double v,
+                  const size_t depthMax)
+        {
+            return static_cast<int>(std::min<double>(std::min<double>(std::max(v, 0.0), depthMax - 1.0), INT_MAX));
+        };
+        ///Draws single point for the prepared distribution
+        inline Prs::xyPr<int>
+            NextPoint(const Settings& settings)
+        {
+            const double depth = static_cast<double>(settings.depthMax);
+
+            switch ( settings.distribution )
+            {
+                case Distribution::Clusters:
+                {
+                    const auto & centre = centres[NextBounded(centres.size())];
+                    const double sigma = depth * settings.clusterSpread;
+                    return Prs::xyPr<int>(Clamp(centre.x + NextQuickGaussian() * sigma, settings.depthMax),
+                                          Clamp(centre.y + NextQuickGaussian() * sigma, settings.depthMax));
+                }
+                case Distribution::Zipf:
+                {
+                    const size_t column = NextBounded(centres.size());
+                    const size_t rank = NextUnit() < aliasProb[column] ? column : aliasIndex[column];
+                    const auto & centre = centres[rank];
+                    const double sigma = depth * 0.001;
+                    return Prs::xyPr<int>(Clamp(centre.x + NextQuickGaussian() * sigma, settings.depthMax),
+                                          Clamp(centre.y + NextQuickGaussian() * sigma, settings.depthMax));
+                }
+                case Distribution::Corridor:
+                {
+                    const double along = NextUnit() * depth;
+                    const double off = ( NextUnit() * 2.0 - 1.0 ) * depth * settings.corridorWidth;
+                    return Prs::xyPr<int>(Clamp(along, settings.depthMax),
+                                          Clamp(along + off, settings.depthMax));
+                }
+                case Distribution::OneStripe:
+                    return Prs::xyPr<int>(Axis(oneStripeStart + NextBounded(std::max<size_t>(1, settings.stripeDepth))),
+                                          Axis(NextBounded(settings.depthMax)));
+                case Distribution::BeyondMax:
+                    return Prs::xyPr<int>(Axis(settings.depthMax + NextBounded(BeyondSpan(settings.depthMax))),
+                                          Axis(NextBounded(settings.depthMax)));
+                default:
+                    return Prs::xyPr<int>(Axis(NextBounded(settings.depthMax)),
+                                          Axis(NextBounded(settings.depthMax)));
+            }
+        };
+
+        uint64_t state[4];
+
+        bool hasSpare = false;
+        double spare  = 0.0;
+
+        bool prepared = false;
+        Settings preparedSettings;
+        size_t oneStripeStart = 0;
+        std::vector<Prs::xyPr<int>> centres;
+        std::vector<double> aliasProb;
+        std::vector<size_t> aliasIndex;
+};
+
+///Parses distribution name ( uniform|clusters|zipf|corridor|one_stripe|beyond_max ) into dist
+///--- ( Returns false and leaves dist untouched for unknown names )
+static inline bool
+    ParseWorkloadDistribution(const char* name,
+                              uti_WorkloadGenerator::Distribution& dist)
+{
+    using D = uti_WorkloadGenerator::Distribution;
+
+    const struct { const char* name; D dist; } NAMES[] = {
+        { "uniform", D::Uniform }, { "clusters", D::Clusters }, { "zipf", D::Zipf },
+        { "corridor", D::Corridor }, { "one_stripe", D::OneStripe }, { "beyond_max", D::BeyondMax } };
+
+    for ( const auto & entry : NAMES )
+    {
+        const char* a = entry.name;
+        const char* b = name;
+        while ( *a != '\0' && *a == *b ){ a++; b++; }
+        if ( *a == '\0' && *b == '\0' )
+        {
+            dist = entry.dist;
+            return true;
+        }
+    }
+
+    return false;
+};
+
+#endif // UTI_WORKLOADGENERATOR_H
@@ -155,11 +155,10 @@ namespace Prs
         ///DEFAULT CONSTRUCTOR = LEFT UNINITIALIZED
         ///--- ( INSTANTIATION OF TPSPR WITH DEFAULT CONST
         ///---   REQUIRES OBJECTS WITH DEFAULT CONSTRUCTORS )
-        tpsPr()
-        {
-            _1 = T();
-            _2 = U();
-        };
+        tpsPr():
+            _1(),
+            _2()
+        {};
         ///CONSTRUCT FROM MOVE WITH DEFINED VALUES
         tpsPr(const T& _1,
               const U& _2):
@@ -189,6 +188,15 @@ namespace Prs
             _1 = op._1;
             _2 = op._2;
 
+            return *this;
+        };
+        ///ASSIGNMENT OPERATOR FROM MOVE
+        inline tpsPr&
+            operator=(tpsPr&& mv)
+        {
+            _1 = std::move(mv._1);
+            _2 = std::move(mv._2);
+
             return *this;
         };
     };
@@ -0,0 +1,369 @@
+#ifndef STRIPE_BUILDER_HPP
+#define STRIPE_BUILDER_HPP
+
+#include <stdint.h>
+
+#include <stripe_map.hpp>
+
+namespace qmap
+{
+    namespace implem
+    {
+        ///Default items per stripe buffer ( and block ) if no budget is provided
+        static constexpr size_t SBUILD_INIT_BLOCK_ITEMS = 64;
+        ///Build arrays grow by 1 / SBUILD_GROWTH_DIV of their items at a time unless a budget caps the step
+        static constexpr size_t SBUILD_GROWTH_DIV       = 4;
+
+    };  //end of helper namespace
+
+    ///-------------------------------------------------------------------------------------------------------
+    ///BEGIN OF STRIPE_BUILDER CLASS
+    ///--- ( Streams chunks of items into a stripe_map : feed() drops each item into a small buffer of its stripe, and every full )
+    ///--- ( buffer is appended as one block to a build array of the map's own item store, which grows in place )
+    ///--- ( finish() swaps whole blocks into their stripes inside the build array, fills the stripe edges from the buffers and )
+    ///--- ( hands the array to the map as its exact shrunk array - no restripe, no second array and no trailing shrink() )
+    ///--- ( budgetBytes caps the buffer bytes ( stripes * block items ) and the build array's growth step, 0 gives each stripe )
+    ///--- ( SBUILD_INIT_BLOCK_ITEMS and grows by a quarter - stores that cannot grow in place always grow by a quarter )
+    ///--- ( Map must not be reset or resized while items are fed - stripe counts are kept per stripe index )
+    template <typename Map>
+    class stripe_builder
+    {
+        public:
+            typedef typename Map::item_type item_type;
+            typedef typename Map::item_store item_store;
+
+            ///MAKE STRIPE_BUILDER
+            stripe_builder(Map& map,
+                           const size_t budgetBytes = 0):
+                _sbuild_map(map),
+                _sbuild_budget(budgetBytes)
+            {   using namespace implem;
+
+                if ( !_sbuild_map._smap_is_reserved )
+                    _sbuild_map.init_reserve();
+
+                _sbuild_stripe_amnt = _sbuild_map._smap_stripe_stripes;
+                _sbuild_counts      = new size_t[_sbuild_stripe_amnt * 2]();
+                _sbuild_fill        = _sbuild_counts + _sbuild_stripe_amnt;
+
+                //Two spare blocks past the stripe buffers carry blocks while they swap
+                _sbuild_block = SBUILD_INIT_BLOCK_ITEMS;
+                if ( _sbuild_budget != 0 )
+                    _sbuild_block = std::max<size_t>(1, _sbuild_budget / ( ( _sbuild_stripe_amnt + 2 ) * slot_bytes() ));
+
+                _sbuild_buffers.make(( _sbuild_stripe_amnt + 2 ) * _sbuild_block);
+
+                if constexpr ( item_store::HANDLED )
+                {
+                    _sbuild_buffers._table = &_sbuild_map._smap_handles;
+                    _sbuild_items._table   = &_sbuild_map._smap_handles;
+                }
+            };
+            stripe_builder(const stripe_builder&) = delete;
+            stripe_builder& operator=(const stripe_builder&) = delete;
+            ///CLEANUP
+            ///--- ( Items still fed are written to the map )
+            virtual ~stripe_builder()
+            {
+                finish();
+
+                if ( _sbuild_capacity != 0 )
+                    _sbuild_items.release();
+                _sbuild_buffers.release();
+
+                delete[] _sbuild_counts;
+            };
+
+            ///-------------------------------------------------------------------------------------------------------
+            ///OPERATIONAL FUNCTIONS
+
+            ///Feeds count items from chunk - returns false if the build array cannot grow ( slot indices would overflow )
+            inline bool
+                feed(const item_type* chunk,
+                     const size_t count)
+            {
+                for ( size_t i = 0; i < count; i++ )
+                {
+                    if ( !feed(chunk[i]) )
+                        return false;
+                }
+
+                return true;
+            };
+            ///Feeds single item - returns false if the build array cannot grow ( slot indices would overflow )
+            inline bool
+                feed(const item_type& item)
+            {
+                const size_t stripeindex = _sbuild_map.stripe_index(Map::key_of(item));
+
+                _sbuild_buffers.put(stripeindex * _sbuild_block + _sbuild_fill[stripeindex], item);
+                _sbuild_counts[stripeindex]++;
+                _sbuild_staged++;
+
+                return ++_sbuild_fill[stripeindex] != _sbuild_block || append_block(stripeindex);
+            };
+            ///Sorts held and fed items into the map's shrunk layout - returns false and keeps everything fed if it failed
+            ///--- ( Map only changes here - it may be used between finish() calls, later feeds start a new build array )
+            inline bool
+                finish()
+            {   using namespace implem;
+
+                if ( _sbuild_staged == 0 )
+                {
+                    _sbuild_map.shrink();
+                    return true;
+                }
+
+                _sbuild_map.compact();
+
+                const size_t total = _sbuild_map._smap_items_count + _sbuild_staged;
+                if ( total > STRIPE_INDEX_MAX )
+                    return false;
+
+                //Blocks of the last stripe may run up to one block past the items until the edges are filled
+                if ( !reserve(( total + _sbuild_block - 1 ) / _sbuild_block * _sbuild_block) )
+                    return false;
+
+                //Held items join as if they were fed
+                for ( size_t s = 0; s < _sbuild_stripe_amnt; s++ )
+                {
+                    const size_t oldstart = _sbuild_map._smap_stripes[s].get_start();
+                    for ( size_t i = 0; i < _sbuild_map._smap_stripes[s].used(); i++ )
+                    {
+                        _sbuild_buffers.move_from(s * _sbuild_block + _sbuild_fill[s], _sbuild_map._smap_items, oldstart + i);
+                        _sbuild_counts[s]++;
+
+                        if ( ++_sbuild_fill[s] == _sbuild_block )
+                            append_block(s);
+                    }
+                }
+
+                permute_blocks(total);
+
+                //Spare slots past the items are cut off ( failing to cut only leaves the array oversized )
+                _sbuild_items.resize(total, _sbuild_capacity);
+
+                _sbuild_map.adopt_sorted(_sbuild_items, _sbuild_counts, total);
+                if constexpr ( item_store::HANDLED )
+                    _sbuild_items._table = &_sbuild_map._smap_handles;
+
+                std::fill(_sbuild_counts, _sbuild_counts + _sbuild_stripe_amnt * 2, 0);
+                _sbuild_capacity = 0;
+                _sbuild_blocks   = 0;
+                _sbuild_staged   = 0;
+
+                return true;
+            };
+
+            ///-------------------------------------------------------------------------------------------------------
+            ///INFO FUNCTIONS
+
+            ///Items fed since the last finish()
+            inline size_t
+                staged(){
+                return _sbuild_staged;
+            };
+            ///Bytes held by the stripe buffers and the build array
+            inline size_t
+                staged_bytes(){
+                return ( ( _sbuild_stripe_amnt + 2 ) * _sbuild_block + _sbuild_capacity ) * slot_bytes();
+            };
+            ///Items per stripe buffer and block
+            inline size_t
+                block_items(){
+                return _sbuild_block;
+            };
+            ///Map being built
+            inline Map&
+                map(){
+                return _sbuild_map;
+            };
+
+        private:
+            ///Bytes per slot over every array of the item store ( handle indices included )
+            static inline size_t
+                slot_bytes()
+            {
+                size_t bytes = 0;
+                for ( size_t a = 0; a < item_store::ARRAY_COUNT; a++ )
+                    bytes += item_store::array_stride(a);
+
+                if constexpr ( item_store::HANDLED )
+                    bytes += sizeof(uint32_t);
+
+                return bytes;
+            };
+            ///Grows the build array to hold at least need slots plus the next growth step
+            inline bool
+                reserve(const size_t need)
+            {   using namespace implem;
+
+                if ( need <= _sbuild_capacity )
+                    return true;
+                if ( need > STRIPE_INDEX_MAX + _sbuild_block )
+                    return false;
+
+                size_t step = std::max(SMAP_INIT_SLOT_COUNT, need / SBUILD_GROWTH_DIV);
+                if ( _sbuild_budget != 0 && item_store::GROWS_IN_PLACE )
+                    step = std::max<size_t>(1, _sbuild_budget / slot_bytes());
+
+                const size_t capacity = need + step;
+
+                if ( _sbuild_capacity == 0 )
+                    _sbuild_items.make(capacity);
+                else if ( !_sbuild_items.resize(capacity, _sbuild_capacity) )
+                    return false;
+
+                _sbuild_capacity = capacity;
+
+                return true;
+            };
+            ///Moves the full buffer of stripe onto the end of the build array as one block
+            inline bool
+                append_block(const size_t stripeIndex)
+            {
+                const size_t blockstart = _sbuild_blocks * _sbuild_block;
+                if ( !reserve(blockstart + _sbuild_block) )
+                {
+                    //Last item stays counted but unfed
+                    _sbuild_fill[stripeIndex]--;
+                    _sbuild_counts[stripeIndex]--;
+                    _sbuild_staged--;
+
+                    return false;
+                }
+
+                move_block(_sbuild_items, blockstart, _sbuild_buffers, stripeIndex * _sbuild_block);
+
+                _sbuild_fill[stripeIndex] = 0;
+                _sbuild_blocks++;
+
+                return true;
+            };
+            ///Moves block items from srcStart of srcItems to dstStart of dstItems
+            inline void
+                move_block(item_store& dstItems,
+                           const size_t dstStart,
+                           item_store& srcItems,
+                           const size_t srcStart)
+            {
+                for ( size_t i = 0; i < _sbuild_block; i++ )
+                    dstItems.move_from(dstStart + i, srcItems, srcStart + i);
+            };
+            ///Stripe of block at blockStart of items ( every item of a block shares its stripe )
+            inline size_t
+                block_stripe(item_store& items,
+                             const size_t blockStart){
+                return _sbuild_map.stripe_index(items.key(blockStart));
+            };
+            ///Sorts the build array into stripe order - total counts held and fed items
+            ///--- ( Stripe s owns whole block positions from its first item rounded up to a block, so blocks are swapped into place )
+            ///--- ( with two spare blocks, each block read and written once - its last block may then run over into the next )
+            ///--- ( stripe's head, which is moved down to its own head before the buffer fills what is left of the stripe )
+            inline void
+                permute_blocks(const size_t total)
+            {
+                const size_t block    = _sbuild_block;
+                const size_t stripes  = _sbuild_stripe_amnt;
+                const size_t carryone = stripes * block;
+                const size_t carrytwo = carryone + block;
+
+                //Per stripe : first block position, next position to write and end of positions still holding unsorted blocks
+                size_t* firsts = new size_t[stripes * 3];
+                size_t* writes = firsts + stripes;
+                size_t* reads  = writes + stripes;
+
+                size_t itemstart = 0;
+                for ( size_t s = 0; s < stripes; s++ )
+                {
+                    firsts[s]  = ( itemstart + block - 1 ) / block;
+                    writes[s]  = firsts[s];
+                    itemstart += _sbuild_counts[s];
+                }
+                for ( size_t s = 0; s < stripes; s++ )
+                {
+                    const size_t next = s + 1 < stripes ? firsts[s + 1] : ( total + block - 1 ) / block;
+                    reads[s] = std::min(std::max(_sbuild_blocks, firsts[s]), next);
+                }
+
+                for ( size_t s = 0; s < stripes; s++ )
+                {
+                    while ( reads[s] > writes[s] )
+                    {
+                        reads[s]--;
+
+                        size_t carry = carryone;
+                        size_t dst   = block_stripe(_sbuild_items, reads[s] * block);
+                        move_block(_sbuild_buffers, carry, _sbuild_items, reads[s] * block);
+
+                        //Carried block lands on the next position of its stripe - an unsorted block there is picked up next
+                        for ( ;; )
+                        {
+                            const size_t position = writes[dst]++;
+                            if ( position >= reads[dst] )
+                            {
+                                move_block(_sbuild_items, position * block, _sbuild_buffers, carry);
+                                break;
+                            }
+
+                            const size_t found = block_stripe(_sbuild_items, position * block);
+                            if ( found == dst )
+                                continue;
+
+                            const size_t other = carry == carryone ? carrytwo : carryone;
+                            move_block(_sbuild_buffers, other, _sbuild_items, position * block);
+                            move_block(_sbuild_items, position * block, _sbuild_buffers, carry);
+
+                            carry = other;
+                            dst   = found;
+                        }
+                    }
+                }
+
+                //Stripe edges : run over from the blocks first, then the buffer
+                itemstart = 0;
+                for ( size_t s = 0; s < stripes; s++ )
+                {
+                    const size_t itemend   = itemstart + _sbuild_counts[s];
+                    const size_t blockslot = firsts[s] * block;
+                    const size_t blockend  = writes[s] * block;
+
+                    size_t slot = itemstart;
+                    if ( writes[s] != firsts[s] )
+                    {
+                        for ( size_t i = itemend; i < blockend; i++ )
+                            _sbuild_items.move_within(slot++, i);
+                    }
+
+                    size_t buffered = s * block;
+                    for ( ; slot < std::min(blockslot, itemend); slot++ )
+                        _sbuild_items.move_from(slot, _sbuild_buffers, buffered++);
+                    for ( slot = std::max(slot, blockend); slot < itemend; slot++ )
+                        _sbuild_items.move_from(slot, _sbuild_buffers, buffered++);
+
+                    itemstart = itemend;
+                }
+
+                delete[] firsts;
+            };
+
+            ///-------------------------------------------------------------------------------------------------------
+            ///INTERNAL STRIPE_BUILDER VARIABLES
+            Map& _sbuild_map;                       ///< map items are written to
+
+            item_store _sbuild_items;               ///< build array ( whole blocks in arrival order until finish() )
+            item_store _sbuild_buffers;             ///< one block per stripe plus two spare blocks
+            size_t* _sbuild_counts      = nullptr;  ///< items per stripe since the last finish()
+            size_t* _sbuild_fill        = nullptr;  ///< items in each stripe buffer ( shares _sbuild_counts allocation )
+
+            size_t _sbuild_budget       = 0;        ///< buffer and growth step cap in bytes ( 0 if unbounded )
+            size_t _sbuild_block        = implem::SBUILD_INIT_BLOCK_ITEMS;    ///< items per buffer and block
+            size_t _sbuild_blocks       = 0;        ///< blocks in the build array
+            size_t _sbuild_capacity     = 0;        ///< slots of the build array
+            size_t _sbuild_stripe_amnt  = 0;        ///< stripes of map ( fixed for its lifetime )
+            size_t _sbuild_staged       = 0;        ///< items fed since the last finish()
+    };
+
+};  //end of qmap namespace
+
+#endif // STRIPE_BUILDER_HPP
@@ -0,0 +1,335 @@
+#ifndef STRIPE_GRID_HPP
+#define STRIPE_GRID_HPP
+
+#include <algorithm>
+
+#include <uti_FindGridLocation.hpp>
+#include <stripe_map.hpp>
+
+namespace qmap
+{
+    namespace implem
+    {
+        ///Default grid layout if nothing is provided
+        static constexpr size_t SGRID_INIT_COLS = 16;
+        static constexpr size_t SGRID_INIT_ROWS = 16;
+        static constexpr size_t SGRID_INIT_SIZE = UINT16_MAX;
+
+    };  //end of helper namespace
+
+    ///-------------------------------------------------------------------------------------------------------
+    ///BEGIN OF STRIPE_GRID CLASS
+    ///--- ( rows x cols cells, each cell one implem::stripe in row-major order over a single item array )
+    template <typename V>
+    class stripe_grid
+    {
+        public:
+            ///MAKE STRIPE_GRID
+            stripe_grid(const size_t gridWidth  = implem::SGRID_INIT_SIZE,
+                        const size_t gridHeight = implem::SGRID_INIT_SIZE,
+                        const size_t gridCols   = implem::SGRID_INIT_COLS,
+                        const size_t gridRows   = implem::SGRID_INIT_ROWS,
+                        const size_t cellWdth   = implem::SMAP_INIT_WIDTH)
+            {
+                init(gridWidth,
+                     gridHeight,
+                     gridCols,
+                     gridRows,
+                     cellWdth);
+            };
+            stripe_grid(const stripe_grid&) = delete;
+            stripe_grid& operator=(const stripe_grid&) = delete;
+            ///CLEANUP
+            virtual ~stripe_grid()
+            {
+                delete_both();
+            };
+
+            ///-------------------------------------------------------------------------------------------------------
+            ///OPERATIONAL FUNCTIONS
+
+            ///Add value to the cell holding ( x, y )
+            inline bool
+                add(const int x,
+                    const int y,
+                    const V& value)
+            {
+                const size_t cellindex = cell_index(x, y);
+
+                auto attemptadd = _sgrid_stripes[cellindex].add();
+                if ( !attemptadd._1 && restripe() )
+                    attemptadd = _sgrid_stripes[cellindex].add();
+
+                if ( !attemptadd._1 )
+                    return false;
+
+                _sgrid_items.put(attemptadd._2, Prs::tpsPr<size_t, V>(cellindex, value));
+                _sgrid_items_count++;
+                _sgrid_is_shrunk = false;
+
+                return true;
+            };
+            ///Shrink cells to remove gaps - every cell's items become contiguous and cells follow row-major order
+            inline void
+                shrink()
+            {   using namespace implem;
+
+                if ( _sgrid_is_shrunk )
+                    return;
+
+                auto newitems = shrink_items(_sgrid_items,
+                                             _sgrid_stripes,
+                                             _sgrid_items_count);
+
+                _sgrid_items.release();
+                _sgrid_items       = newitems;
+                _sgrid_slots_count = _sgrid_items_count;
+                _sgrid_is_shrunk   = true;
+            };
+            ///Clears all cells of their items yet retains current size of stripe_grid
+            inline auto
+                clear()
+            {   using namespace implem;
+
+                const auto clearsucc = clear_stripe_all(_sgrid_stripes);
+
+                //Cleared cells leave gaps, so a shrunk grid has to shrink again
+                if ( clearsucc._1 )
+                {
+                    _sgrid_items_count -= clearsucc._2;
+                    _sgrid_is_shrunk = false;
+                }
+
+                return clearsucc;
+            };
+            ///Resets stripe_grid to its initial cell widths
+            inline void
+                reset()
+            {
+                delete_both();
+
+                make_cells();
+            };
+
+            ///-------------------------------------------------------------------------------------------------------
+            ///LOOKUP FUNCTIONS
+
+            ///Calls func on every item in the 3x3 cell neighbourhood around ( x, y ) - returns items visited
+            template <typename F>
+            inline size_t
+                query_neighbours(const int x,
+                                 const int y,
+                                 F&& func)
+            {
+                const size_t col = cell_col(x);
+                const size_t row = cell_row(y);
+
+                return visit_cells(col > 0 ? col - 1 : 0,
+                                   row > 0 ? row - 1 : 0,
+                                   std::min(col + 1, _sgrid_cols - 1),
+                                   std::min(row + 1, _sgrid_rows - 1),
+                                   func);
+            };
+            ///Calls func on every item in cells overlapping [xmin,xmax]x[ymin,ymax] - returns items visited
+            template <typename F>
+            inline size_t
+                query_rect(const int xmin,
+                           const int ymin,
+                           const int xmax,
+                           const int ymax,
+                           F&& func)
+            {
+                return visit_cells(cell_col(xmin), cell_row(ymin),
+                                   cell_col(xmax), cell_row(ymax),
+                                   func);
+            };
+            ///Calls func on every item in cell ( col, row ) - returns items visited
+            template <typename F>
+            inline size_t
+                query_cell(const size_t col,
+                           const size_t row,
+                           F&& func)
+            {
+                return visit_cells(col, row, col, row, func);
+            };
+
+            ///-------------------------------------------------------------------------------------------------------
+            ///INFO FUNCTIONS
+
+            ///Current stored items in stripe_grid
+            inline size_t
+                size(){
+                return _sgrid_items_count;
+            };
+            ///Current total slot count in stripe_grid
+            inline size_t
+                slots(){
+                return _sgrid_slots_count;
+            };
+            ///Column count of stripe_grid
+            inline size_t
+                cols(){
+                return _sgrid_cols;
+            };
+            ///Row count of stripe_grid
+            inline size_t
+                rows(){
+                return _sgrid_rows;
+            };
+            ///Column holding x ( clamped to grid )
+            inline size_t
+                cell_col(const int x){
+                return clamp_cell(x, _sgrid_width, _sgrid_cell_width, _sgrid_cols);
+            };
+            ///Row holding y ( clamped to grid )
+            inline size_t
+                cell_row(const int y){
+                return clamp_cell(y, _sgrid_height, _sgrid_cell_height, _sgrid_rows);
+            };
+            ///Row-major cell index holding ( x, y )
+            inline size_t
+                cell_index(const int x,
+                           const int y){
+                return cell_row(y) * _sgrid_cols + cell_col(x);
+            };
+
+        private:
+            ///Cell along one axis via GridMapUtils::FindGridLoc, clamped into [0, count)
+            static inline size_t
+                clamp_cell(const int loc,
+                           const size_t totalSize,
+                           const size_t cellSize,
+                           const size_t count)
+            {
+                if ( loc <= 0 )
+                    return 0;
+
+                const size_t cell = GridMapUtils::FindGridLoc(loc,
+                                                              static_cast<int>(totalSize),
+                                                              static_cast<int>(cellSize));
+
+                return cell < count ? cell : count - 1;
+            };
+            ///Visits cells col0..col1 x row0..row1 ( inclusive )
+            template <typename F>
+            inline size_t
+                visit_cells(const size_t col0,
+                            const size_t row0,
+                            const size_t col1,
+                            const size_t row1,
+                            F&& func)
+            {
+                size_t visited = 0;
+                for ( size_t row = row0; row <= row1; row++ )
+                {
+                    //Cells of one row are neighbouring stripes, so a row span is a single run of slots once shrunk
+                    for ( size_t col = col0; col <= col1; col++ )
+                    {
+                        implem::stripe& cell = _sgrid_stripes[row * _sgrid_cols + col];
+                        for ( size_t i = cell.get_start(); i < cell.get_position(); i++ )
+                            func(_sgrid_items[i]);
+
+                        visited += cell.used();
+                    }
+                }
+
+                return visited;
+            };
+            ///Validates layout and builds initial cells
+            inline void
+                init(const size_t gridWidth,
+                     const size_t gridHeight,
+                     const size_t gridCols,
+                     const size_t gridRows,
+                     const size_t cellWdth)
+            {
+                _sgrid_width  = std::max<size_t>(1, gridWidth);
+                _sgrid_height = std::max<size_t>(1, gridHeight);
+                _sgrid_cols   = std::max<size_t>(1, std::min(gridCols, _sgrid_width));
+                _sgrid_rows   = std::max<size_t>(1, std::min(gridRows, _sgrid_height));
+                _sgrid_cell_width  = std::max<size_t>(1, _sgrid_width / _sgrid_cols);
+                _sgrid_cell_height = std::max<size_t>(1, _sgrid_height / _sgrid_rows);
+                _sgrid_init_width  = std::max<size_t>(1, cellWdth);
+
+                make_cells();
+            };
+            ///Creates cell stripes and slot array at initial widths
+            inline void
+                make_cells()
+            {   using namespace implem;
+
+                const size_t cellcount = _sgrid_cols * _sgrid_rows;
+
+                _sgrid_slots_count = cellcount * _sgrid_init_width;
+                _sgrid_items_count = 0;
+                _sgrid_is_shrunk   = false;
+
+                _sgrid_items.make(_sgrid_slots_count);
+                //Stripe depth of each cell is its row-major index
+                _sgrid_stripes = make_init_stripes(cellcount,
+                                                   _sgrid_init_width,
+                                                   1);
+            };
+            ///Widens full cells and moves items into the new layout
+            ///--- ( Returns false and leaves stripe_grid untouched if slot indices would overflow stripe_index_t )
+            inline bool
+                restripe()
+            {   using namespace implem;
+
+                const size_t cellcount    = _sgrid_cols * _sgrid_rows;
+                const size_t oldslotcount = _sgrid_slots_count;
+
+                auto newstripes = setup_new_stripes<growth_double>(_sgrid_stripes,
+                                                                   cellcount,
+                                                                   _sgrid_slots_count);
+
+                if ( _sgrid_slots_count > STRIPE_INDEX_MAX )
+                {
+                    delete[] newstripes;
+                    _sgrid_slots_count = oldslotcount;
+
+                    return false;
+                }
+                auto newitems   = setup_new_items(_sgrid_items,
+                                                  newstripes,
+                                                  _sgrid_stripes,
+                                                  _sgrid_slots_count);
+
+                delete_both();
+                _sgrid_stripes = newstripes;
+                _sgrid_items   = newitems;
+
+                return true;
+            };
+            ///Delete both item and cell arrays
+            inline void
+                delete_both()
+            {
+                _sgrid_items.release();
+                delete[] _sgrid_stripes;
+
+                _sgrid_stripes = nullptr;
+            };
+
+            ///-------------------------------------------------------------------------------------------------------
+            ///INTERNAL STRIPE_GRID VARIABLES
+            implem::items_aos<V> _sgrid_items;                  ///< items ( key is row-major cell index )
+            implem::stripe* _sgrid_stripes      = nullptr;     ///< one stripe per cell
+
+            size_t _sgrid_items_count  = 0;                     ///< total items currently held
+            size_t _sgrid_slots_count  = 0;                     ///< total slots including empty
+
+            size_t _sgrid_width        = 0;                     ///< world width covered by grid
+            size_t _sgrid_height       = 0;                     ///< world height covered by grid
+            size_t _sgrid_cols         = 0;                     ///< cell columns
+            size_t _sgrid_rows         = 0;                     ///< cell rows
+            size_t _sgrid_cell_width   = 0;                     ///< world width of one cell
+            size_t _sgrid_cell_height  = 0;                     ///< world height of one cell
+            size_t _sgrid_init_width   = 0;                     ///< slots per cell on init
+
+            bool _sgrid_is_shrunk      = false;                 ///< determines if stripe_grid currently shrunk
+    };
+
+};  //end of qmap namespace
+
+#endif // STRIPE_GRID_HPP
@@ -1,7 +1,27 @@
 #ifndef STRIPE_MAP_HPP
 #define STRIPE_MAP_HPP
 
+#include <algorithm>
 #include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <stdint.h>
+#include <type_traits>
+#include <utility>
+
+//Snapshots load through mmap on POSIX - elsewhere open_mapped() is unavailable and save() still writes files
+#if defined(__unix__) || defined(__APPLE__)
+    #define SMAP_HAS_MMAP 1
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#else
+    #define SMAP_HAS_MMAP 0
+#endif
 
 #include <uti_FindGridLocation.hpp>
 #include <str_PairedValues.hpp>
@@ -17,8 +37,49 @@ namespace qmap
         static constexpr size_t SMAP_INIT_MAX_DEPTH     = UINT32_MAX;
         static constexpr float STRIPE_EXTEND_AMOUNT     = 2.0f;
 
+        ///Empty secondary-axis bounds ( any expand overwrites both )
+        static constexpr int64_t STRIPE_BOUNDS_EMPTY_MIN = INT64_MAX;
+        static constexpr int64_t STRIPE_BOUNDS_EMPTY_MAX = INT64_MIN;
+
+        ///-------------------------------------------------------------------------------------------------------
+        ///STRIPE INDEX TYPE
+        ///--- ( 32 bit slot indices and depths unless SMAP_WIDE_STRIPES is defined - maps must then stay under 4G slots and depth )
+        #if defined(SMAP_WIDE_STRIPES)
+            typedef size_t stripe_index_t;
+        #else
+            typedef uint32_t stripe_index_t;
+        #endif
+        static constexpr size_t STRIPE_INDEX_MAX = static_cast<stripe_index_t>(~stripe_index_t(0));
+
+        ///-------------------------------------------------------------------------------------------------------
+        ///PREFETCH
+        ///--- ( Slots this far ahead of a scan are prefetched, pointees of pointer values half as far - 0 disables )
+        ///--- ( Off by default : maps that fit in cache only pay for the hints - 32 to 64 suits large pointer payloads )
+        static constexpr size_t SMAP_INIT_PREFETCH_DISTANCE = 0;
+
+        ///Read prefetch hint for addr ( no-op on compilers without __builtin_prefetch - never faults )
+        static inline void
+            prefetch_read(const void* addr)
+        {
+            #if defined(__GNUC__) || defined(__clang__)
+                __builtin_prefetch(addr, 0, 3);
+            #else
+                (void)addr;
+            #endif
+        };
+        ///Prefetches what value points at if V is a pointer ( no-op otherwise )
+        template <typename V>
+        static inline void
+            prefetch_pointee(const V& value)
+        {
+            if constexpr ( std::is_pointer<V>::value )
+                prefetch_read(value);
+        };
+
         ///-------------------------------------------------------------------------------------------------------
         ///BEGIN OF STRIPE STRUCTURE
+        ///--- ( Stripes always live in one contiguous array so neighbours are linked by flag, not pointer )
+        ///--- ( Add touches position/end first, lookups start/depth - 20 bytes per stripe unless SMAP_WIDE_STRIPES )
         struct stripe
         {
             ///-------------------------------------------------------------------------------------------------------
@@ -65,14 +126,14 @@ namespace qmap
                 return Prs::tpsPr<bool, size_t>(true, clearamount);
             };
             ///Assigns critical values during stripe rebuild
+            ///--- ( Neighbour links are not copied - they belong to the position within the array )
             inline stripe&
                 operator=(const stripe& ostripe)
             {
-                _stripe_depth      = ostripe._stripe_depth;
-                _stripe_count      = ostripe._stripe_count;
-                _stripe_start      = ostripe._stripe_start;
                 _stripe_position   = ostripe._stripe_position;
                 _stripe_end        = ostripe._stripe_end;
+                _stripe_start      = ostripe._stripe_start;
+                _stripe_depth      = ostripe._stripe_depth;
 
                 return *this;
             };
@@ -80,8 +141,8 @@ namespace qmap
             inline size_t
                 operator[](size_t stripeIndex)
             {
-                if ( stripeIndex > _stripe_count )
-                    stripeIndex = _stripe_count;
+                if ( stripeIndex > used() )
+                    stripeIndex = used();
 
                 return _stripe_start + stripeIndex;
             };
@@ -134,25 +195,30 @@ namespace qmap
                 get_depth(){
                 return _stripe_depth;
             };
+            ///Returns the depth at which the next stripe starts ( SIZE_MAX if this is the last stripe )
+            inline size_t
+                get_depth_end(){
+                return avail_stripe_next() ? this[1]._stripe_depth : SIZE_MAX;
+            };
             ///Returns true if there exists a stripe previous to this one
             inline bool
                 avail_stripe_prev(){
-                return _stripe_previous != nullptr;
+                return _stripe_links & STRIPE_LINK_PREV;
             };
             ///Returns true if there exists a stripe after this one
             inline bool
                 avail_stripe_next(){
-                return _stripe_next != nullptr;
+                return _stripe_links & STRIPE_LINK_NEXT;
             };
             ///Returns pointer to the previous stripe ( nullptr if this is the first stripe )
-            inline auto
+            inline stripe*
                 get_prev(){
-                return _stripe_previous;
+                return avail_stripe_prev() ? this - 1 : nullptr;
             };
             ///Returns pointer to the next stripe ( nullptr if this is the last stripe )
-            inline auto
+            inline stripe*
                 get_next(){
-                return _stripe_next;
+                return avail_stripe_next() ? this + 1 : nullptr;
             };
 
             ///-------------------------------------------------------------------------------------------------------
@@ -165,7 +231,16 @@ namespace qmap
                 if ( !avail_stripe_next() )
                     return true;
 
-                return depth >= _stripe_depth && depth < get_next()->_stripe_depth;
+                return depth >= _stripe_depth && depth < this[1]._stripe_depth;
+            };
+            ///Returns true if this stripe ends at or before the given depth
+            inline bool
+                depth_before(const size_t depth)
+            {
+                if ( !avail_stripe_next() )
+                    return false;
+
+                return depth >= this[1]._stripe_depth;
             };
             ///Returns true if the given index is between this stripe's start and current position
             inline bool
@@ -177,37 +252,37 @@ namespace qmap
             ///-------------------------------------------------------------------------------------------------------
             ///INIT FUNCTIONS
 
-            ///Sets pointer to previous stripe ( or nullptr if this is the first stripe )
+            ///Marks whether a previous stripe exists ( expects stripePrev to be this - 1 or nullptr )
             inline void
                 set_stripe_prev(stripe* stripePrev)
             {
-                _stripe_previous = stripePrev;
+                set_link(STRIPE_LINK_PREV, stripePrev != nullptr);
             };
-            ///Sets pointer to next stripe ( or nullptr if this is the last stripe )
+            ///Marks whether a next stripe exists ( expects stripeNext to be this + 1 or nullptr )
             inline void
                 set_stripe_next(stripe* stripeNext)
             {
-                _stripe_next = stripeNext;
+                set_link(STRIPE_LINK_NEXT, stripeNext != nullptr);
             };
             ///Sets the stripe depth information
             inline void
                 set_stripe_depth(const size_t depth)
             {
-                _stripe_depth = depth;
+                _stripe_depth = static_cast<stripe_index_t>(depth);
             };
             ///Sets the start index of this stripe
             inline void
                 set_stripe_start(const size_t sStart,
                                  const size_t sPos = 0)
             {
-                _stripe_start    = sStart;
-                _stripe_position = sStart + sPos;
+                _stripe_start    = static_cast<stripe_index_t>(sStart);
+                _stripe_position = static_cast<stripe_index_t>(sStart + sPos);
             };
             ///Sets the end index of this stripe
             inline void
                 set_stripe_end(const size_t sEnd)
             {
-                _stripe_end = sEnd;
+                _stripe_end = static_cast<stripe_index_t>(sEnd);
             };
             ///Trims the stripe's end position to the current insert position
             inline size_t
@@ -215,299 +290,1782 @@ namespace qmap
             {
                 const size_t trimamount = _stripe_end - _stripe_position;
 
-                _stripe_start    -= trimoffset;
-                _stripe_position -= trimoffset;
+                _stripe_start    -= static_cast<stripe_index_t>(trimoffset);
+                _stripe_position -= static_cast<stripe_index_t>(trimoffset);
                 _stripe_end       = _stripe_position;
 
                 return trimamount;
             };
 
             private:
+                static constexpr uint8_t STRIPE_LINK_PREV = 1;
+                static constexpr uint8_t STRIPE_LINK_NEXT = 2;
+
                 ///Adjusts this stripe info to accommodate add
                 inline bool
                     add_slot_now()
                 {
                     _stripe_position++;
-                    _stripe_count++;
 
                     return true;
                 };
+                ///Sets or clears neighbour link flag
+                inline void
+                    set_link(const uint8_t link,
+                             const bool exists)
+                {
+                    if ( exists )
+                        _stripe_links |= link;
+                    else
+                        _stripe_links &= ~link;
+                };
 
-            ///Internal stripe variables
-            stripe* _stripe_previous = nullptr;  ///< previous stripe if there is one
-            stripe* _stripe_next     = nullptr;  ///< next stripe if there is one
+            ///Internal stripe variables ( hot on add first )
+            stripe_index_t _stripe_position = 0;  ///< current location of entry
+            stripe_index_t _stripe_end      = 0;  ///< width of stripe ( end of stripe slots index )
 
-            size_t _stripe_start    = 0;         ///< start of stripe item pointers
-            size_t _stripe_position = 0;         ///< current location of entry
-            size_t _stripe_end      = 0;         ///< width of stripe ( end of stripe slots index )
+            stripe_index_t _stripe_start    = 0;  ///< start of stripe item pointers
+            stripe_index_t _stripe_depth    = 0;  ///< total depth into stripe_map
 
-            size_t _stripe_depth = 0;            ///< total depth into stripe_map
-            size_t _stripe_count = 0;            ///< slots filled within stripe
+            uint8_t _stripe_links           = 0;  ///< STRIPE_LINK_PREV | STRIPE_LINK_NEXT
         };
 
         ///-------------------------------------------------------------------------------------------------------
-        ///HELPER FUNCTIONS
-
-        ///FINDER FUNCTIONS
-        namespace
+        ///BEGIN OF STRIPE BOUNDS STRUCTURE
+        ///--- ( Cold per-stripe secondary-axis bounds, kept in a parallel array only while bounds are tracked )
+        struct stripe_bounds
         {
-            ///Returns stripe corresponding to given depth ( SCANS )
-            static inline stripe*
-                find_stripe_match_depth(stripe* stripePtr,
-                                        const size_t depthKey)
+            ///Returns true if any item of the stripe may reach into secondary range [secMin, secMax]
+            ///--- ( Items reach half their extent past their secondary key - bounds are never tightened by erase )
+            inline bool
+                overlap(const int64_t secMin,
+                        const int64_t secMax) const
             {
-                while ( stripePtr != nullptr )
-                {
-                    if ( stripePtr->depth_match(depthKey) )
-                        return stripePtr;
+                if ( _bounds_sec_min > _bounds_sec_max )
+                    return false;
 
-                    stripePtr = stripePtr->get_next();
-                }
+                const int64_t halfext = ( _bounds_ext_max + 1 ) >> 1;
 
-                return nullptr;
+                return _bounds_sec_min - halfext <= secMax && _bounds_sec_max + halfext >= secMin;
             };
-            ///Returns pointer to stripe given depthKey and current depthMax of stripe_map
-            ///--- ( EXPECTS POINTER TO FIRST STRIPE - BOUND CHECKING FOR DEPTHKEY TO MAX IS NOT PERFORMED )
-            static inline auto
-                find_stripe_jump_depth(stripe* stripePtr,
-                                       size_t depthKey,
-                                       size_t depthMax)
+            ///Grows bounds to include an item at secKey with given extent
+            inline void
+                expand(const int64_t secKey,
+                       const int64_t extent)
             {
-                const size_t stripeDepth = stripePtr->get_next()->get_depth();
-                const size_t stripeindex = trunc(( depthMax - ( depthMax - depthKey ) ) / stripeDepth );
-
-                return &stripePtr[stripeindex];
+                if ( secKey < _bounds_sec_min )
+                    _bounds_sec_min = secKey;
+                if ( secKey > _bounds_sec_max )
+                    _bounds_sec_max = secKey;
+                if ( extent > _bounds_ext_max )
+                    _bounds_ext_max = extent;
             };
-            ///Returns first stripe that aligns with given slotIndex ( SCANS )
-            ///--- ( EXPECTS POINTER TO FIRST STRIPE OR INDEX ALIGNED WITH SUPPLIED POINTER )
-            static inline const auto
-                find_stripe_from_adjd_index(stripe* stripePtr,
-                                       const size_t slotIndex)
+            ///Empties bounds
+            inline void
+                reset()
             {
-                size_t currindex = slotIndex;
-                while ( stripePtr != nullptr )
-                {
-                    if ( stripePtr->is_empty() )
-                        goto next;
-                {
-                    //Width (total capac) of current stripe
-                    const auto stripeused = stripePtr->used();
-
-                    //Return curr stripe and item index in stripe_map array if currindex aligns with stripe
-                    if ( stripeused > currindex )
-                        return Prs::tpsPr<stripe*, size_t>(stripePtr,
-                                                              stripePtr->get_start() + currindex);
+                _bounds_sec_min = STRIPE_BOUNDS_EMPTY_MIN;
+                _bounds_sec_max = STRIPE_BOUNDS_EMPTY_MAX;
+                _bounds_ext_max = 0;
+            };
+            ///Returns smallest secondary key ( STRIPE_BOUNDS_EMPTY_MIN if empty )
+            inline int64_t
+                get_sec_min() const {
+                return _bounds_sec_min;
+            };
+            ///Returns largest secondary key ( STRIPE_BOUNDS_EMPTY_MAX if empty )
+            inline int64_t
+                get_sec_max() const {
+                return _bounds_sec_max;
+            };
+            ///Returns largest extent
+            inline int64_t
+                get_ext_max() const {
+                return _bounds_ext_max;
+            };
 
-                    //Reduce currindex by stripeused per pass to check alignment
-                    currindex -= stripeused;
-                }   //start of next
-                next:
+            private:
+                int64_t _bounds_sec_min = STRIPE_BOUNDS_EMPTY_MIN;  ///< smallest tracked secondary key
+                int64_t _bounds_sec_max = STRIPE_BOUNDS_EMPTY_MAX;  ///< largest tracked secondary key
+                int64_t _bounds_ext_max = 0;                        ///< largest tracked extent
+        };
 
-                    stripePtr = stripePtr->get_next();
-                };
+        ///-------------------------------------------------------------------------------------------------------
+        ///BEGIN OF STRIPE OCCUPANCY STRUCTURE
+        ///--- ( One bit per non-empty stripe plus one summary bit per non-zero word - traversal jumps with ctz/clz )
+        struct stripe_occupancy
+        {
+            static constexpr size_t npos = SIZE_MAX;
 
-                return Prs::tpsPr<stripe*, size_t>(nullptr, 0);
-            };
-            ///
-            static inline const auto
-                find_stripe_start_index_adj(stripe* stripePtr,
-                                            const size_t slotIndex)
+            stripe_occupancy() = default;
+            stripe_occupancy(const stripe_occupancy&) = delete;
+            stripe_occupancy& operator=(const stripe_occupancy&) = delete;
+            ~stripe_occupancy()
             {
-                size_t adjindex = 0;
-                while ( stripePtr != nullptr )
-                {
-                    if ( stripePtr->is_empty() )
-                        goto next;
-                {
-                    if ( stripePtr->index_match(slotIndex) )
-                        return Prs::tpsPr<stripe*, size_t>(stripePtr,
-                                                           adjindex);
+                release();
+            };
 
-                    adjindex += stripePtr->used();
-                } //start of next
-                next:
+            ///-------------------------------------------------------------------------------------------------------
+            ///OPERATIONAL FUNCTIONS
 
-                    stripePtr = stripePtr->get_next();
-                };
+            ///Allocates empty bitmap for stripeAmnt stripes
+            inline void
+                make(const size_t stripeAmnt)
+            {
+                release();
 
-                return Prs::tpsPr<stripe*, size_t>(nullptr, 0);
+                _occ_count         = stripeAmnt;
+                _occ_word_count    = ( stripeAmnt + 63 ) >> 6;
+                _occ_summary_count = ( _occ_word_count + 63 ) >> 6;
+
+                _occ_words   = new uint64_t[_occ_word_count]();
+                _occ_summary = new uint64_t[_occ_summary_count]();
             };
-            ///
-            static inline size_t
-                find_start_index_adj(stripe* stripePtr,
-                                     const size_t slotIndex)
+            ///Frees bitmap
+            inline void
+                release()
             {
-                size_t adjindex = 0;
-                while ( stripePtr != nullptr )
-                {
-                    if ( stripePtr->is_empty() )
-                        goto next;
-                {
-                    if ( stripePtr->index_match(slotIndex) )
-                        return adjindex;
+                delete[] _occ_words;
+                delete[] _occ_summary;
 
-                    adjindex += stripePtr->used();
-                }
-                next:
+                _occ_words   = nullptr;
+                _occ_summary = nullptr;
+                _occ_count   = 0;
+            };
+            ///Marks stripe as occupied
+            inline void
+                set(const size_t stripeIndex)
+            {
+                const size_t word = stripeIndex >> 6;
 
-                    stripePtr = stripePtr->get_next();
-                }
+                _occ_words[word]        |= uint64_t(1) << ( stripeIndex & 63 );
+                _occ_summary[word >> 6] |= uint64_t(1) << ( word & 63 );
+            };
+            ///Marks stripe as empty
+            inline void
+                unset(const size_t stripeIndex)
+            {
+                const size_t word = stripeIndex >> 6;
 
-                return 0;
+                _occ_words[word] &= ~( uint64_t(1) << ( stripeIndex & 63 ) );
+                if ( _occ_words[word] == 0 )
+                    _occ_summary[word >> 6] &= ~( uint64_t(1) << ( word & 63 ) );
             };
-            ///
-            static inline size_t
-                find_start_index_adj_match_depth(stripe* stripePtr,
-                                                 const size_t depthKey)
+            ///Marks every stripe as empty ( only touches non-zero words )
+            inline void
+                clear_all()
             {
-                size_t adjindex = 0;
-                while ( stripePtr != nullptr )
-                {
-                    if ( stripePtr->is_empty() )
-                        goto next;
+                for ( size_t s = 0; s < _occ_summary_count; s++ )
                 {
-                    if ( stripePtr->depth_match(depthKey) )
-                        return adjindex;
-
-                    adjindex += stripePtr->used();
+                    uint64_t summary = _occ_summary[s];
+                    while ( summary != 0 )
+                    {
+                        _occ_words[( s << 6 ) + __builtin_ctzll(summary)] = 0;
+                        summary &= summary - 1;
+                    }
+                    _occ_summary[s] = 0;
                 }
-                next:
+            };
 
-                    stripePtr = stripePtr->get_next();
-                }
+            ///-------------------------------------------------------------------------------------------------------
+            ///INFO FUNCTIONS
 
-                return 0;
+            ///Returns true if stripe is marked occupied
+            inline bool
+                test(const size_t stripeIndex) const {
+                return ( _occ_words[stripeIndex >> 6] >> ( stripeIndex & 63 ) ) & 1;
             };
-            ///
-            static inline size_t
-                find_end_index_adj_match_depth(stripe* stripePtr,
-                                               const size_t depthKey)
+            ///Returns true if bitmap has been made
+            inline bool
+                is_made() const {
+                return _occ_words != nullptr;
+            };
+            ///Returns amount of stripes covered
+            inline size_t
+                size() const {
+                return _occ_count;
+            };
+            ///Returns first occupied stripe index at or after fromIndex ( npos if none )
+            inline size_t
+                next(const size_t fromIndex) const
             {
-                size_t adjindx = 0;
-                while ( stripePtr != nullptr )
-                {
-                    if ( stripePtr->is_empty() )
-                        goto next;
+                if ( fromIndex >= _occ_count )
+                    return npos;
+
+                size_t word = fromIndex >> 6;
+                const uint64_t bits = _occ_words[word] & ( ~uint64_t(0) << ( fromIndex & 63 ) );
+                if ( bits != 0 )
+                    return ( word << 6 ) + __builtin_ctzll(bits);
+
+                //Jump to next non-zero word through summary level
+                word++;
+                if ( word >= _occ_word_count )
+                    return npos;
+
+                size_t s = word >> 6;
+                uint64_t summary = _occ_summary[s] & ( ~uint64_t(0) << ( word & 63 ) );
+                while ( summary == 0 )
                 {
-                    adjindx += stripePtr->used();
+                    if ( ++s >= _occ_summary_count )
+                        return npos;
 
-                    if ( stripePtr->depth_match(depthKey) )
-                        return adjindx;
+                    summary = _occ_summary[s];
                 }
-                next:
 
-                    stripePtr = stripePtr->get_next();
-                }
+                word = ( s << 6 ) + __builtin_ctzll(summary);
 
-                return 0;
+                return ( word << 6 ) + __builtin_ctzll(_occ_words[word]);
             };
-            ///Returns index number back while ignoring stripes entirely
-            ///--- ( THIS IS TO BE USED WHEN STRIPES HAVE NO GAPS & PERF NEEDED )
-            static inline const auto
-                find_stripe_nogap_index(stripe* stripePtr,
-                                        const size_t slotIndex)
+            ///Returns last occupied stripe index at or before fromIndex ( npos if none )
+            inline size_t
+                prev(size_t fromIndex) const
             {
-                while ( stripePtr != nullptr )
-                {
-                    if ( stripePtr->is_empty() )
-                        goto next;
+                if ( _occ_count == 0 )
+                    return npos;
+                if ( fromIndex >= _occ_count )
+                    fromIndex = _occ_count - 1;
+
+                size_t word = fromIndex >> 6;
+                const uint64_t bits = _occ_words[word] & ( ~uint64_t(0) >> ( 63 - ( fromIndex & 63 ) ) );
+                if ( bits != 0 )
+                    return ( word << 6 ) + 63 - __builtin_clzll(bits);
+
+                //Jump to previous non-zero word through summary level
+                if ( word == 0 )
+                    return npos;
+                word--;
+
+                size_t s = word >> 6;
+                uint64_t summary = _occ_summary[s] & ( ~uint64_t(0) >> ( 63 - ( word & 63 ) ) );
+                while ( summary == 0 )
                 {
-                    if ( slotIndex >= stripePtr->get_start() )
-                        return Prs::tpsPr<stripe*, size_t>(stripePtr, slotIndex);
-                }   //start of next
-                next:
+                    if ( s-- == 0 )
+                        return npos;
 
-                    stripePtr = stripePtr->get_next();
+                    summary = _occ_summary[s];
                 }
 
-                return Prs::tpsPr<stripe*, size_t>(nullptr, 0);
-            };
-            ///Returns first stripe that aligns with given slotIndex ( SCANS )
-            ///--- ( EXPECTS POINTER TO FIRST STRIPE OR INDEX ALIGNED WITH SUPPLIED POINTER )
-            static inline const size_t
-                find_adjd_index(stripe* stripePtr,
-                                const size_t slotIndex)
-            {
-                size_t currindex = slotIndex;
-                while ( stripePtr != nullptr )
-                {
-                    if ( stripePtr->is_empty() )
-                        goto next;
-                {
-                    //Width (total capac) of current stripe
-                    const auto stripeused = stripePtr->used();
+                word = ( s << 6 ) + 63 - __builtin_clzll(summary);
 
-                    //Return curr stripe and item index in stripe_map array if currindex aligns with stripe
-                    if ( stripeused > currindex )
-                        return stripePtr->get_start() + currindex;
+                return ( word << 6 ) + 63 - __builtin_clzll(_occ_words[word]);
+            };
+            ///Returns first occupied stripe index ( npos if none )
+            inline size_t
+                first() const {
+                return next(0);
+            };
+            ///Returns last occupied stripe index ( npos if none )
+            inline size_t
+                last() const {
+                return prev(npos);
+            };
 
-                    //Reduce currindex by stripeused per pass to check alignment
-                    currindex -= stripeused;
-                }   //start of next
-                next:
+            private:
+                uint64_t* _occ_words     = nullptr;  ///< one bit per stripe
+                uint64_t* _occ_summary   = nullptr;  ///< one bit per non-zero word
 
-                    stripePtr = stripePtr->get_next();
-                };
+                size_t _occ_count         = 0;       ///< stripes covered
+                size_t _occ_word_count    = 0;       ///< words in _occ_words
+                size_t _occ_summary_count = 0;       ///< words in _occ_summary
+        };
 
-                return 0;
-            };
+        ///-------------------------------------------------------------------------------------------------------
+        ///SLOT ARRAYS
+        ///--- ( Heap item stores allocate through these - bitwise relocatable slots live in SMAP_SLOT_REALLOC memory so )
+        ///--- ( resize_slots() can grow or cut them in place, any other slot type stays a new[] array moved slot by slot )
+        #if !defined(SMAP_SLOT_REALLOC)
+            #define SMAP_SLOT_REALLOC(ptr, bytes) std::realloc(ptr, bytes)
+        #endif
+        #if !defined(SMAP_SLOT_FREE)
+            #define SMAP_SLOT_FREE(ptr) std::free(ptr)
+        #endif
+
+        ///True if T survives being copied bytewise to a new address ( pairs and hot slots ask their members )
+        template <typename T>
+        struct slot_relocatable : std::is_trivially_copyable<T> {};
+        template <typename T, typename U>
+        struct slot_relocatable<Prs::tpsPr<T, U>>
+            : std::integral_constant<bool, slot_relocatable<T>::value && slot_relocatable<U>::value> {};
+
+        ///True if arrays of T are realloc()ed rather than new[]ed
+        template <typename T>
+        static constexpr bool SLOT_REALLOC = slot_relocatable<T>::value && alignof(T) <= alignof(std::max_align_t);
+
+        ///Allocates slotCount default constructed slots ( throws std::bad_alloc on failure, as new[] would )
+        template <typename T>
+        static inline T*
+            make_slots(const size_t slotCount)
+        {
+            if constexpr ( SLOT_REALLOC<T> )
+            {
+                T* slots = static_cast<T*>(SMAP_SLOT_REALLOC(nullptr, std::max<size_t>(1, slotCount) * sizeof(T)));
+                if ( slots == nullptr )
+                    throw std::bad_alloc();
 
-        };  //end of finder functions namespace
+                for ( size_t i = 0; i < slotCount; i++ )
+                    new (&slots[i]) T;
 
-        ///INIT SETUP FUNCTIONS
-        namespace
+                return slots;
+            }
+            else
+                return new T[slotCount];
+        };
+        ///Deletes slots made by make_slots()
+        template <typename T>
+        static inline void
+            release_slots(T* slots)
         {
-            ///Calculates depth of each stripe ( as portion of grid percent )
-            static inline size_t
-                calc_init_depth_increm(const size_t stripeAmnt,
-                                       const size_t depthMax)
+            if constexpr ( SLOT_REALLOC<T> )
+                SMAP_SLOT_FREE(static_cast<void*>(slots));
+            else
+                delete[] slots;
+        };
+        ///Resizes slots from oldCount to newCount keeping the slots below both - returns false and leaves slots untouched on failure
+        ///--- ( Relocatable slots are realloc()ed, which mostly stays in place - others are moved into a new array )
+        template <typename T>
+        static inline bool
+            resize_slots(T*& slots,
+                         const size_t oldCount,
+                         const size_t newCount)
+        {
+            if constexpr ( SLOT_REALLOC<T> )
             {
-                return depthMax / stripeAmnt;
-            };
+                T* resized = static_cast<T*>(SMAP_SLOT_REALLOC(static_cast<void*>(slots), std::max<size_t>(1, newCount) * sizeof(T)));
+                if ( resized == nullptr )
+                    return false;
 
-        };  //end of init setup functions namespace
+                for ( size_t i = oldCount; i < newCount; i++ )
+                    new (&resized[i]) T;
 
-        ///STRIPE SETUP FUNCTIONS
-        namespace
+                slots = resized;
+            }
+            else
+            {
+                T* resized = new (std::nothrow) T[newCount];
+                if ( resized == nullptr )
+                    return false;
+
+                for ( size_t i = 0; i < std::min(oldCount, newCount); i++ )
+                    resized[i] = std::move(slots[i]);
+
+                delete[] slots;
+                slots = resized;
+            }
+
+            return true;
+        };
+
+        ///-------------------------------------------------------------------------------------------------------
+        ///BEGIN OF ITEM STORE STRUCTURES
+        ///--- ( Non-owning handles over slot arrays - owner calls make()/release(), restripe and shrink swap handles )
+        ///--- ( Key is the stored key type - any unsigned integer, depth is clamped to its range )
+        ///--- ( GROWS_IN_PLACE stores resize() without building a second array - see SLOT ARRAYS )
+
+        ///Builds V from args in slotValue ( emplace )
+        ///--- ( Slots are constructed arrays : nothrow constructible values are rebuilt in place, others are built once and moved )
+        ///--- ( in, so the slot never holds a destroyed value if the constructor throws )
+        template <typename V, typename... Args>
+        static inline void
+            emplace_value(V& slotValue,
+                          Args&&... args)
         {
-            ///Creates initialization stripe info structures and performs setup
-            static inline stripe*
-                make_init_stripes(const size_t stripeAmnt,
-                                  const size_t stripeWidth,
-                                  const size_t stripeDepth)
+            if constexpr ( std::is_nothrow_constructible<V, Args&&...>::value )
             {
-                auto newstripes = new stripe[stripeAmnt];
+                slotValue.~V();
+                new (&slotValue) V(std::forward<Args>(args)...);
+            }
+            else
+                slotValue = V(std::forward<Args>(args)...);
+        };
 
-                for ( size_t i = 0; i < stripeAmnt; i++ )
-                {
-                    auto & currstripe = newstripes[i];
+        ///Array of structures - key and value side by side in one Prs::tpsPr<Key, V> array
+        template <typename V, typename Key = size_t>
+        struct items_aos
+        {
+            static_assert(std::is_unsigned<Key>::value, "stripe_map key type must be an unsigned integer");
 
-                    //Set stripe neighbor pointers where applicable
-                    if ( i != 0 )
-                        currstripe.set_stripe_prev(&newstripes[i-1]);
-                    if ( i != stripeAmnt - 1 )
-                        currstripe.set_stripe_next(&newstripes[i+1]);
+            static constexpr bool PROJECTED = false;
+            static constexpr bool HOT       = false;
+            static constexpr bool FILE_BACKED = false;
+            static constexpr bool HANDLED     = false;
+            static constexpr bool GROWS_IN_PLACE = SLOT_REALLOC<Prs::tpsPr<Key, V>>;
+            static constexpr size_t ARRAY_COUNT = 1;
 
-                    //Set start and end index positions of current stripe
-                    currstripe.set_stripe_start(stripeWidth * i);
-                    currstripe.set_stripe_end(stripeWidth * (i + 1));
-                    //Set the starting depth of the current stripe
-                    currstripe.set_stripe_depth(stripeDepth * i);
-                };
+            typedef Key key_type;
+            typedef Prs::tpsPr<Key, V> item_type;
+            typedef Prs::tpsPr<Key, V>& reference;
+            typedef Prs::tpsPr<Key, V>* pointer;
 
-                return newstripes;
+            ///Allocates slotCount default constructed slots
+            inline void
+                make(const size_t slotCount)
+            {
+                _items = make_slots<Prs::tpsPr<Key, V>>(slotCount);
             };
-            ///Copies relevant information to new stripes and adjusts start+end indices
-            ///--- ( Returns new required item slot # )
-            static inline size_t
-                fix_new_stripes(stripe* newStripes,
-                                stripe* oldStripes,
-                                const size_t stripeAmnt)
+            ///Deletes slot array
+            inline void
+                release()
             {
-                size_t currslotindex = 0;
-                for ( size_t i = 0; i < stripeAmnt; i++ )
-                {
-                    //Assign relevant info from old stripe to new stripe
+                release_slots(_items);
+                _items = nullptr;
+            };
+            ///Resizes slot array from oldSlotCount to slotCount keeping held slots - returns false and leaves store untouched on failure
+            inline bool
+                resize(const size_t slotCount,
+                       const size_t oldSlotCount){
+                return resize_slots(_items, oldSlotCount, slotCount);
+            };
+            ///Returns item in slot
+            inline reference
+                operator[](const size_t slotIndex){
+                return _items[slotIndex];
+            };
+            ///Returns pointer to item in slot
+            inline pointer
+                ptr(const size_t slotIndex){
+                return &_items[slotIndex];
+            };
+            ///Returns key held in slot
+            inline size_t
+                key(const size_t slotIndex){
+                return _items[slotIndex]._1;
+            };
+            ///Rewrites key held in slot
+            inline void
+                set_key(const size_t slotIndex,
+                        const Key key){
+                _items[slotIndex]._1 = key;
+            };
+            ///Returns value held in slot
+            inline V&
+                value(const size_t slotIndex){
+                return _items[slotIndex]._2;
+            };
+            ///Prefetches slot
+            inline void
+                prefetch(const size_t slotIndex){
+                prefetch_read(&_items[slotIndex]);
+            };
+            ///Copies item into slot
+            inline void
+                put(const size_t slotIndex,
+                    const item_type& item){
+                _items[slotIndex] = item;
+            };
+            ///Moves item into slot
+            inline void
+                put(const size_t slotIndex,
+                    item_type&& item){
+                _items[slotIndex] = std::move(item);
+            };
+            ///Constructs value in slot from args
+            template <typename... Args>
+            inline void
+                emplace(const size_t slotIndex,
+                        const Key key,
+                        Args&&... args)
+            {
+                _items[slotIndex]._1 = key;
+                emplace_value(_items[slotIndex]._2, std::forward<Args>(args)...);
+            };
+            ///Moves item from slot srcIndex of srcItems into slot dstIndex
+            inline void
+                move_from(const size_t dstIndex,
+                          items_aos& srcItems,
+                          const size_t srcIndex){
+                _items[dstIndex] = std::move(srcItems._items[srcIndex]);
+            };
+            ///Moves item between two slots of this store
+            inline void
+                move_within(const size_t dstIndex,
+                            const size_t srcIndex){
+                _items[dstIndex] = std::move(_items[srcIndex]);
+            };
+            ///Bytes per slot of array
+            static constexpr size_t
+                array_stride(const size_t){
+                return sizeof(Prs::tpsPr<Key, V>);
+            };
+            ///Start of array
+            inline void*
+                array_data(const size_t){
+                return _items;
+            };
+            ///Points array at data ( not owned - snapshot mappings, never release()d )
+            inline void
+                array_attach(const size_t,
+                             void* data){
+                _items = static_cast<Prs::tpsPr<Key, V>*>(data);
+            };
+
+            Prs::tpsPr<Key, V>* _items = nullptr;       ///< key/value slots
+        };
+
+        ///Reference to one slot of a split or projected store ( reads as Prs::tpsPr<Key, V> through _1 and _2 )
+        template <typename V, typename Key>
+        struct item_ref
+        {
+            const Key _1;       ///< key ( copy - keys are never written through a reference )
+            V& _2;              ///< value
+
+            ///Copies slot out as a pair ( keeps callbacks taking const Prs::tpsPr<Key, V>& working )
+            inline
+                operator Prs::tpsPr<Key, V>() const {
+                return Prs::tpsPr<Key, V>(_1, _2);
+            };
+        };
+        ///Arrow proxy for item_ref ( iterator operator-> )
+        template <typename V, typename Key>
+        struct item_ptr
+        {
+            item_ref<V, Key> _ref;
+
+            inline item_ref<V, Key>*
+                operator->(){
+                return &_ref;
+            };
+        };
+
+        ///Structure of arrays - keys and values in two parallel arrays
+        ///--- ( Key scans in query() only pull keys into cache - values are touched for matches alone )
+        template <typename V, typename Key = size_t>
+        struct items_soa
+        {
+            static_assert(std::is_unsigned<Key>::value, "stripe_map key type must be an unsigned integer");
+
+            static constexpr bool PROJECTED = false;
+            static constexpr bool HOT       = false;
+            static constexpr bool FILE_BACKED = false;
+            static constexpr bool HANDLED     = false;
+            static constexpr bool GROWS_IN_PLACE = SLOT_REALLOC<V>;
+            static constexpr size_t ARRAY_COUNT = 2;
+
+            typedef Key key_type;
+            typedef Prs::tpsPr<Key, V> item_type;
+            typedef item_ref<V, Key> reference;
+            typedef item_ptr<V, Key> pointer;
+
+            ///Allocates slotCount default constructed slots in both arrays ( keys zeroed )
+            inline void
+                make(const size_t slotCount)
+            {
+                _keys   = make_slots<Key>(slotCount);
+                _values = make_slots<V>(slotCount);
+
+                std::fill(_keys, _keys + slotCount, Key());
+            };
+            ///Deletes both arrays
+            inline void
+                release()
+            {
+                release_slots(_keys);
+                release_slots(_values);
+                _keys   = nullptr;
+                _values = nullptr;
+            };
+            ///Resizes both arrays from oldSlotCount to slotCount keeping held slots - returns false if either array failed
+            ///--- ( Both arrays still hold at least the smaller of both counts after a failure )
+            inline bool
+                resize(const size_t slotCount,
+                       const size_t oldSlotCount)
+            {
+                if ( !resize_slots(_values, oldSlotCount, slotCount) || !resize_slots(_keys, oldSlotCount, slotCount) )
+                    return false;
+
+                if ( slotCount > oldSlotCount )
+                    std::fill(_keys + oldSlotCount, _keys + slotCount, Key());
+
+                return true;
+            };
+            ///Returns reference to slot
+            inline reference
+                operator[](const size_t slotIndex){
+                return reference{ _keys[slotIndex], _values[slotIndex] };
+            };
+            ///Returns arrow proxy to slot
+            inline pointer
+                ptr(const size_t slotIndex){
+                return pointer{ (*this)[slotIndex] };
+            };
+            ///Returns key held in slot
+            inline size_t
+                key(const size_t slotIndex){
+                return _keys[slotIndex];
+            };
+            ///Rewrites key held in slot
+            inline void
+                set_key(const size_t slotIndex,
+                        const Key key){
+                _keys[slotIndex] = key;
+            };
+            ///Returns value held in slot
+            inline V&
+                value(const size_t slotIndex){
+                return _values[slotIndex];
+            };
+            ///Prefetches slot key and value
+            inline void
+                prefetch(const size_t slotIndex)
+            {
+                prefetch_read(&_keys[slotIndex]);
+                prefetch_read(&_values[slotIndex]);
+            };
+            ///Copies item into slot
+            inline void
+                put(const size_t slotIndex,
+                    const item_type& item)
+            {
+                _keys[slotIndex]   = item._1;
+                _values[slotIndex] = item._2;
+            };
+            ///Moves item into slot
+            inline void
+                put(const size_t slotIndex,
+                    item_type&& item)
+            {
+                _keys[slotIndex]   = item._1;
+                _values[slotIndex] = std::move(item._2);
+            };
+            ///Constructs value in slot from args
+            template <typename... Args>
+            inline void
+                emplace(const size_t slotIndex,
+                        const Key key,
+                        Args&&... args)
+            {
+                _keys[slotIndex] = key;
+                emplace_value(_values[slotIndex], std::forward<Args>(args)...);
+            };
+            ///Moves item from slot srcIndex of srcItems into slot dstIndex
+            inline void
+                move_from(const size_t dstIndex,
+                          items_soa& srcItems,
+                          const size_t srcIndex)
+            {
+                _keys[dstIndex]   = srcItems._keys[srcIndex];
+                _values[dstIndex] = std::move(srcItems._values[srcIndex]);
+            };
+            ///Moves item between two slots of this store
+            inline void
+                move_within(const size_t dstIndex,
+                            const size_t srcIndex)
+            {
+                _keys[dstIndex]   = _keys[srcIndex];
+                _values[dstIndex] = std::move(_values[srcIndex]);
+            };
+            ///Bytes per slot of array
+            static constexpr size_t
+                array_stride(const size_t array){
+                return array == 0 ? sizeof(Key) : sizeof(V);
+            };
+            ///Start of array
+            inline void*
+                array_data(const size_t array){
+                return array == 0 ? static_cast<void*>(_keys) : static_cast<void*>(_values);
+            };
+            ///Points array at data ( not owned - snapshot mappings, never release()d )
+            inline void
+                array_attach(const size_t array,
+                             void* data)
+            {
+                if ( array == 0 )
+                    _keys = static_cast<Key*>(data);
+                else
+                    _values = static_cast<V*>(data);
+            };
+
+            Key* _keys = nullptr;       ///< slot keys
+            V* _values = nullptr;       ///< slot values
+        };
+
+        ///Values only - keys are recomputed through Proj{}(value) whenever needed
+        ///--- ( Smallest slots - key scans pay one projection per item, so Proj should be a cheap field read )
+        template <typename V, typename Proj, typename Key = size_t>
+        struct items_projected
+        {
+            static_assert(std::is_unsigned<Key>::value, "stripe_map key type must be an unsigned integer");
+
+            static constexpr bool PROJECTED = true;
+            static constexpr bool HOT       = false;
+            static constexpr bool FILE_BACKED = false;
+            static constexpr bool HANDLED     = false;
+            static constexpr bool GROWS_IN_PLACE = SLOT_REALLOC<V>;
+            static constexpr size_t ARRAY_COUNT = 1;
+
+            typedef Key key_type;
+            typedef V item_type;
+            typedef item_ref<V, Key> reference;
+            typedef item_ptr<V, Key> pointer;
+
+            ///Key of value
+            static inline size_t
+                project(const V& value){
+                return static_cast<Key>(Proj{}(value));
+            };
+            ///Allocates slotCount default constructed slots
+            inline void
+                make(const size_t slotCount)
+            {
+                _values = make_slots<V>(slotCount);
+            };
+            ///Deletes slot array
+            inline void
+                release()
+            {
+                release_slots(_values);
+                _values = nullptr;
+            };
+            ///Resizes slot array from oldSlotCount to slotCount keeping held slots - returns false and leaves store untouched on failure
+            inline bool
+                resize(const size_t slotCount,
+                       const size_t oldSlotCount){
+                return resize_slots(_values, oldSlotCount, slotCount);
+            };
+            ///Returns reference to slot
+            inline reference
+                operator[](const size_t slotIndex){
+                return reference{ static_cast<Key>(project(_values[slotIndex])), _values[slotIndex] };
+            };
+            ///Returns arrow proxy to slot
+            inline pointer
+                ptr(const size_t slotIndex){
+                return pointer{ (*this)[slotIndex] };
+            };
+            ///Returns key of value held in slot
+            inline size_t
+                key(const size_t slotIndex){
+                return project(_values[slotIndex]);
+            };
+            ///Returns value held in slot
+            inline V&
+                value(const size_t slotIndex){
+                return _values[slotIndex];
+            };
+            ///Prefetches slot
+            inline void
+                prefetch(const size_t slotIndex){
+                prefetch_read(&_values[slotIndex]);
+            };
+            ///Copies value into slot
+            inline void
+                put(const size_t slotIndex,
+                    const V& value){
+                _values[slotIndex] = value;
+            };
+            ///Moves value into slot
+            inline void
+                put(const size_t slotIndex,
+                    V&& value){
+                _values[slotIndex] = std::move(value);
+            };
+            ///Moves value from slot srcIndex of srcItems into slot dstIndex
+            inline void
+                move_from(const size_t dstIndex,
+                          items_projected& srcItems,
+                          const size_t srcIndex){
+                _values[dstIndex] = std::move(srcItems._values[srcIndex]);
+            };
+            ///Moves value between two slots of this store
+            inline void
+                move_within(const size_t dstIndex,
+                            const size_t srcIndex){
+                _values[dstIndex] = std::move(_values[srcIndex]);
+            };
+            ///Bytes per slot of array
+            static constexpr size_t
+                array_stride(const size_t){
+                return sizeof(V);
+            };
+            ///Start of array
+            inline void*
+                array_data(const size_t){
+                return _values;
+            };
+            ///Points array at data ( not owned - snapshot mappings, never release()d )
+            inline void
+                array_attach(const size_t,
+                             void* data){
+                _values = static_cast<V*>(data);
+            };
+
+            V* _values = nullptr;       ///< slot values
+        };
+
+        ///Slot of items_hot - key, hot projection of value and value side by side
+        template <typename Key, typename H, typename V>
+        struct hot_item
+        {
+            Key _1;             ///< key
+            H _hot;             ///< hot projection of _2 copied on add
+            V _2;               ///< value
+
+            ///Copies slot out as a pair ( keeps callbacks taking const Prs::tpsPr<Key, V>& working )
+            inline
+                operator Prs::tpsPr<Key, V>() const {
+                return Prs::tpsPr<Key, V>(_1, _2);
+            };
+        };
+
+        ///Hot slots relocate if all three members do
+        template <typename Key, typename H, typename V>
+        struct slot_relocatable<hot_item<Key, H, V>>
+            : std::integral_constant<bool, slot_relocatable<Key>::value && slot_relocatable<H>::value && slot_relocatable<V>::value> {};
+
+        ///Array of structures with a small hot projection of each value copied inline next to its key
+        ///--- ( query_hot() tests the copy and only hands values that pass to func - V is not touched for rejects )
+        ///--- ( Copies are taken on add, so projected fields must not change while the value is held )
+        template <typename V, typename HotProj, typename Key = size_t>
+        struct items_hot
+        {
+            static_assert(std::is_unsigned<Key>::value, "stripe_map key type must be an unsigned integer");
+
+            static constexpr bool PROJECTED = false;
+            static constexpr bool HOT       = true;
+            static constexpr bool FILE_BACKED = false;
+            static constexpr bool HANDLED     = false;
+            static constexpr size_t ARRAY_COUNT = 1;
+
+            typedef Key key_type;
+            typedef decltype(HotProj{}(std::declval<const V&>())) hot_type;
+            typedef Prs::tpsPr<Key, V> item_type;
+            typedef hot_item<Key, hot_type, V>& reference;
+            typedef hot_item<Key, hot_type, V>* pointer;
+
+            static constexpr bool GROWS_IN_PLACE = SLOT_REALLOC<hot_item<Key, hot_type, V>>;
+
+            ///Allocates slotCount default constructed slots
+            inline void
+                make(const size_t slotCount)
+            {
+                _items = make_slots<hot_item<Key, hot_type, V>>(slotCount);
+            };
+            ///Deletes slot array
+            inline void
+                release()
+            {
+                release_slots(_items);
+                _items = nullptr;
+            };
+            ///Resizes slot array from oldSlotCount to slotCount keeping held slots - returns false and leaves store untouched on failure
+            inline bool
+                resize(const size_t slotCount,
+                       const size_t oldSlotCount){
+                return resize_slots(_items, oldSlotCount, slotCount);
+            };
+            ///Returns item in slot
+            inline reference
+                operator[](const size_t slotIndex){
+                return _items[slotIndex];
+            };
+            ///Returns pointer to item in slot
+            inline pointer
+                ptr(const size_t slotIndex){
+                return &_items[slotIndex];
+            };
+            ///Returns key held in slot
+            inline size_t
+                key(const size_t slotIndex){
+                return _items[slotIndex]._1;
+            };
+            ///Rewrites key held in slot
+            inline void
+                set_key(const size_t slotIndex,
+                        const Key key){
+                _items[slotIndex]._1 = key;
+            };
+            ///Returns value held in slot
+            inline V&
+                value(const size_t slotIndex){
+                return _items[slotIndex]._2;
+            };
+            ///Prefetches slot
+            inline void
+                prefetch(const size_t slotIndex){
+                prefetch_read(&_items[slotIndex]);
+            };
+            ///Returns hot projection held in slot
+            inline const hot_type&
+                hot(const size_t slotIndex){
+                return _items[slotIndex]._hot;
+            };
+            ///Copies item into slot and projects its hot fields
+            inline void
+                put(const size_t slotIndex,
+                    const item_type& item)
+            {
+                _items[slotIndex]._1   = item._1;
+                _items[slotIndex]._hot = HotProj{}(item._2);
+                _items[slotIndex]._2   = item._2;
+            };
+            ///Moves item into slot and projects its hot fields
+            inline void
+                put(const size_t slotIndex,
+                    item_type&& item)
+            {
+                _items[slotIndex]._1   = item._1;
+                _items[slotIndex]._hot = HotProj{}(item._2);
+                _items[slotIndex]._2   = std::move(item._2);
+            };
+            ///Constructs value in slot from args and projects its hot fields
+            template <typename... Args>
+            inline void
+                emplace(const size_t slotIndex,
+                        const Key key,
+                        Args&&... args)
+            {
+                _items[slotIndex]._1 = key;
+                emplace_value(_items[slotIndex]._2, std::forward<Args>(args)...);
+                _items[slotIndex]._hot = HotProj{}(_items[slotIndex]._2);
+            };
+            ///Moves item from slot srcIndex of srcItems into slot dstIndex
+            inline void
+                move_from(const size_t dstIndex,
+                          items_hot& srcItems,
+                          const size_t srcIndex){
+                _items[dstIndex] = std::move(srcItems._items[srcIndex]);
+            };
+            ///Moves item between two slots of this store
+            inline void
+                move_within(const size_t dstIndex,
+                            const size_t srcIndex){
+                _items[dstIndex] = std::move(_items[srcIndex]);
+            };
+            ///Bytes per slot of array
+            static constexpr size_t
+                array_stride(const size_t){
+                return sizeof(hot_item<Key, hot_type, V>);
+            };
+            ///Start of array
+            inline void*
+                array_data(const size_t){
+                return _items;
+            };
+            ///Points array at data ( not owned - snapshot mappings, never release()d )
+            inline void
+                array_attach(const size_t,
+                             void* data){
+                _items = static_cast<hot_item<Key, hot_type, V>*>(data);
+            };
+
+            hot_item<Key, hot_type, V>* _items = nullptr;   ///< key/hot/value slots
+        };
+
+        #if SMAP_HAS_MMAP
+        ///Directory file backed stores create their files in ( storage_mapped default ) - $TMPDIR if set, else /var/tmp
+        ///--- ( /tmp is left out as it is often tmpfs - a file there is RAM and swap, so pages are never dropped to disk )
+        struct mapped_dir_env
+        {
+            inline const char*
+                operator()() const
+            {
+                const char* dir = std::getenv("TMPDIR");
+                if ( dir != nullptr && dir[0] != '\0' )
+                    return dir;
+
+                return "/var/tmp";
+            };
+        };
+
+        ///Page size file backed stores round mappings and hints to
+        static inline size_t
+            mapped_page_bytes()
+        {
+            static const size_t pagebytes = size_t(::sysconf(_SC_PAGESIZE));
+
+            return pagebytes;
+        };
+
+        ///Key/value pairs in an unlinked sparse file in Dir{}() mapped shared - only touched pages are resident and clean
+        ///--- ones are dropped back to the file, so the item array may exceed RAM ( slots a query never visits are never read )
+        ///--- ( Dir must be on a disk backed filesystem - on tmpfs the file is itself RAM and swap )
+        ///--- ( Grows and shrinks in place through ftruncate and remap - restripe and shrink move stripes inside the mapping )
+        ///--- ( Slots start zeroed and are never constructed or destroyed - V must be trivially copyable )
+        template <typename V, typename Dir, typename Key = size_t>
+        struct items_mapped
+        {
+            static_assert(std::is_unsigned<Key>::value, "stripe_map key type must be an unsigned integer");
+            static_assert(std::is_trivially_copyable<V>::value, "stripe_map mapped storage needs trivially copyable values");
+
+            static constexpr bool PROJECTED = false;
+            static constexpr bool HOT       = false;
+            static constexpr bool FILE_BACKED = true;
+            static constexpr bool HANDLED     = false;
+            static constexpr bool GROWS_IN_PLACE = true;
+            static constexpr size_t ARRAY_COUNT = 1;
+
+            typedef Key key_type;
+            typedef Prs::tpsPr<Key, V> item_type;
+            typedef Prs::tpsPr<Key, V>& reference;
+            typedef Prs::tpsPr<Key, V>* pointer;
+
+            ///Creates backing file and maps slotCount zeroed slots ( throws std::bad_alloc on failure, as new[] would )
+            inline void
+                make(const size_t slotCount)
+            {
+                char path[4096];
+                std::snprintf(path, sizeof(path), "%s/stripe_map_XXXXXX", Dir{}());
+
+                _fd    = ::mkstemp(path);
+                _items = nullptr;
+                _bytes = 0;
+                if ( _fd < 0 )
+                    throw std::bad_alloc();
+
+                //Unlinked file lives until the last descriptor and mapping go away
+                ::unlink(path);
+
+                if ( !resize(slotCount) )
+                {
+                    ::close(_fd);
+                    _fd = -1;
+
+                    throw std::bad_alloc();
+                }
+            };
+            ///Unmaps slots and closes backing file
+            inline void
+                release()
+            {
+                if ( _items != nullptr && _bytes != 0 )
+                    ::munmap(_items, _bytes);
+                if ( _fd >= 0 )
+                    ::close(_fd);
+
+                _items = nullptr;
+                _bytes = 0;
+                _fd    = -1;
+            };
+            ///Resizes file and mapping to slotCount slots keeping held slots - returns false and leaves store untouched on failure
+            ///--- ( Rounded to whole pages - slots past the old size read as zero, so the old slot count is not needed )
+            inline bool
+                resize(const size_t slotCount,
+                       const size_t = 0)
+            {
+                const size_t pagebytes = mapped_page_bytes();
+                const size_t bytes     = std::max<size_t>(1, ( slotCount * sizeof(item_type) + pagebytes - 1 ) / pagebytes) * pagebytes;
+
+                if ( bytes == _bytes )
+                    return true;
+
+                //Grown file must exist before it is mapped, shrunk file is only cut once unmapped
+                if ( bytes > _bytes && ::ftruncate(_fd, off_t(bytes)) != 0 )
+                    return false;
+
+                void* mapping;
+                #if defined(__linux__)
+                    if ( _items != nullptr )
+                        mapping = ::mremap(_items, _bytes, bytes, MREMAP_MAYMOVE);
+                    else
+                        mapping = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, _fd, 0);
+                #else
+                    mapping = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, _fd, 0);
+                    if ( mapping != MAP_FAILED && _items != nullptr )
+                        ::munmap(_items, _bytes);
+                #endif
+
+                if ( mapping == MAP_FAILED )
+                {
+                    if ( bytes > _bytes )
+                        ::ftruncate(_fd, off_t(_bytes));
+
+                    return false;
+                }
+
+                if ( bytes < _bytes )
+                    ::ftruncate(_fd, off_t(bytes));
+
+                _items = static_cast<Prs::tpsPr<Key, V>*>(mapping);
+                _bytes = bytes;
+
+                return true;
+            };
+            ///Returns item in slot
+            inline reference
+                operator[](const size_t slotIndex){
+                return _items[slotIndex];
+            };
+            ///Returns pointer to item in slot
+            inline pointer
+                ptr(const size_t slotIndex){
+                return &_items[slotIndex];
+            };
+            ///Returns key held in slot
+            inline size_t
+                key(const size_t slotIndex){
+                return _items[slotIndex]._1;
+            };
+            ///Rewrites key held in slot
+            inline void
+                set_key(const size_t slotIndex,
+                        const Key key){
+                _items[slotIndex]._1 = key;
+            };
+            ///Returns value held in slot
+            inline V&
+                value(const size_t slotIndex){
+                return _items[slotIndex]._2;
+            };
+            ///Prefetches slot
+            inline void
+                prefetch(const size_t slotIndex){
+                prefetch_read(&_items[slotIndex]);
+            };
+            ///Asks the kernel to read slots [slotBegin, slotEnd) in ahead of use ( ranges under a page are left to fault-around )
+            inline void
+                advise_willneed(const size_t slotBegin,
+                                const size_t slotEnd)
+            {
+                const size_t pagebytes = mapped_page_bytes();
+                if ( _items == nullptr || slotEnd <= slotBegin || ( slotEnd - slotBegin ) * sizeof(item_type) < pagebytes )
+                    return;
+
+                const size_t first = slotBegin * sizeof(item_type) / pagebytes * pagebytes;
+                const size_t last  = slotEnd * sizeof(item_type);
+
+                ::madvise(reinterpret_cast<char*>(_items) + first, last - first, MADV_WILLNEED);
+            };
+            ///Hints whole mapping is read in order ( true for a scan - false returns it to normal readahead )
+            inline void
+                advise_sequential(const bool sequential)
+            {
+                if ( _items != nullptr && _bytes != 0 )
+                    ::madvise(_items, _bytes, sequential ? MADV_SEQUENTIAL : MADV_NORMAL);
+            };
+            ///Copies item into slot
+            inline void
+                put(const size_t slotIndex,
+                    const item_type& item){
+                _items[slotIndex] = item;
+            };
+            ///Moves item into slot
+            inline void
+                put(const size_t slotIndex,
+                    item_type&& item){
+                _items[slotIndex] = std::move(item);
+            };
+            ///Constructs value in slot from args
+            template <typename... Args>
+            inline void
+                emplace(const size_t slotIndex,
+                        const Key key,
+                        Args&&... args)
+            {
+                _items[slotIndex]._1 = key;
+                emplace_value(_items[slotIndex]._2, std::forward<Args>(args)...);
+            };
+            ///Moves item from slot srcIndex of srcItems into slot dstIndex
+            inline void
+                move_from(const size_t dstIndex,
+                          items_mapped& srcItems,
+                          const size_t srcIndex){
+                _items[dstIndex] = std::move(srcItems._items[srcIndex]);
+            };
+            ///Moves item between two slots of this store
+            inline void
+                move_within(const size_t dstIndex,
+                            const size_t srcIndex){
+                _items[dstIndex] = std::move(_items[srcIndex]);
+            };
+            ///Bytes per slot of array
+            static constexpr size_t
+                array_stride(const size_t){
+                return sizeof(Prs::tpsPr<Key, V>);
+            };
+            ///Start of array
+            inline void*
+                array_data(const size_t){
+                return _items;
+            };
+            ///Points array at data ( not owned - snapshot mappings, never release()d or resized )
+            inline void
+                array_attach(const size_t,
+                             void* data)
+            {
+                _items = static_cast<Prs::tpsPr<Key, V>*>(data);
+                _bytes = 0;
+                _fd    = -1;
+            };
+
+            Prs::tpsPr<Key, V>* _items = nullptr;       ///< key/value slots ( mapping of _fd )
+            size_t _bytes              = 0;             ///< mapped bytes ( 0 if attached )
+            int _fd                    = -1;            ///< backing file ( -1 if attached )
+        };
+        #endif
+
+        ///-------------------------------------------------------------------------------------------------------
+        ///HANDLES
+        ///--- ( A handle names one item for as long as it is held - an index into the map's handle table plus the generation )
+        ///--- ( the entry had when issued, so handles to erased items stop resolving instead of naming whatever reuses the slot )
+        static constexpr uint32_t SMAP_HANDLE_NONE = UINT32_MAX;
+
+        ///Generational handle of one item
+        struct stripe_handle
+        {
+            uint32_t _index = SMAP_HANDLE_NONE;     ///< handle table entry ( SMAP_HANDLE_NONE if never issued )
+            uint32_t _gen   = 0;                    ///< entry generation at issue ( odd - entries are live while odd )
+        };
+
+        ///Handle table entry ( slot of the item while live, next free entry while free )
+        struct handle_entry
+        {
+            stripe_index_t _slot;
+            uint32_t _gen;
+        };
+
+        ///Handle index -> slot table with a free list of released entries
+        ///--- ( Non-owning handle like stripe_occupancy - owner calls release() )
+        struct handle_table
+        {
+            ///Issues a handle for slot ( index SMAP_HANDLE_NONE if 4G handles are live )
+            inline stripe_handle
+                issue(const size_t slot)
+            {
+                stripe_handle handle;
+
+                if ( _free != SMAP_HANDLE_NONE )
+                {
+                    handle._index = _free;
+                    _free = uint32_t(_entries[_free]._slot);
+                }
+                else
+                {
+                    if ( _count == SMAP_HANDLE_NONE )
+                        return handle;
+
+                    if ( _count == _capacity )
+                        grow();
+
+                    _entries[_count]._gen = 0;
+                    handle._index = uint32_t(_count++);
+                }
+
+                handle_entry& entry = _entries[handle._index];
+                entry._slot = static_cast<stripe_index_t>(slot);
+                entry._gen++;
+                handle._gen = entry._gen;
+
+                return handle;
+            };
+            ///Frees live entry index onto the free list ( its handles stop resolving )
+            inline void
+                free(const uint32_t index)
+            {
+                handle_entry& entry = _entries[index];
+                entry._gen++;
+                entry._slot = static_cast<stripe_index_t>(_free);
+
+                _free = index;
+            };
+            ///Frees every live entry
+            inline void
+                clear()
+            {
+                for ( size_t i = 0; i < _count; i++ )
+                {
+                    if ( live(i) )
+                        free(uint32_t(i));
+                }
+            };
+            ///Deletes table
+            inline void
+                release()
+            {
+                delete[] _entries;
+
+                _entries  = nullptr;
+                _count    = 0;
+                _capacity = 0;
+                _free     = SMAP_HANDLE_NONE;
+            };
+            ///Returns true if entry index is live
+            inline bool
+                live(const size_t index) const {
+                return ( _entries[index]._gen & 1 ) != 0;
+            };
+            ///Returns entry index
+            inline handle_entry&
+                operator[](const size_t index){
+                return _entries[index];
+            };
+            ///Entries issued so far ( live and free )
+            inline size_t
+                size() const {
+                return _count;
+            };
+
+            private:
+                ///Doubles entry array
+                inline void
+                    grow()
+                {
+                    _capacity = _capacity != 0 ? _capacity * 2 : 64;
+
+                    handle_entry* entries = new handle_entry[_capacity];
+                    if ( _count != 0 )
+                        std::memcpy(entries, _entries, _count * sizeof(handle_entry));
+
+                    delete[] _entries;
+                    _entries = entries;
+                };
+
+                handle_entry* _entries = nullptr;   ///< entry per issued index
+                size_t _count          = 0;         ///< entries issued
+                size_t _capacity       = 0;         ///< entries allocated
+                uint32_t _free         = SMAP_HANDLE_NONE;      ///< first free entry
+        };
+
+        ///Any stored key item store plus the handle table index of each slot ( SMAP_HANDLE_NONE if none was issued )
+        ///--- ( Indices travel with every move and repoint the table entry, so handles follow items through erase swaps, )
+        ///--- ( restripe, shrink and load - the owning map binds _table whenever it swaps stores )
+        template <typename Items>
+        struct items_handled : Items
+        {
+            static_assert(!Items::PROJECTED, "handles need a store that keeps its keys");
+            static_assert(!Items::FILE_BACKED, "handles are not kept by file backed storage");
+
+            static constexpr bool HANDLED = true;
+
+            typedef typename Items::item_type item_type;
+
+            ///Allocates slotCount slots and their handle indices
+            inline void
+                make(const size_t slotCount)
+            {
+                Items::make(slotCount);
+
+                _handles = make_slots<uint32_t>(slotCount);
+                std::fill(_handles, _handles + slotCount, SMAP_HANDLE_NONE);
+            };
+            ///Deletes slots and handle indices
+            inline void
+                release()
+            {
+                Items::release();
+
+                release_slots(_handles);
+                _handles = nullptr;
+            };
+            ///Resizes slots and handle indices from oldSlotCount to slotCount keeping held slots - returns false if any array failed
+            ///--- ( New slots hold no handle - every array still holds at least the smaller of both counts after a failure )
+            inline bool
+                resize(const size_t slotCount,
+                       const size_t oldSlotCount)
+            {
+                if ( !resize_slots(_handles, oldSlotCount, slotCount) || !Items::resize(slotCount, oldSlotCount) )
+                    return false;
+
+                if ( slotCount > oldSlotCount )
+                    std::fill(_handles + oldSlotCount, _handles + slotCount, SMAP_HANDLE_NONE);
+
+                return true;
+            };
+            ///Copies item into slot ( no handle until one is issued )
+            inline void
+                put(const size_t slotIndex,
+                    const item_type& item)
+            {
+                Items::put(slotIndex, item);
+                _handles[slotIndex] = SMAP_HANDLE_NONE;
+            };
+            ///Moves item into slot ( no handle until one is issued )
+            inline void
+                put(const size_t slotIndex,
+                    item_type&& item)
+            {
+                Items::put(slotIndex, std::move(item));
+                _handles[slotIndex] = SMAP_HANDLE_NONE;
+            };
+            ///Constructs value in slot from args ( no handle until one is issued )
+            template <typename... Args>
+            inline void
+                emplace(const size_t slotIndex,
+                        const typename Items::key_type key,
+                        Args&&... args)
+            {
+                Items::emplace(slotIndex, key, std::forward<Args>(args)...);
+                _handles[slotIndex] = SMAP_HANDLE_NONE;
+            };
+            ///Moves item and its handle from slot srcIndex of srcItems into slot dstIndex
+            inline void
+                move_from(const size_t dstIndex,
+                          items_handled& srcItems,
+                          const size_t srcIndex)
+            {
+                Items::move_from(dstIndex, srcItems, srcIndex);
+
+                _handles[dstIndex] = srcItems._handles[srcIndex];
+                _table             = srcItems._table;
+                relink(dstIndex);
+            };
+            ///Moves item and its handle between two slots of this store
+            inline void
+                move_within(const size_t dstIndex,
+                            const size_t srcIndex)
+            {
+                Items::move_within(dstIndex, srcIndex);
+
+                _handles[dstIndex] = _handles[srcIndex];
+                relink(dstIndex);
+            };
+            ///Points the table entry of slot's handle at slot
+            inline void
+                relink(const size_t slotIndex)
+            {
+                const uint32_t index = _handles[slotIndex];
+                if ( index != SMAP_HANDLE_NONE && _table != nullptr )
+                    (*_table)[index]._slot = static_cast<stripe_index_t>(slotIndex);
+            };
+
+            uint32_t* _handles    = nullptr;    ///< handle table index per slot
+            handle_table* _table  = nullptr;    ///< owning map's table
+        };
+
+        ///-------------------------------------------------------------------------------------------------------
+        ///SNAPSHOT FILE
+        ///--- ( Header, stripe directory and every slot array of a shrunk map, each section page aligned )
+        ///--- ( Written and read by the same build - sizes in the header reject other layouts instead of converting )
+        static constexpr char SMAP_SNAPSHOT_MAGIC[8]     = { 'S', 'M', 'A', 'P', 'S', 'N', 'A', 'P' };
+        static constexpr uint32_t SMAP_SNAPSHOT_VERSION  = 1;
+        static constexpr size_t SMAP_SNAPSHOT_ALIGN      = 4096;
+        static constexpr size_t SMAP_SNAPSHOT_MAX_ARRAYS = 2;
+        static constexpr uint64_t SMAP_SNAPSHOT_SEED     = 0xcbf29ce484222325ull;
+
+        ///Snapshot file header ( offset 0 )
+        struct snapshot_header
+        {
+            char magic[8];                                      ///< SMAP_SNAPSHOT_MAGIC
+            uint32_t version;                                   ///< SMAP_SNAPSHOT_VERSION
+            uint32_t header_bytes;                              ///< sizeof(snapshot_header)
+            uint32_t stripe_bytes;                              ///< sizeof(stripe) ( differs with SMAP_WIDE_STRIPES )
+            uint32_t key_bytes;                                 ///< sizeof(key_type)
+            uint32_t value_bytes;                               ///< sizeof(V)
+            uint32_t storage_flags;                             ///< bit 0 projected, bit 1 hot
+            uint32_t array_count;                               ///< slot arrays of the item store
+            uint32_t array_stride[SMAP_SNAPSHOT_MAX_ARRAYS];    ///< bytes per slot of each array
+
+            uint64_t depth_max;                                 ///< stripe_map geometry
+            uint64_t stripe_amount;
+            uint64_t stripe_depth;
+            uint64_t slots_width;
+            uint64_t items_count;                               ///< items ( equals slots - map is shrunk )
+            int64_t ext_max;                                    ///< query_margin() at save
+
+            uint64_t stripes_offset;                            ///< stripe directory
+            uint64_t array_offset[SMAP_SNAPSHOT_MAX_ARRAYS];    ///< slot arrays
+            uint64_t file_bytes;                                ///< total file size
+
+            uint64_t items_checksum;                            ///< slot arrays
+            uint64_t directory_checksum;                        ///< header ( this field zeroed ) and stripe directory
+        };
+
+        ///Rounds bytes up to SMAP_SNAPSHOT_ALIGN
+        static inline size_t
+            snapshot_align(const size_t bytes){
+            return ( bytes + SMAP_SNAPSHOT_ALIGN - 1 ) & ~( SMAP_SNAPSHOT_ALIGN - 1 );
+        };
+        ///64-bit FNV-1a style checksum over bytes, 8 bytes per step ( chain by passing the previous result as seed )
+        static inline uint64_t
+            snapshot_checksum(const void* data,
+                              const size_t bytes,
+                              uint64_t seed = SMAP_SNAPSHOT_SEED)
+        {
+            const unsigned char* ptr = static_cast<const unsigned char*>(data);
+
+            size_t i = 0;
+            for ( ; i + 8 <= bytes; i += 8 )
+            {
+                uint64_t word;
+                std::memcpy(&word, ptr + i, 8);
+
+                seed = ( seed ^ word ) * 0x100000001b3ull;
+            }
+            for ( ; i < bytes; i++ )
+                seed = ( seed ^ ptr[i] ) * 0x100000001b3ull;
+
+            return seed;
+        };
+        ///Checksum of header with directory_checksum zeroed, chained over stripeCount stripes
+        static inline uint64_t
+            snapshot_directory_checksum(snapshot_header header,
+                                        const stripe* stripes,
+                                        const size_t stripeCount)
+        {
+            header.directory_checksum = 0;
+
+            return snapshot_checksum(stripes,
+                                     stripeCount * sizeof(stripe),
+                                     snapshot_checksum(&header, sizeof(header)));
+        };
+        ///Writes zero bytes to file until it is offset bytes long
+        static inline bool
+            snapshot_pad(std::FILE* file,
+                         const size_t offset)
+        {
+            static const char zeros[SMAP_SNAPSHOT_ALIGN] = {};
+
+            long position = std::ftell(file);
+            if ( position < 0 )
+                return false;
+
+            while ( size_t(position) < offset )
+            {
+                const size_t amount = std::min(offset - size_t(position), sizeof(zeros));
+                if ( std::fwrite(zeros, 1, amount, file) != amount )
+                    return false;
+
+                position += amount;
+            }
+
+            return true;
+        };
+
+        #if SMAP_HAS_MMAP
+        ///Maps first bytes of fd privately ( writes stay in process ) - returns mapping and its size or nullptr
+        static inline Prs::tpsPr<void*, size_t>
+            snapshot_map_fd(const int fd,
+                            const size_t bytes)
+        {
+            void* mapping = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+            if ( mapping == MAP_FAILED )
+                return Prs::tpsPr<void*, size_t>(nullptr, 0);
+
+            return Prs::tpsPr<void*, size_t>(mapping, bytes);
+        };
+        ///Maps file at path privately ( writes stay in process ) - returns mapping and its size or nullptr
+        static inline Prs::tpsPr<void*, size_t>
+            snapshot_map_file(const char* path)
+        {
+            const int fd = ::open(path, O_RDONLY);
+            if ( fd < 0 )
+                return Prs::tpsPr<void*, size_t>(nullptr, 0);
+
+            struct stat info;
+            if ( ::fstat(fd, &info) != 0 || size_t(info.st_size) < sizeof(snapshot_header) )
+            {
+                ::close(fd);
+                return Prs::tpsPr<void*, size_t>(nullptr, 0);
+            }
+
+            const auto mapping = snapshot_map_fd(fd, size_t(info.st_size));
+            ::close(fd);
+
+            return mapping;
+        };
+        ///Unmaps a mapping from snapshot_map_file
+        static inline void
+            snapshot_unmap_file(void* mapping,
+                                const size_t bytes)
+        {
+            if ( mapping != nullptr )
+                ::munmap(mapping, bytes);
+        };
+        #endif
+
+        ///-------------------------------------------------------------------------------------------------------
+        ///HELPER FUNCTIONS
+
+        ///FINDER FUNCTIONS
+        namespace
+        {
+            ///Returns stripe corresponding to given depth ( SCANS )
+            static inline stripe*
+                find_stripe_match_depth(stripe* stripePtr,
+                                        const size_t depthKey)
+            {
+                while ( stripePtr != nullptr )
+                {
+                    if ( stripePtr->depth_match(depthKey) )
+                        return stripePtr;
+
+                    stripePtr = stripePtr->get_next();
+                }
+
+                return nullptr;
+            };
+            ///Returns pointer to stripe given depthKey and current depthMax of stripe_map
+            ///--- ( EXPECTS POINTER TO FIRST STRIPE - DEPTHKEYS AT OR PAST THE LAST STRIPE RETURN THE LAST STRIPE )
+            static inline auto
+                find_stripe_jump_depth(stripe* stripePtr,
+                                       size_t depthKey,
+                                       size_t depthMax,
+                                       const size_t stripeAmnt)
+            {
+                const size_t stripeDepth = stripePtr->get_next()->get_depth();
+                size_t stripeindex = trunc(( depthMax - ( depthMax - depthKey ) ) / stripeDepth );
+
+                if ( stripeindex >= stripeAmnt )
+                    stripeindex = stripeAmnt - 1;
+
+                return &stripePtr[stripeindex];
+            };
+
+            ///OCCUPANCY FINDER FUNCTIONS
+            ///--- ( Only visit stripes marked in occupancy - EXPECT POINTER TO FIRST STRIPE )
+
+            ///Returns first stripe that aligns with given slotIndex ( JUMPS OVER EMPTY STRIPES )
+            static inline const Prs::tpsPr<stripe*, size_t>
+                find_stripe_from_adjd_index(stripe* stripePtr,
+                                            const stripe_occupancy& occupancy,
+                                            const size_t slotIndex)
+            {
+                size_t currindex = slotIndex;
+                for ( size_t i = occupancy.first(); i != stripe_occupancy::npos; i = occupancy.next(i + 1) )
+                {
+                    const auto stripeused = stripePtr[i].used();
+
+                    if ( stripeused > currindex )
+                        return Prs::tpsPr<stripe*, size_t>(&stripePtr[i],
+                                                           stripePtr[i].get_start() + currindex);
+
+                    currindex -= stripeused;
+                }
+
+                return Prs::tpsPr<stripe*, size_t>(nullptr, 0);
+            };
+            ///Returns stripe holding slotIndex and adjusted index of its first item ( JUMPS OVER EMPTY STRIPES )
+            static inline const Prs::tpsPr<stripe*, size_t>
+                find_stripe_start_index_adj(stripe* stripePtr,
+                                            const stripe_occupancy& occupancy,
+                                            const size_t slotIndex)
+            {
+                size_t adjindex = 0;
+                for ( size_t i = occupancy.first(); i != stripe_occupancy::npos; i = occupancy.next(i + 1) )
+                {
+                    if ( stripePtr[i].index_match(slotIndex) )
+                        return Prs::tpsPr<stripe*, size_t>(&stripePtr[i],
+                                                           adjindex);
+
+                    adjindex += stripePtr[i].used();
+                }
+
+                return Prs::tpsPr<stripe*, size_t>(nullptr, 0);
+            };
+            ///Returns adjusted index of the first item at or after the stripe holding depthKey ( JUMPS OVER EMPTY STRIPES )
+            static inline size_t
+                find_start_index_adj_match_depth(stripe* stripePtr,
+                                                 const stripe_occupancy& occupancy,
+                                                 const size_t depthKey)
+            {
+                size_t adjindex = 0;
+                for ( size_t i = occupancy.first(); i != stripe_occupancy::npos; i = occupancy.next(i + 1) )
+                {
+                    if ( !stripePtr[i].depth_before(depthKey) )
+                        return adjindex;
+
+                    adjindex += stripePtr[i].used();
+                }
+
+                return adjindex;
+            };
+            ///Returns adjusted index one past the last item in the stripe holding depthKey ( JUMPS OVER EMPTY STRIPES )
+            static inline size_t
+                find_end_index_adj_match_depth(stripe* stripePtr,
+                                               const stripe_occupancy& occupancy,
+                                               const size_t depthKey)
+            {
+                size_t adjindx = 0;
+                for ( size_t i = occupancy.first(); i != stripe_occupancy::npos; i = occupancy.next(i + 1) )
+                {
+                    if ( stripePtr[i].get_depth() > depthKey )
+                        return adjindx;
+
+                    adjindx += stripePtr[i].used();
+                }
+
+                return adjindx;
+            };
+            ///Returns stripe holding slotIndex with index number back unchanged ( BINARY SEARCH ON STRIPE STARTS )
+            ///--- ( THIS IS TO BE USED WHEN STRIPES HAVE NO GAPS & PERF NEEDED )
+            static inline const Prs::tpsPr<stripe*, size_t>
+                find_stripe_nogap_index(stripe* stripePtr,
+                                        const stripe_occupancy& occupancy,
+                                        const size_t slotIndex)
+            {
+                //Last stripe starting at or before slotIndex - empty stripes sharing its start come before it
+                size_t lo = 0;
+                size_t hi = occupancy.size();
+                while ( lo < hi )
+                {
+                    const size_t mid = ( lo + hi ) >> 1;
+                    if ( stripePtr[mid].get_start() <= slotIndex )
+                        lo = mid + 1;
+                    else
+                        hi = mid;
+                }
+
+                if ( lo == 0 || !stripePtr[lo - 1].index_match(slotIndex) )
+                    return Prs::tpsPr<stripe*, size_t>(nullptr, 0);
+
+                return Prs::tpsPr<stripe*, size_t>(&stripePtr[lo - 1], slotIndex);
+            };
+            ///Returns item array index aligned with adjusted slotIndex ( JUMPS OVER EMPTY STRIPES )
+            static inline size_t
+                find_adjd_index(stripe* stripePtr,
+                                const stripe_occupancy& occupancy,
+                                const size_t slotIndex)
+            {
+                return find_stripe_from_adjd_index(stripePtr,
+                                                   occupancy,
+                                                   slotIndex)._2;
+            };
+
+        };  //end of finder functions namespace
+
+        ///INIT SETUP FUNCTIONS
+        namespace
+        {
+            ///Calculates depth of each stripe ( as portion of grid percent )
+            static inline size_t
+                calc_init_depth_increm(const size_t stripeAmnt,
+                                       const size_t depthMax)
+            {
+                return depthMax / stripeAmnt;
+            };
+
+        };  //end of init setup functions namespace
+
+        ///STRIPE SETUP FUNCTIONS
+        namespace
+        {
+            ///Creates initialization stripe info structures and performs setup
+            static inline stripe*
+                make_init_stripes(const size_t stripeAmnt,
+                                  const size_t stripeWidth,
+                                  const size_t stripeDepth)
+            {
+                auto newstripes = new stripe[stripeAmnt];
+
+                for ( size_t i = 0; i < stripeAmnt; i++ )
+                {
+                    auto & currstripe = newstripes[i];
+
+                    //Set stripe neighbor pointers where applicable
+                    if ( i != 0 )
+                        currstripe.set_stripe_prev(&newstripes[i-1]);
+                    if ( i != stripeAmnt - 1 )
+                        currstripe.set_stripe_next(&newstripes[i+1]);
+
+                    //Set start and end index positions of current stripe
+                    currstripe.set_stripe_start(stripeWidth * i);
+                    currstripe.set_stripe_end(stripeWidth * (i + 1));
+                    //Set the starting depth of the current stripe
+                    currstripe.set_stripe_depth(stripeDepth * i);
+                };
+
+                return newstripes;
+            };
+            ///Copies relevant information to new stripes and adjusts start+end indices
+            ///--- ( Returns new required item slot # - new stripe widths come from growth policy G )
+            template <typename G>
+            static inline size_t
+                fix_new_stripes(stripe* newStripes,
+                                stripe* oldStripes,
+                                const size_t stripeAmnt)
+            {
+                size_t currslotindex = 0;
+                for ( size_t i = 0; i < stripeAmnt; i++ )
+                {
+                    //Assign relevant info from old stripe to new stripe
                     newStripes[i] = oldStripes[i];  //THIS IS NOT POINTER ASSIGNMENT
 
                     //Set pointers to next and previous stripes when applicable
@@ -516,16 +2074,9 @@ namespace qmap
                     if ( i != stripeAmnt - 1 )
                         newStripes[i].set_stripe_next(&newStripes[i+1]);
 
-                    size_t newwidth = newStripes[i].width();
-                    const size_t halfwidth = ceil(newwidth * 0.5f);
-
                     const auto stripeused = newStripes[i].used();
-
-                    //Extend stripe width if it exceeds half capacity
-                    if ( stripeused >= halfwidth )
-                        newwidth = stripeused * STRIPE_EXTEND_AMOUNT;
-                    else if ( stripeused == 0 )
-                        newwidth = SMAP_INIT_WIDTH;
+                    const size_t newwidth = G::next_width(stripeused,
+                                                          newStripes[i].width());
 
                     newStripes[i].set_stripe_start(currslotindex, stripeused);
                     //Increment index based on new stripe width
@@ -543,6 +2094,7 @@ namespace qmap
             };
             ///Sets up new stripe array from old stripe array during expansion(re-striping)
             ///--- ( Returns pointer to new array of stripes adjusted to new slot requirement )
+            template <typename G>
             static inline stripe*
                 setup_new_stripes(stripe* oldStripes,
                                   const size_t stripeAmnt,
@@ -552,9 +2104,9 @@ namespace qmap
                 auto newstripes = new stripe[stripeAmnt];
 
                 //Updates stripe_map slot count from new stripes
-                slotCount = fix_new_stripes(newstripes,
-                                            oldStripes,
-                                            stripeAmnt);
+                slotCount = fix_new_stripes<G>(newstripes,
+                                               oldStripes,
+                                               stripeAmnt);
 
                 return newstripes;
             };
@@ -565,10 +2117,10 @@ namespace qmap
         namespace
         {
             ///Moves stripe items to their proper locations in new stripe
-            template <typename V>
+            template <typename I>
             static inline void
-                move_stripe_items(Prs::tpsPr<size_t, V>* newItems,
-                                  Prs::tpsPr<size_t, V>* oldItems,
+                move_stripe_items(I& newItems,
+                                  I& oldItems,
                                   stripe* newStripe,
                                   stripe* oldStripe)
             {
@@ -582,10 +2134,12 @@ namespace qmap
                 {
                     //Copy stripe from old items to new items at proper index
                     for ( size_t i = 0; i < oldstripeused; i++ )
-                        newItems[newStripe->get_start() + i] = std::move(oldItems[oldStripe->get_start() + i]);
+                        newItems.move_from(newStripe->get_start() + i,
+                                           oldItems,
+                                           oldStripe->get_start() + i);
 
                     #if DEBUG_SMAP > 5
-                        std::cout << "copied " << sizeof(Prs::tpsPr<size_t, V>)
+                        std::cout << "moved " << sizeof(oldItems[0])
                                   << " * " << oldstripeused << " bytes to...\n";
                         std::cout << newStripe->get_start() << " from " << oldStripe->get_start() << std::endl;
                     #endif
@@ -598,16 +2152,17 @@ namespace qmap
                 }
             };
             ///Setup new item array from old item array during expansion(re-striping)
-            ///--- ( Returns pointer to new array of items striped according to new & old stripes )
-            template <typename V>
-            static inline Prs::tpsPr<size_t, V>*
-                setup_new_items(Prs::tpsPr<size_t, V>* oldItems,
+            ///--- ( Returns new item store striped according to new & old stripes )
+            template <typename I>
+            static inline I
+                setup_new_items(I& oldItems,
                                 stripe* newStripes,
                                 stripe* oldStripes,
                                 const size_t slotCount)
             {
                 //New item array to be accommodate resizing
-                auto newitems = new Prs::tpsPr<size_t, V>[slotCount];
+                I newitems;
+                newitems.make(slotCount);
 
                 move_stripe_items(newitems,
                                   oldItems,
@@ -617,14 +2172,15 @@ namespace qmap
                 return newitems;
             };
             ///Shrinks items to single contiguous array
-            ///--- ( Returns pointer to new array of contiguous items & adjusts stripes to match new indices )
-            template <typename V>
-            static inline Prs::tpsPr<size_t, V>*
-                shrink_items(Prs::tpsPr<size_t, V>* oldItems,
+            ///--- ( Returns new store of contiguous items & adjusts stripes to match new indices )
+            template <typename I>
+            static inline I
+                shrink_items(I& oldItems,
                              stripe* stripePtr,
                              const size_t itemCount)
             {
-                auto newitems = new Prs::tpsPr<size_t, V>[itemCount];
+                I newitems;
+                newitems.make(itemCount);
 
                 size_t moveindex  = 0;
                 size_t trimoffset = 0;
@@ -634,7 +2190,9 @@ namespace qmap
 
                     //Copy stripe from old items to new items at proper index
                     for ( size_t i = 0; i < stripeused; i++ )
-                        newitems[moveindex + i] = std::move(oldItems[stripePtr->get_start() + i]);
+                        newitems.move_from(moveindex + i,
+                                           oldItems,
+                                           stripePtr->get_start() + i);
 
                     const size_t stripeoffset = stripePtr->trim_stripe_end(trimoffset);
 
@@ -651,6 +2209,78 @@ namespace qmap
 
                 return newitems;
             };
+            ///Moves items of a file backed store from oldStripes to newStripes inside its own mapping ( restripe without a second array )
+            ///--- ( Returns false and leaves items untouched if the mapping cannot grow )
+            template <typename I>
+            static inline bool
+                restripe_items_in_place(I& items,
+                                        stripe* newStripes,
+                                        stripe* oldStripes,
+                                        const size_t stripeAmnt,
+                                        const size_t oldSlotCount,
+                                        const size_t newSlotCount)
+            {
+                //Room for both layouts while stripes move
+                if ( !items.resize(std::max(oldSlotCount, newSlotCount)) )
+                    return false;
+
+                //Stripes order is kept, so a stripe moving up only lands on later stripes moving up - last to first, back to front
+                for ( size_t s = stripeAmnt; s-- > 0; )
+                {
+                    const size_t oldstart = oldStripes[s].get_start();
+                    const size_t newstart = newStripes[s].get_start();
+                    if ( newstart <= oldstart )
+                        continue;
+
+                    for ( size_t i = oldStripes[s].used(); i-- > 0; )
+                        items.move_within(newstart + i, oldstart + i);
+                }
+                //Likewise a stripe moving down only lands on earlier stripes moving down - first to last, front to back
+                for ( size_t s = 0; s < stripeAmnt; s++ )
+                {
+                    const size_t oldstart = oldStripes[s].get_start();
+                    const size_t newstart = newStripes[s].get_start();
+                    if ( newstart >= oldstart )
+                        continue;
+
+                    for ( size_t i = 0; i < oldStripes[s].used(); i++ )
+                        items.move_within(newstart + i, oldstart + i);
+                }
+
+                //Failing to cut a larger mapping back only leaves it oversized
+                items.resize(newSlotCount);
+
+                return true;
+            };
+            ///Shrinks items of a file backed store to one contiguous run inside its own mapping, then cuts the file
+            ///--- ( Same stripe adjustment as shrink_items - items only move down, so front to back never overwrites unmoved items )
+            template <typename I>
+            static inline void
+                shrink_items_in_place(I& items,
+                                      stripe* stripePtr,
+                                      const size_t itemCount)
+            {
+                size_t moveindex  = 0;
+                size_t trimoffset = 0;
+                while ( stripePtr != nullptr )
+                {
+                    const size_t stripeused = stripePtr->used();
+
+                    if ( moveindex != stripePtr->get_start() )
+                    {
+                        for ( size_t i = 0; i < stripeused; i++ )
+                            items.move_within(moveindex + i,
+                                              stripePtr->get_start() + i);
+                    }
+
+                    trimoffset += stripePtr->trim_stripe_end(trimoffset);
+                    moveindex  += stripeused;
+
+                    stripePtr = stripePtr->get_next();
+                }
+
+                items.resize(itemCount);
+            };
 
         };  //end of item array setup functions namespace
         ///ITEM ARRAY CONTROL FUNCTIONS
@@ -658,9 +2288,9 @@ namespace qmap
         {
             ///Erases item from given stripe pointer and item array
             ///--- ( Expects given stripe to already align given eraseIndex )
-            template <typename V>
+            template <typename I>
             static inline bool
-                erase_item_from_stripe(Prs::tpsPr<size_t, V>* itemsPtr,
+                erase_item_from_stripe(I& itemsPtr,
                                        stripe* stripePtr,
                                        const size_t eraseIndex)
             {
@@ -672,15 +2302,15 @@ namespace qmap
 
                 //Swaps good item into erased item's location if erase wasn't end of stripe
                 if ( eraseIndex != erasesuccess._2 )
-                    itemsPtr[eraseIndex]  = std::move(itemsPtr[erasesuccess._2]);
+                    itemsPtr.move_within(eraseIndex, erasesuccess._2);
 
                 //Erase success
                 return true;
             };
             ///Removes all items from from stripes that match given value
-            template <typename V, typename F>
+            template <typename I, typename F>
             static inline auto
-                remove_values_from_stripes(Prs::tpsPr<size_t, V>* itemsPtr,
+                remove_values_from_stripes(I& itemsPtr,
                                            stripe* stripePtr,
                                            const size_t rmvIndStart,
                                            const size_t rmvIndEnd,
@@ -752,19 +2382,336 @@ namespace qmap
                 return Prs::tpsPr<const bool, const size_t>(clearsuccess,
                                                             clearamount);
             };
+            ///Removes all items matching check from occupied stripes, starting at stripe index stripeFirst
+            ///--- ( Stripes left empty are unmarked in occupancy )
+            template <typename I, typename F>
+            static inline auto
+                remove_values_from_stripes(I& itemsPtr,
+                                           stripe* stripePtr,
+                                           stripe_occupancy& occupancy,
+                                           const size_t stripeFirst,
+                                           const size_t rmvIndStart,
+                                           const size_t rmvIndEnd,
+                                           F&& check)
+            {
+                bool removesuccess   = false;
+                size_t removeamount  = 0;
+                for ( size_t s = occupancy.next(stripeFirst); s != stripe_occupancy::npos; s = occupancy.next(s + 1) )
+                {
+                    stripe& currstripe = stripePtr[s];
+
+                    size_t stripestart = currstripe.get_start();
+                    if ( stripestart < rmvIndStart )
+                        stripestart = rmvIndStart;
+
+                    size_t stripepos = currstripe.get_position();
+                    if ( stripepos > rmvIndEnd )
+                        stripepos = rmvIndEnd;
+
+                    for ( size_t i = stripestart; i < stripepos; )
+                    {
+                        if ( check(itemsPtr[i]) )
+                        {
+                            removesuccess |= erase_item_from_stripe(itemsPtr,
+                                                                    &currstripe,
+                                                                    i);
+                            stripepos--;
+                            removeamount++;
+                            //Check index again as item may have been swapped
+                            continue;
+                        }
+                        i++;
+                    }
+
+                    if ( currstripe.is_empty() )
+                        occupancy.unset(s);
+                }
+
+                return Prs::tpsPr<const bool, const size_t>(removesuccess,
+                                                            removeamount);
+            };
+            ///Sets all occupied stripe positions to start and empties occupancy
+            static inline auto
+                clear_stripe_all(stripe* stripePtr,
+                                 stripe_occupancy& occupancy)
+            {
+                bool clearsuccess  = false;
+                size_t clearamount = 0;
+                for ( size_t s = occupancy.first(); s != stripe_occupancy::npos; s = occupancy.next(s + 1) )
+                {
+                    const auto clearstripe = stripePtr[s].clear_stripe();
+
+                    clearsuccess |= clearstripe._1;
+                    clearamount  += clearstripe._2;
+                }
+
+                occupancy.clear_all();
+
+                return Prs::tpsPr<const bool, const size_t>(clearsuccess,
+                                                            clearamount);
+            };
+            ///Rebuilds secondary-axis bounds of every stripe from the items it holds ( projections of BoundsPolicy B )
+            ///--- ( Returns largest extent over all stripes )
+            template <typename B, typename I>
+            static inline int64_t
+                recalc_stripe_bounds(I& itemsPtr,
+                                     stripe* stripePtr,
+                                     stripe_bounds* boundsPtr)
+            {
+                int64_t extmax = 0;
+                while ( stripePtr != nullptr )
+                {
+                    boundsPtr->reset();
+
+                    for ( size_t i = stripePtr->get_start(); i < stripePtr->get_position(); i++ )
+                        boundsPtr->expand(B::sec(itemsPtr.value(i)),
+                                          B::ext(itemsPtr.value(i)));
+
+                    if ( boundsPtr->get_ext_max() > extmax )
+                        extmax = boundsPtr->get_ext_max();
+
+                    stripePtr = stripePtr->get_next();
+                    boundsPtr++;
+                }
+
+                return extmax;
+            };
 
         };  //end of item array control functions namespace
 
     };  //end of helper namespace
 
+    ///-------------------------------------------------------------------------------------------------------
+    ///STRIPE_MAP POLICIES
+    ///--- ( Resolved at compile time - stripe_map<V, GrowthPolicy, IndexPolicy, StoragePolicy, BoundsPolicy> )
+
+    ///GROWTH POLICIES
+    ///--- ( next_width(used, width) gives a stripe's width after restripe - must exceed used for full stripes )
+
+    ///Doubles stripes at or past half capacity, empty stripes return to SMAP_INIT_WIDTH ( default )
+    struct growth_double
+    {
+        static inline size_t
+            next_width(const size_t stripeUsed,
+                       const size_t stripeWidth)
+        {   using namespace implem;
+
+            if ( stripeUsed == 0 )
+                return SMAP_INIT_WIDTH;
+            if ( stripeUsed >= size_t(ceil(stripeWidth * 0.5f)) )
+                return stripeUsed * STRIPE_EXTEND_AMOUNT;
+
+            return stripeWidth;
+        };
+    };
+    ///Widens full stripes by Increment slots, empty stripes get Increment slots
+    ///--- ( Bounded waste per stripe for steady growth - more restripes than doubling under bursts )
+    template <size_t Increment>
+    struct growth_fixed
+    {
+        static_assert(Increment > 0, "growth_fixed increment must be above 0");
+
+        static inline size_t
+            next_width(const size_t stripeUsed,
+                       const size_t stripeWidth)
+        {
+            if ( stripeUsed == 0 )
+                return Increment;
+            if ( stripeUsed >= stripeWidth )
+                return stripeWidth + Increment;
+
+            return stripeWidth;
+        };
+    };
+    ///Sizes every stripe to its used slots plus one
+    ///--- ( Least memory - every add to a full stripe restripes, so suited to maps filled once and shrunk )
+    struct growth_exact
+    {
+        static inline size_t
+            next_width(const size_t stripeUsed,
+                       const size_t){
+            return stripeUsed + 1;
+        };
+    };
+
+    ///INDEX POLICIES
+    ///--- ( Map adjusted indices ( operator[], iterators, erase, remove ) onto slots )
+
+    ///Stripe walk while gapped, direct slot indexing once shrunk ( default )
+    struct index_adaptive
+    {
+        static constexpr bool SHRINK_ON_LOOKUP = false;
+
+        static inline const Prs::tpsPr<implem::stripe*, size_t>
+            find_stripe(implem::stripe* stripePtr,
+                        const implem::stripe_occupancy& occupancy,
+                        const size_t smIndex,
+                        const bool isShrunk)
+        {   using namespace implem;
+
+            if ( isShrunk )
+                return find_stripe_nogap_index(stripePtr, occupancy, smIndex);
+
+            return find_stripe_from_adjd_index(stripePtr, occupancy, smIndex);
+        };
+        static inline size_t
+            find_slot(implem::stripe* stripePtr,
+                      const implem::stripe_occupancy& occupancy,
+                      const size_t smIndex,
+                      const bool isShrunk)
+        {   using namespace implem;
+
+            if ( isShrunk )
+                return smIndex;
+
+            return find_adjd_index(stripePtr, occupancy, smIndex);
+        };
+    };
+    ///Always walks occupied stripes ( no branch on shrunk state - for maps rarely shrunk )
+    struct index_gapped
+    {
+        static constexpr bool SHRINK_ON_LOOKUP = false;
+
+        static inline const Prs::tpsPr<implem::stripe*, size_t>
+            find_stripe(implem::stripe* stripePtr,
+                        const implem::stripe_occupancy& occupancy,
+                        const size_t smIndex,
+                        const bool){
+            return implem::find_stripe_from_adjd_index(stripePtr, occupancy, smIndex);
+        };
+        static inline size_t
+            find_slot(implem::stripe* stripePtr,
+                      const implem::stripe_occupancy& occupancy,
+                      const size_t smIndex,
+                      const bool){
+            return implem::find_adjd_index(stripePtr, occupancy, smIndex);
+        };
+    };
+    ///Shrinks before any index lookup so indices are always direct slots
+    ///--- ( Each lookup after an add/erase pays a full shrink - for build once, read many maps )
+    ///--- ( While deferred erase holds tombstones the map is not shrunk, so a gapped map walks stripes until compact() )
+    struct index_shrunk : index_adaptive
+    {
+        static constexpr bool SHRINK_ON_LOOKUP = true;
+    };
+
+    ///STORAGE POLICIES
+    ///--- ( items<V> is the slot store - see implem::items_aos for the expected interface )
+    ///--- ( Key is the stored key type - uint16_t/uint32_t keys shrink slots when V is small, depth is clamped to Key )
+
+    ///Key and value side by side ( default - whole items handed out as Prs::tpsPr<Key, V>& )
+    template <typename Key = size_t>
+    struct storage_aos
+    {
+        template <typename V>
+        using items = implem::items_aos<V, Key>;
+    };
+    ///Keys and values in parallel arrays ( key range scans touch keys only - items handed out as implem::item_ref<V, Key> )
+    template <typename Key = size_t>
+    struct storage_soa
+    {
+        template <typename V>
+        using items = implem::items_soa<V, Key>;
+    };
+    ///Key/value pairs plus HotProj{}(value) copied inline ( e.g. a functor returning { x, y, w } of a Rect* )
+    ///--- ( query_hot() / query_bounded_hot() test the copy first - items handed out as implem::hot_item& with _1, _hot and _2 )
+    template <typename HotProj, typename Key = size_t>
+    struct storage_hot
+    {
+        template <typename V>
+        using items = implem::items_hot<V, HotProj, Key>;
+    };
+    ///Values only, key computed by Proj{}(value) ( e.g. a functor returning rect->x - items handed out as implem::item_ref<V, Key> )
+    ///--- ( Add with add(value) - the key is never stored, so it must not change while the value is held )
+    template <typename Proj, typename Key = size_t>
+    struct storage_projected
+    {
+        template <typename V>
+        using items = implem::items_projected<V, Proj, Key>;
+    };
+
+    ///Storage plus a generational handle per item ( add(item, handle), get(handle), erase(handle) and update_key(handle, key) in O(1) )
+    ///--- ( Storage must keep its keys - not storage_projected or storage_mapped - and costs 4 more bytes per slot )
+    template <typename Storage = storage_aos<>>
+    struct storage_handles
+    {
+        template <typename V>
+        using items = implem::items_handled<typename Storage::template items<V>>;
+    };
+    #if SMAP_HAS_MMAP
+    ///Key/value pairs in a sparse file mapped from Dir{}() ( out of core - resident memory follows the stripes visited )
+    ///--- ( Restripe and shrink resize the mapping in place - V must be trivially copyable, see implem::items_mapped )
+    template <typename Key = size_t, typename Dir = implem::mapped_dir_env>
+    struct storage_mapped
+    {
+        template <typename V>
+        using items = implem::items_mapped<V, Dir, Key>;
+    };
+    #endif
+
+    ///BOUNDS POLICIES
+    ///--- ( Per-stripe secondary-axis bounds for query_bounded() culling - projections are functors inlined into every add )
+
+    ///No secondary bounds ( default - query_bounded() behaves as query() and query_margin() is 0 )
+    struct bounds_none
+    {
+        static constexpr bool TRACKED = false;
+    };
+    ///Min/max of Sec{}(value) and max of Ext{}(value) per stripe ( e.g. functors returning rect->y and rect->w )
+    ///--- ( Bounds live in a cold array beside the stripes - erase only leaves them loose, shrink() recomputes them )
+    template <typename Sec, typename Ext>
+    struct bounds_tracked
+    {
+        static constexpr bool TRACKED = true;
+
+        template <typename V>
+        static inline int64_t
+            sec(const V& value){
+            return static_cast<int64_t>(Sec{}(value));
+        };
+        template <typename V>
+        static inline int64_t
+            ext(const V& value){
+            return static_cast<int64_t>(Ext{}(value));
+        };
+    };
+
+    ///Streaming loader ( stripe_builder.hpp )
+    template <typename Map>
+    class stripe_builder;
+    ///Shared memory publication ( stripe_shared.hpp )
+    template <typename Map>
+    class stripe_publisher;
+    template <typename Map>
+    class stripe_reader;
+
     ///-------------------------------------------------------------------------------------------------------
     ///BEGIN OF STRIPE_MAP CLASS
-    template <typename V>
+    ///--- ( Defaults keep classic behaviour : doubling growth, adaptive indexing, key/value pairs side by side )
+    template <typename V,
+              typename GrowthPolicy  = growth_double,
+              typename IndexPolicy   = index_adaptive,
+              typename StoragePolicy = storage_aos<>,
+              typename BoundsPolicy  = bounds_none>
     class stripe_map
     {
         struct iterator;
 
+        template <typename Map>
+        friend class stripe_builder;
+        template <typename Map>
+        friend class stripe_publisher;
+        template <typename Map>
+        friend class stripe_reader;
+
+        typedef typename StoragePolicy::template items<V> item_store;
+
         public:
+            typedef typename item_store::key_type key_type;          ///< stored key type ( per StoragePolicy )
+            typedef Prs::tpsPr<key_type, V> value_type;              ///< key/value pair as added and iterated
+            typedef typename item_store::item_type item_type;        ///< what add() and load() take ( value_type, or V with key projecting storage )
+            typedef implem::stripe_handle handle_type;               ///< generational item handle ( storage_handles )
+
             ///MAKE STRIPE_MAP
             stripe_map(const size_t depthMax = implem::SMAP_INIT_MAX_DEPTH,
                        const size_t stripeAmnt = implem::SMAP_INIT_STRIPE_AMOUNT,
@@ -778,7 +2725,10 @@ namespace qmap
             ///CLEANUP
             virtual ~stripe_map()
             {
-                (this->*_smap_close_func_)();
+                if ( _smap_is_reserved )
+                    close_used();
+
+                _smap_handles.release();
             };
 
             ///-------------------------------------------------------------------------------------------------------
@@ -787,37 +2737,205 @@ namespace qmap
             ///Add to the stripe_map
             ///--- ( COPY ADD )
             inline bool
-                add(const Prs::tpsPr<size_t, V>& aItem)
+                add(const value_type& aItem)
+            {
+                static_assert(!item_store::PROJECTED, "key projecting storage adds values through add(value)");
+
+                const key_type key = aItem._1;
+                auto attemptadd = attempt_add(key);
+
+                if ( !attemptadd._1 )
+                    return false;
+
+                _smap_items.put(attemptadd._2, aItem);
+                bound_added(key, attemptadd._2);
+
+                return true;
+            };
+            ///Add to the stripe_map
+            ///--- ( MOVE ADD )
+            inline bool
+                add(value_type&& aItem)
+            {
+                static_assert(!item_store::PROJECTED, "key projecting storage adds values through add(value)");
+
+                const key_type key = aItem._1;
+                auto attemptadd = attempt_add(key);
+
+                if ( !attemptadd._1 )
+                    return false;
+
+                _smap_items.put(attemptadd._2, std::move(aItem));
+                bound_added(key, attemptadd._2);
+
+                return true;
+            };
+            ///Add value built from args straight into its slot at key ( no value_type temporary )
+            ///--- ( EMPLACE ADD - one construction of V per insert, see implem::emplace_value )
+            template <typename... Args>
+            inline bool
+                emplace(const key_type key,
+                        Args&&... args)
+            {
+                static_assert(!item_store::PROJECTED, "key projecting storage adds values through add(value)");
+
+                auto attemptadd = attempt_add(key);
+
+                if ( !attemptadd._1 )
+                    return false;
+
+                _smap_items.emplace(attemptadd._2, key, std::forward<Args>(args)...);
+                bound_added(key, attemptadd._2);
+
+                return true;
+            };
+            ///Add to the stripe_map and issue handle to the item ( handle follows it through erase swaps, restripe and shrink )
+            ///--- ( COPY ADD - HANDLED STORAGE ONLY )
+            inline bool
+                add(const value_type& aItem,
+                    handle_type& handle)
+            {
+                static_assert(item_store::HANDLED, "add(item, handle) needs handled storage ( storage_handles )");
+
+                const key_type key = aItem._1;
+                auto attemptadd = attempt_add(key);
+
+                if ( !attemptadd._1 )
+                    return false;
+
+                _smap_items.put(attemptadd._2, aItem);
+                bound_added(key, attemptadd._2);
+                handle = issue_handle(attemptadd._2);
+
+                return true;
+            };
+            ///Add to the stripe_map and issue handle to the item ( handle follows it through erase swaps, restripe and shrink )
+            ///--- ( MOVE ADD - HANDLED STORAGE ONLY )
+            inline bool
+                add(value_type&& aItem,
+                    handle_type& handle)
+            {
+                static_assert(item_store::HANDLED, "add(item, handle) needs handled storage ( storage_handles )");
+
+                const key_type key = aItem._1;
+                auto attemptadd = attempt_add(key);
+
+                if ( !attemptadd._1 )
+                    return false;
+
+                _smap_items.put(attemptadd._2, std::move(aItem));
+                bound_added(key, attemptadd._2);
+                handle = issue_handle(attemptadd._2);
+
+                return true;
+            };
+            ///Add value keyed by its projection
+            ///--- ( COPY ADD - KEY PROJECTING STORAGE ONLY )
+            inline bool
+                add(const V& value)
             {
-                auto attemptadd = attempt_add(aItem);
+                static_assert(item_store::PROJECTED, "add(value) needs key projecting storage ( storage_projected )");
+
+                const size_t key = item_store::project(value);
+                auto attemptadd = attempt_add(key);
 
                 if ( !attemptadd._1 )
                     return false;
 
-                _smap_items[attemptadd._2] = aItem;
+                _smap_items.put(attemptadd._2, value);
+                bound_added(key, attemptadd._2);
 
                 return true;
             };
-            ///Add to the stripe_map
-            ///--- ( MOVE ADD )
+            ///Add value keyed by its projection
+            ///--- ( MOVE ADD - KEY PROJECTING STORAGE ONLY )
             inline bool
-                add(Prs::tpsPr<size_t, V>&& aItem)
+                add(V&& value)
             {
-                auto attemptadd = attempt_add(aItem);
+                static_assert(item_store::PROJECTED, "add(value) needs key projecting storage ( storage_projected )");
+
+                const size_t key = item_store::project(value);
+                auto attemptadd = attempt_add(key);
 
                 if ( !attemptadd._1 )
                     return false;
 
-                _smap_items[attemptadd._2] = std::move(aItem);
+                _smap_items.put(attemptadd._2, std::move(value));
+                bound_added(key, attemptadd._2);
 
                 return true;
             };
+            ///Adds count items in one pass and leaves stripe_map shrunk - returns false and leaves it untouched if slot indices would overflow
+            ///--- ( Bulk loader : items are counted per stripe, then the shrunk layout is written once - no restripe )
+            inline bool
+                load(const item_type* items,
+                     const size_t count)
+            {
+                if ( !_smap_is_reserved )
+                    init_reserve();
+
+                size_t* counts = new size_t[_smap_stripe_stripes]();
+                for ( size_t i = 0; i < count; i++ )
+                    counts[stripe_index(key_of(items[i]))]++;
+
+                const bool loaded = merge_staged(counts,
+                                                 count,
+                                                 [&](auto&& place)
+                                                 {
+                                                     for ( size_t i = 0; i < count; i++ )
+                                                         place(stripe_index(key_of(items[i])), items[i]);
+                                                 });
+                delete[] counts;
+
+                return loaded;
+            };
             ///Shrink stripes to remove gaps and provide array of contiguous memory
             ///--- ( Any add or remove/clear operations will lose performance gain )
             inline void
                 shrink()
             {
-                (this->*_smap_shrink_func_)();
+                compact();
+
+                if ( _smap_is_reserved && !_smap_is_shrunk )
+                    shrink_map();
+            };
+            ///Removes every tombstoned item in one linear pass over the stripes holding them - returns amount removed
+            ///--- ( Survivors keep their order within each stripe, the map is left gapped - shrink() compacts then shrinks )
+            inline size_t
+                compact()
+            {   using namespace implem;
+
+                if ( _smap_tomb_count == 0 )
+                    return 0;
+
+                const size_t purged = _smap_tomb_count;
+                for ( size_t s = _smap_tomb_stripes.first(); s != stripe_occupancy::npos; s = _smap_tomb_stripes.next(s + 1) )
+                    purge_tombs(s);
+
+                _smap_tomb_stripes.clear_all();
+                _smap_items_count -= purged;
+                _smap_tomb_count   = 0;
+
+                mark_gapped();
+
+                return purged;
+            };
+            ///Switches erase(), remove(), remove_key() and remove_if() to tombstoning ( O(1) per item, nothing moves )
+            ///--- ( Shrunk index lookups stay direct until compact() or shrink() - switching off compacts right away )
+            ///--- ( Iterators step over tombstones, direct indices and query_spans() still cover them until compact() )
+            inline void
+                set_deferred_erase(const bool deferred)
+            {
+                _smap_is_deferred = deferred;
+
+                if ( !deferred )
+                    compact();
+            };
+            ///Sets how many slots ahead for_each() and range queries prefetch ( pointees of pointer values at half ) - 0 disables
+            ///--- ( Kept across reset/resize - bench with bench_containers --prefetch to tune per payload )
+            inline void
+                set_prefetch_distance(const size_t distance){
+                _smap_prefetch_dist = distance;
             };
             ///Resizes the size of stripe_map to given values and resets
             inline void
@@ -825,7 +2943,8 @@ namespace qmap
                        const size_t stripeAmnt = implem::SMAP_INIT_STRIPE_AMOUNT,
                        const size_t stripeWdth = implem::SMAP_INIT_WIDTH)
             {
-                (this->*_smap_close_func_)();
+                if ( _smap_is_reserved )
+                    close_used();
 
                 init(stripeAmnt,
                      stripeWdth,
@@ -835,10 +2954,68 @@ namespace qmap
             inline void
                 reset()
             {
-                (this->*_smap_close_func_)();
+                if ( _smap_is_reserved )
+                    close_used();
 
                 reset_values();
             };
+            ///Writes map to a snapshot file at path for open_mapped() - returns false on failure
+            ///--- ( Shrinks first - V must be trivially copyable, and pointer values only mean something to the writing process )
+            inline bool
+                save(const char* path)
+            {   using namespace implem;
+
+                snapshot_header header;
+                make_snapshot_header(header);
+
+                std::FILE* file = std::fopen(path, "wb");
+                if ( file == nullptr )
+                    return false;
+
+                bool written = std::fwrite(&header, sizeof(header), 1, file) == 1
+                            && snapshot_pad(file, header.stripes_offset)
+                            && std::fwrite(_smap_stripes, sizeof(stripe), _smap_stripe_stripes, file) == _smap_stripe_stripes;
+
+                for ( size_t a = 0; written && a < item_store::ARRAY_COUNT; a++ )
+                {
+                    const size_t arraybytes = _smap_items_count * item_store::array_stride(a);
+
+                    written = snapshot_pad(file, header.array_offset[a])
+                           && std::fwrite(_smap_items.array_data(a), 1, arraybytes, file) == arraybytes;
+                }
+                written = snapshot_pad(file, header.file_bytes) && written;
+
+                return std::fclose(file) == 0 && written;
+            };
+        #if SMAP_HAS_MMAP
+            ///Replaces contents with a snapshot written by save() - returns false and leaves map untouched on failure
+            ///--- ( Nothing is copied or parsed : stripes and items point into a private mapping and fault in on first touch )
+            ///--- ( The map stays fully usable - writes land in private page copies and never reach the file )
+            ///--- ( verifyItems also checks the item checksum, which touches every page up front )
+            inline bool
+                open_mapped(const char* path,
+                            const bool verifyItems = false)
+            {   using namespace implem;
+
+                static_assert(std::is_trivially_copyable<V>::value, "stripe_map snapshots need trivially copyable values");
+
+                const auto mapping = snapshot_map_file(path);
+                if ( mapping._1 == nullptr )
+                    return false;
+
+                if ( !attach_snapshot(static_cast<char*>(mapping._1), mapping._2, verifyItems) )
+                {
+                    snapshot_unmap_file(mapping._1, mapping._2);
+                    return false;
+                }
+
+                //Map owns the file mapping - unmapped once nothing lives in it
+                _smap_mapped       = mapping._1;
+                _smap_mapped_bytes = mapping._2;
+
+                return true;
+            };
+        #endif
             ///Iterator position erase
             inline auto
                 erase(const iterator& eraseIt)
@@ -846,94 +3023,707 @@ namespace qmap
                 const auto erasesucc = erase_item(eraseIt.sm_index);
 
                 return Prs::tpsPr<const bool, const size_t>(erasesucc,
-                                                            _smap_items_count);
+                                                            size());
+            };
+            ///Erases item of handle in O(1) - returns false if the handle no longer names a held item
+            ///--- ( HANDLED STORAGE ONLY - the stripe's last item swaps into the hole and keeps its own handle )
+            inline bool
+                erase(const handle_type& handle)
+            {
+                static_assert(item_store::HANDLED, "erase(handle) needs handled storage ( storage_handles )");
+
+                const size_t slot = handle_slot(handle);
+                if ( slot == SIZE_MAX )
+                    return false;
+
+                return erase_slot(&_smap_stripes[stripe_index(_smap_items.key(slot))], slot);
+            };
+            ///Rekeys item of handle - returns false if the handle no longer names a held item or a needed restripe failed
+            ///--- ( HANDLED STORAGE ONLY - a key in the same stripe is rewritten in place, otherwise the item moves stripes )
+            ///--- ( and keeps its handle : O(1) unless its new stripe is full and the map restripes )
+            inline bool
+                update_key(const handle_type& handle,
+                           const key_type newKey)
+            {
+                static_assert(item_store::HANDLED, "update_key(handle, key) needs handled storage ( storage_handles )");
+
+                size_t slot = handle_slot(handle);
+                if ( slot == SIZE_MAX )
+                    return false;
+
+                if ( stripe_index(_smap_items.key(slot)) == stripe_index(newKey) )
+                {
+                    _smap_items.set_key(slot, newKey);
+                    return true;
+                }
+
+                //Slot in the new stripe first - a restripe moves the item, so its slot is read back from the table
+                const auto attemptadd = attempt_add(newKey);
+                if ( !attemptadd._1 )
+                    return false;
+
+                slot = _smap_handles[handle._index]._slot;
+
+                const size_t oldstripe = stripe_index(_smap_items.key(slot));
+                _smap_items.move_within(attemptadd._2, slot);
+                _smap_items.set_key(attemptadd._2, newKey);
+                _smap_items._handles[slot] = implem::SMAP_HANDLE_NONE;
+                bound_added(newKey, attemptadd._2);
+
+                return erase_slot(&_smap_stripes[oldstripe], slot);
             };
             ///Clears all stripes of their items yet retains current size of stripe_map
             inline auto
                 clear()
             {   using namespace implem;
 
-                const auto clearsucc = clear_stripe_all(_smap_stripes);
+                const auto clearsucc = clear_stripe_all(_smap_stripes,
+                                                        _smap_occupancy);
+
+                if ( clearsucc._1 )
+                {
+                    _smap_items_count -= clearsucc._2;
+                    _smap_handles_stale = true;
+                    mark_gapped();
+                }
+
+                if ( _smap_tomb_count != 0 )
+                {
+                    _smap_tombs.clear_all();
+                    _smap_tomb_stripes.clear_all();
+                    _smap_tomb_count = 0;
+                }
+
+                if ( _smap_bounds != nullptr )
+                    for ( size_t i = 0; i < _smap_stripe_stripes; i++ )
+                        _smap_bounds[i].reset();
+
+                _smap_ext_max = 0;
+
+                return clearsucc;
+            };
+            ///Clears entire stripe at given depth
+            inline auto
+                clear_depth(const size_t depthMatch)
+            {
+                const auto clearsucc = clear_stripe(depthMatch);
+
+                return Prs::tpsPr<const bool, const size_t>(clearsucc,
+                                                            size());
+            };
+            ///Removes all items matching given value from given range
+            inline auto
+                remove(const iterator& removeBegin,
+                       const iterator& removeEnd,
+                       const V& value)
+            {
+                const auto removesuccess = remove_items(removeBegin.sm_index,
+                                                        removeEnd.sm_index,
+                                                        [&value](const auto& item)
+                                                            { return item._2 == value; });
+
+                return Prs::tpsPr<const bool, const size_t>(removesuccess,
+                                                            size());
+            };
+            ///Removes all items matching given key from given range
+            inline auto
+                remove_key(const iterator& removeBegin,
+                           const iterator& removeEnd,
+                           const size_t depthKey)
+            {
+                const auto removesuccess = remove_items(removeBegin.sm_index,
+                                                        removeEnd.sm_index,
+                                                        [depthKey](const auto& item)
+                                                            { return item._1 == depthKey; });
+
+                return Prs::tpsPr<const bool, const size_t>(removesuccess,
+                                                            size());
+            };
+            ///Removes all items matching given predicate function from given range
+            template <typename F>
+            inline auto
+                remove_if(const iterator& removeBegin,
+                          const iterator& removeEnd,
+                          F&& predicate)
+            {
+                const auto removesuccess = remove_items(removeBegin.sm_index,
+                                                        removeEnd.sm_index,
+                                                        predicate);
+
+                return Prs::tpsPr<const bool, const size_t>(removesuccess,
+                                                            size());
+            };
+
+            ///-------------------------------------------------------------------------------------------------------
+            ///LOOKUP FUNCTIONS
+
+            ///Returns item aligned with non-empty stripes ( or direct index to stripe_map while shrunk )
+            inline typename item_store::reference
+                operator[](const size_t smIndex){
+                return _smap_items[find_slot(smIndex)];
+            };
+            ///Returns value of handle's item in O(1) ( nullptr if the handle no longer names a held item - HANDLED STORAGE ONLY )
+            inline V*
+                get(const handle_type& handle)
+            {
+                static_assert(item_store::HANDLED, "get(handle) needs handled storage ( storage_handles )");
+
+                const size_t slot = handle_slot(handle);
+                if ( slot == SIZE_MAX )
+                    return nullptr;
+
+                return &_smap_items.value(slot);
+            };
+            ///Calls func on every item in stripe order - returns amount of items passed to func
+            ///--- ( Unlike begin()/end() iteration, slots and pointees are prefetched prefetch_distance() ahead )
+            template <typename F>
+            inline size_t
+                for_each(F&& func)
+            {   using namespace implem;
+
+                if ( _smap_items_count == 0 )
+                    return 0;
+
+                //File backed items are read front to back - readahead grows and scanned pages are dropped first
+                if constexpr ( item_store::FILE_BACKED )
+                    _smap_items.advise_sequential(true);
+
+                size_t found = 0;
+                for ( size_t s = _smap_occupancy.next(0), next;
+                      s != stripe_occupancy::npos;
+                      s = next )
+                {
+                    next = _smap_occupancy.next(s + 1);
+
+                    found += scan_stripe<false>(s,
+                                                next,
+                                                0,
+                                                0,
+                                                [&](const size_t i){ func(_smap_items[i]); });
+                }
+
+                if constexpr ( item_store::FILE_BACKED )
+                    _smap_items.advise_sequential(false);
+
+                return found;
+            };
+            ///Calls func on every item with key within [depthMin, depthMax] - returns amount of items passed to func
+            ///--- ( Jumps straight to the stripe holding depthMin and only visits stripes covering the range )
+            template <typename F>
+            inline size_t
+                query(const size_t depthMin,
+                      const size_t depthMax,
+                      F&& func)
+            {
+                return query_slots(depthMin,
+                                   depthMax,
+                                   [&func](const size_t, auto&& item){ func(item); });
+            };
+            ///Calls func(slotIndex, item) on every item with key within [depthMin, depthMax] - returns amount of items passed to func
+            ///--- ( Slot indices hold until the next add/erase/shrink - while shrunk they run 0..size() in stripe order )
+            template <typename F>
+            inline size_t
+                query_slots(const size_t depthMin,
+                            const size_t depthMax,
+                            F&& func)
+            {   using namespace implem;
+
+                if ( _smap_items_count == 0 || depthMin > depthMax )
+                    return 0;
+
+                const size_t stripefirst = find_stripe_jump_depth(_smap_stripes, depthMin,
+                                                                  _smap_depth_max, _smap_stripe_stripes) - _smap_stripes;
+                const size_t stripelast  = find_stripe_jump_depth(_smap_stripes, depthMax,
+                                                                  _smap_depth_max, _smap_stripe_stripes) - _smap_stripes;
+                size_t found = 0;
+                //Only occupied stripes are visited
+                for ( size_t s = _smap_occupancy.next(stripefirst), next;
+                      s != stripe_occupancy::npos && s <= stripelast;
+                      s = next )
+                {
+                    next = _smap_occupancy.next(s + 1);
+
+                    found += scan_stripe<true>(s,
+                                               next <= stripelast ? next : stripe_occupancy::npos,
+                                               depthMin,
+                                               depthMax,
+                                               [&](const size_t i){ func(i, _smap_items[i]); });
+                }
+
+                return found;
+            };
+            ///Calls func(slotBegin, slotEnd) once per occupied stripe covering [depthMin, depthMax] - returns amount of slots spanned
+            ///--- ( Keys inside a span are NOT filtered - spans are whole stripes for batch tests over contiguous slots )
+            ///--- ( Spans also cover tombstoned slots until compact() - see set_deferred_erase() )
+            template <typename F>
+            inline size_t
+                query_spans(const size_t depthMin,
+                            const size_t depthMax,
+                            F&& func)
+            {   using namespace implem;
+
+                if ( _smap_items_count == 0 || depthMin > depthMax )
+                    return 0;
+
+                const size_t stripefirst = find_stripe_jump_depth(_smap_stripes, depthMin,
+                                                                  _smap_depth_max, _smap_stripe_stripes) - _smap_stripes;
+                const size_t stripelast  = find_stripe_jump_depth(_smap_stripes, depthMax,
+                                                                  _smap_depth_max, _smap_stripe_stripes) - _smap_stripes;
+                size_t spanned = 0;
+                for ( size_t s = _smap_occupancy.next(stripefirst);
+                      s != stripe_occupancy::npos && s <= stripelast;
+                      s = _smap_occupancy.next(s + 1) )
+                {
+                    stripe* stripeptr = &_smap_stripes[s];
+
+                    func(size_t(stripeptr->get_start()), size_t(stripeptr->get_position()));
+                    spanned += stripeptr->used();
+                }
+
+                return spanned;
+            };
+            ///Calls func on every item whose key falls in any of the given inclusive ranges
+            ///--- ( RANGES MUST BE SORTED AND NON-OVERLAPPING - EACH STRIPE IS SCANNED AT MOST ONCE )
+            template <typename F>
+            inline size_t
+                query_ranges(const Prs::tpsPr<size_t, size_t>* ranges,
+                             const size_t rangeCount,
+                             F&& func)
+            {   using namespace implem;
+
+                if ( _smap_items_count == 0 || rangeCount == 0 )
+                    return 0;
+
+                size_t found = 0;
+                size_t rangeindex = 0;
+                stripe* stripeptr = find_stripe_jump_depth(_smap_stripes, ranges[0]._1,
+                                                           _smap_depth_max, _smap_stripe_stripes);
+                while ( stripeptr != nullptr && rangeindex < rangeCount )
+                {
+                    const size_t stripedepth = stripeptr->get_depth();
+                    const size_t stripeend   = stripeptr->get_depth_end();
+
+                    //Drop ranges that ended before this stripe
+                    while ( rangeindex < rangeCount && ranges[rangeindex]._2 < stripedepth )
+                        rangeindex++;
+                    if ( rangeindex == rangeCount )
+                        break;
+
+                    //Next range starts past this stripe - jump straight to its stripe
+                    if ( ranges[rangeindex]._1 >= stripeend )
+                    {
+                        stripeptr = find_stripe_jump_depth(_smap_stripes, ranges[rangeindex]._1,
+                                                           _smap_depth_max, _smap_stripe_stripes);
+                        continue;
+                    }
+
+                    //Ranges [rangeindex, rangelast) overlap this stripe
+                    size_t rangelast = rangeindex;
+                    while ( rangelast < rangeCount && ranges[rangelast]._1 < stripeend )
+                        rangelast++;
+
+                    const bool tombed = is_tombed_stripe(stripeptr - _smap_stripes);
+                    for ( size_t i = stripeptr->get_start(); i < stripeptr->get_position(); i++ )
+                    {
+                        if ( tombed && _smap_tombs.test(i) )
+                            continue;
+
+                        const size_t key = _smap_items.key(i);
+
+                        //Last range starting at or before key
+                        size_t lo = rangeindex;
+                        size_t hi = rangelast;
+                        while ( hi - lo > 1 )
+                        {
+                            const size_t mid = ( lo + hi ) >> 1;
+                            if ( ranges[mid]._1 <= key )
+                                lo = mid;
+                            else
+                                hi = mid;
+                        }
+
+                        if ( key < ranges[lo]._1 || key > ranges[lo]._2 )
+                            continue;
+
+                        func(_smap_items[i]);
+                        found++;
+                    }
+
+                    //Jump to next occupied stripe
+                    const size_t nextstripe = _smap_occupancy.next(( stripeptr - _smap_stripes ) + 1);
+                    stripeptr = nextstripe != stripe_occupancy::npos ? &_smap_stripes[nextstripe] : nullptr;
+                }
+
+                return found;
+            };
+            ///Calls func on every item a probe of half extent moving from keyStart to keyEnd passes over this frame - returns amount passed to func
+            ///--- ( Covers exactly [min - extent, max + extent] of the swept keys, visiting occupied stripes in travel order )
+            ///--- ( func(item) or func(item, tEntry) - tEntry in [0, 1] is when the probe first reaches item's key at constant velocity )
+            ///--- ( extent should include query_margin() / 2 when held items have extents of their own )
+            template <typename F>
+            inline size_t
+                query_swept(const size_t keyStart,
+                            const size_t keyEnd,
+                            const size_t extent,
+                            F&& func)
+            {   using namespace implem;
+
+                if ( _smap_items_count == 0 )
+                    return 0;
+
+                const bool forward   = keyEnd >= keyStart;
+                const size_t sweepmin = forward ? keyStart : keyEnd;
+                const size_t sweepmax = forward ? keyEnd : keyStart;
+                const size_t depthmin = sweepmin > extent ? sweepmin - extent : 0;
+                const size_t depthmax = sweepmax < SIZE_MAX - extent ? sweepmax + extent : SIZE_MAX;
+                const double travel   = double(sweepmax - sweepmin);
+
+                //Time the probe's leading edge reaches key ( 0 if already overlapping at the start )
+                const auto entry = [&](const size_t key)
+                {
+                    if ( travel == 0.0 )
+                        return 0.0;
+
+                    const double gap = forward ? double(key) - double(extent) - double(keyStart)
+                                               : double(keyStart) - double(extent) - double(key);
+
+                    return gap > 0.0 ? std::min(gap / travel, 1.0) : 0.0;
+                };
+                const auto visit = [&](const size_t i)
+                {
+                    if constexpr ( std::is_invocable<F&, typename item_store::reference, double>::value )
+                        func(_smap_items[i], entry(_smap_items.key(i)));
+                    else
+                        func(_smap_items[i]);
+                };
+
+                const size_t stripefirst = stripe_index(depthmin);
+                const size_t stripelast  = stripe_index(depthmax);
+                size_t found = 0;
+                if ( forward )
+                {
+                    for ( size_t s = _smap_occupancy.next(stripefirst), next;
+                          s != stripe_occupancy::npos && s <= stripelast;
+                          s = next )
+                    {
+                        next = _smap_occupancy.next(s + 1);
+
+                        found += scan_stripe<true>(s,
+                                                   next <= stripelast ? next : stripe_occupancy::npos,
+                                                   depthmin,
+                                                   depthmax,
+                                                   visit);
+                    }
+                }
+                else
+                {
+                    for ( size_t s = _smap_occupancy.prev(stripelast), next;
+                          s != stripe_occupancy::npos && s >= stripefirst;
+                          s = next )
+                    {
+                        next = s != 0 ? _smap_occupancy.prev(s - 1) : stripe_occupancy::npos;
+
+                        found += scan_stripe<true>(s,
+                                                   next != stripe_occupancy::npos && next >= stripefirst ? next : stripe_occupancy::npos,
+                                                   depthmin,
+                                                   depthmax,
+                                                   visit);
+                    }
+                }
+
+                return found;
+            };
+            ///Calls func(rangeIndex, item) for every range of ranges holding item's key - returns amount of calls to func
+            ///--- ( Ranges may overlap and come in any order - they are sorted by start unless already sorted, then one merge )
+            ///--- ( sweep visits each occupied stripe covered by any range once and tests its items against the ranges active there )
+            template <typename F>
+            inline size_t
+                query_batch(const Prs::tpsPr<size_t, size_t>* ranges,
+                            const size_t rangeCount,
+                            F&& func)
+            {   using namespace implem;
+
+                if ( _smap_items_count == 0 || rangeCount == 0 )
+                    return 0;
+
+                //Range indices by start, then the ranges overlapping the current stripe
+                size_t* order  = new size_t[rangeCount * 2];
+                size_t* active = order + rangeCount;
+
+                bool sorted = true;
+                for ( size_t r = 0; r < rangeCount; r++ )
+                {
+                    order[r] = r;
+                    if ( r != 0 && ranges[r]._1 < ranges[r-1]._1 )
+                        sorted = false;
+                }
+                if ( !sorted )
+                    std::sort(order, order + rangeCount,
+                              [ranges](const size_t a, const size_t b){ return ranges[a]._1 < ranges[b]._1; });
+
+                size_t found       = 0;
+                size_t activecount = 0;
+                size_t nextrange   = 0;
+                size_t s = _smap_occupancy.next(stripe_index(ranges[order[0]]._1));
+                while ( s != stripe_occupancy::npos )
+                {
+                    const size_t stripedepth = _smap_stripes[s].get_depth();
+                    const size_t stripeend   = _smap_stripes[s].get_depth_end();
+
+                    //Drop ranges that ended before this stripe, then take in those starting inside it
+                    size_t kept = 0;
+                    for ( size_t a = 0; a < activecount; a++ )
+                    {
+                        if ( ranges[active[a]]._2 >= stripedepth )
+                            active[kept++] = active[a];
+                    }
+                    activecount = kept;
+
+                    while ( nextrange < rangeCount && ranges[order[nextrange]]._1 < stripeend )
+                    {
+                        const size_t r = order[nextrange++];
+                        if ( ranges[r]._2 >= stripedepth && ranges[r]._1 <= ranges[r]._2 )
+                            active[activecount++] = r;
+                    }
+
+                    //Nothing open here - jump straight to the stripe of the next range
+                    if ( activecount == 0 )
+                    {
+                        if ( nextrange == rangeCount )
+                            break;
+
+                        s = _smap_occupancy.next(stripe_index(ranges[order[nextrange]]._1));
+                        continue;
+                    }
+
+                    const size_t next = _smap_occupancy.next(s + 1);
+                    scan_stripe<false>(s,
+                                       next,
+                                       0,
+                                       0,
+                                       [&](const size_t i)
+                                       {
+                                           const size_t key = _smap_items.key(i);
+                                           for ( size_t a = 0; a < activecount; a++ )
+                                           {
+                                               const auto& range = ranges[active[a]];
+                                               if ( key < range._1 || key > range._2 )
+                                                   continue;
+
+                                               func(active[a], _smap_items[i]);
+                                               found++;
+                                           }
+                                       });
+                    s = next;
+                }
+
+                delete[] order;
+
+                return found;
+            };
+            ///Calls func(item, distance) on the k items nearest depthKey by distanceFn(item), nearest first - returns amount passed to func
+            ///--- ( Starts at the stripe holding depthKey and grows outward, always taking the occupied stripe whose key gap is smaller )
+            ///--- ( Stops once that gap reaches the k-th best distance, so distanceFn must never be below |key - depthKey| )
+            ///--- ( e.g. Euclidean distance of 2D payloads keyed by x - a max-heap keeps the best k meanwhile )
+            template <typename D, typename F>
+            inline size_t
+                nearest(const size_t depthKey,
+                        size_t k,
+                        D&& distanceFn,
+                        F&& func)
+            {   using namespace implem;
+
+                typedef std::decay_t<decltype(distanceFn(_smap_items[0]))> dist_type;
+                typedef Prs::tpsPr<dist_type, size_t> candidate;
+
+                if ( _smap_items_count == 0 || k == 0 )
+                    return 0;
+                if ( k > _smap_items_count )
+                    k = _smap_items_count;
+
+                candidate* best = new candidate[k];
+                size_t bestcount = 0;
+                const auto worse = [](const candidate& a, const candidate& b){ return a._1 < b._1; };
+
+                const auto consider = [&](const size_t s)
+                {
+                    scan_stripe<false>(s,
+                                       stripe_occupancy::npos,
+                                       0,
+                                       0,
+                                       [&](const size_t i)
+                                       {
+                                           const dist_type dist = distanceFn(_smap_items[i]);
+                                           if ( bestcount < k )
+                                           {
+                                               best[bestcount++] = candidate(dist, i);
+                                               std::push_heap(best, best + bestcount, worse);
+                                           }
+                                           else if ( dist < best[0]._1 )
+                                           {
+                                               std::pop_heap(best, best + k, worse);
+                                               best[k - 1] = candidate(dist, i);
+                                               std::push_heap(best, best + k, worse);
+                                           }
+                                       });
+                };
+
+                const size_t stripehome = stripe_index(depthKey);
+                size_t below = stripehome != 0 ? _smap_occupancy.prev(stripehome - 1) : stripe_occupancy::npos;
+                size_t above = _smap_occupancy.next(stripehome + 1);
 
-                if ( clearsucc._1 )
-                    _smap_items_count -= clearsucc._2;
+                if ( _smap_occupancy.test(stripehome) )
+                    consider(stripehome);
 
-                return clearsucc;
-            };
-            ///Clears entire stripe at given depth
-            inline auto
-                clear_depth(const size_t depthMatch)
-            {
-                const auto clearsucc = clear_stripe(depthMatch);
+                while ( below != stripe_occupancy::npos || above != stripe_occupancy::npos )
+                {
+                    //Key gap from depthKey to the nearest key each side's next stripe can hold
+                    size_t gapbelow = SIZE_MAX;
+                    if ( below != stripe_occupancy::npos )
+                    {
+                        const size_t belowend = _smap_stripes[below].get_depth_end();
+                        gapbelow = depthKey >= belowend ? depthKey - ( belowend - 1 ) : 0;
+                    }
+                    size_t gapabove = SIZE_MAX;
+                    if ( above != stripe_occupancy::npos )
+                    {
+                        const size_t abovedepth = _smap_stripes[above].get_depth();
+                        gapabove = abovedepth > depthKey ? abovedepth - depthKey : 0;
+                    }
 
-                return Prs::tpsPr<const bool, const size_t>(clearsucc,
-                                                            _smap_items_count);
-            };
-            ///Removes all items matching given value from given range
-            inline auto
-                remove(const iterator& removeBegin,
-                       const iterator& removeEnd,
-                       const V& value)
-            {
-                const auto removesuccess = remove_items(removeBegin.sm_index,
-                                                        removeEnd.sm_index,
-                                                        [value](const Prs::tpsPr<size_t, V>& item)
-                                                            { return item._2 == value; });
+                    const bool takebelow = gapbelow <= gapabove;
+                    if ( bestcount == k && !( dist_type(takebelow ? gapbelow : gapabove) < best[0]._1 ) )
+                        break;
 
-                return Prs::tpsPr<const bool, const size_t>(removesuccess,
-                                                            _smap_items_count);
-            };
-            ///Removes all items matching given key from given range
-            inline auto
-                remove_key(const iterator& removeBegin,
-                           const iterator& removeEnd,
-                           const size_t depthKey)
-            {
-                const auto removesuccess = remove_items(removeBegin.sm_index,
-                                                        removeEnd.sm_index,
-                                                        [depthKey](const Prs::tpsPr<size_t, V>& item)
-                                                            { return item._1 == depthKey; });
+                    if ( takebelow )
+                    {
+                        consider(below);
+                        below = below != 0 ? _smap_occupancy.prev(below - 1) : stripe_occupancy::npos;
+                    }
+                    else
+                    {
+                        consider(above);
+                        above = _smap_occupancy.next(above + 1);
+                    }
+                }
 
-                return Prs::tpsPr<const bool, const size_t>(removesuccess,
-                                                            _smap_items_count);
+                std::sort_heap(best, best + bestcount, worse);
+                for ( size_t b = 0; b < bestcount; b++ )
+                    func(_smap_items[best[b]._2], best[b]._1);
+
+                delete[] best;
+
+                return bestcount;
             };
-            ///Removes all items matching given predicate function from given range
+            ///Calls func on every item with key within [depthMin, depthMax] held by a stripe whose bounds reach [secMin, secMax]
+            ///--- ( Whole stripes are skipped on secondary bounds - func still performs the exact test )
+            ///--- ( Secondary range should already include the probe's own half extent )
+            ///--- ( With bounds_none this behaves as query() )
             template <typename F>
-            inline auto
-                remove_if(const iterator& removeBegin,
-                          const iterator& removeEnd,
-                          F&& predicate)
-            {
-                const auto removesuccess = remove_items(removeBegin.sm_index,
-                                                        removeEnd.sm_index,
-                                                        predicate);
+            inline size_t
+                query_bounded(const size_t depthMin,
+                              const size_t depthMax,
+                              const int64_t secMin,
+                              const int64_t secMax,
+                              F&& func)
+            {   using namespace implem;
 
-                return Prs::tpsPr<const bool, const size_t>(removesuccess,
-                                                            _smap_items_count);
+                if constexpr ( !BoundsPolicy::TRACKED )
+                    return query(depthMin, depthMax, func);
+
+                if ( _smap_items_count == 0 || depthMin > depthMax )
+                    return 0;
+
+                const size_t stripefirst = find_stripe_jump_depth(_smap_stripes, depthMin,
+                                                                  _smap_depth_max, _smap_stripe_stripes) - _smap_stripes;
+                const size_t stripelast  = find_stripe_jump_depth(_smap_stripes, depthMax,
+                                                                  _smap_depth_max, _smap_stripe_stripes) - _smap_stripes;
+                size_t found = 0;
+                for ( size_t s = _smap_occupancy.next(stripefirst), next;
+                      s != stripe_occupancy::npos && s <= stripelast;
+                      s = next )
+                {
+                    next = _smap_occupancy.next(s + 1);
+                    if ( !_smap_bounds[s].overlap(secMin, secMax) )
+                        continue;
+
+                    found += scan_stripe<true>(s,
+                                               next <= stripelast ? next : stripe_occupancy::npos,
+                                               depthMin,
+                                               depthMax,
+                                               [&](const size_t i){ func(_smap_items[i]); });
+                }
+
+                return found;
             };
 
-            ///-------------------------------------------------------------------------------------------------------
-            ///LOOKUP FUNCTIONS
+            ///Calls func on every item with key within [depthMin, depthMax] whose hot projection passes test - returns amount passed to func
+            ///--- ( HOT STORAGE ONLY - test(const hot_type&) runs on the inline copy so rejected values are never dereferenced )
+            template <typename T, typename F>
+            inline size_t
+                query_hot(const size_t depthMin,
+                          const size_t depthMax,
+                          T&& test,
+                          F&& func)
+            {
+                static_assert(item_store::HOT, "query_hot() needs hot field storage ( storage_hot )");
 
-            ///Returns item aligned with non-empty stripes ( or direct index to stripe_map while shrunk )
-            inline Prs::tpsPr<size_t, V>&
-                operator[](const size_t smIndex)
-            {   using namespace implem;
+                size_t passed = 0;
+                query_slots(depthMin,
+                            depthMax,
+                            [&](const size_t, auto& item)
+                            {
+                                if ( !test(item._hot) )
+                                    return;
 
-                if ( _smap_is_shrunk )
-                    return _smap_items[smIndex];
+                                func(item);
+                                passed++;
+                            });
 
-                return _smap_items[find_adjd_index(_smap_stripes,
-                                                   smIndex)];
+                return passed;
+            };
+            ///query_bounded() that tests each candidate's hot projection before func - returns amount passed to func
+            ///--- ( HOT STORAGE ONLY )
+            template <typename T, typename F>
+            inline size_t
+                query_bounded_hot(const size_t depthMin,
+                                  const size_t depthMax,
+                                  const int64_t secMin,
+                                  const int64_t secMax,
+                                  T&& test,
+                                  F&& func)
+            {
+                static_assert(item_store::HOT, "query_bounded_hot() needs hot field storage ( storage_hot )");
+
+                size_t passed = 0;
+                query_bounded(depthMin,
+                              depthMax,
+                              secMin,
+                              secMax,
+                              [&](auto& item)
+                              {
+                                  if ( !test(item._hot) )
+                                      return;
+
+                                  func(item);
+                                  passed++;
+                              });
+
+                return passed;
             };
 
             ///-------------------------------------------------------------------------------------------------------
             ///INFO FUNCTIONS
 
-            ///Current stored items(slots used) in stripe_map
+            ///Current stored items(slots used) in stripe_map ( tombstoned items excluded )
             inline size_t
                 size(){
-                return _smap_items_count;
+                return _smap_items_count - _smap_tomb_count;
+            };
+            ///Tombstoned items waiting for compact()
+            inline size_t
+                tombstones(){
+                return _smap_tomb_count;
             };
             ///Current total slot count in stripe_map
             inline size_t
@@ -955,10 +3745,26 @@ namespace qmap
                 depthmax(){
                 return _smap_depth_max;
             }
-            ///Stripe_map begin iterator
+            ///Largest extent tracked since last clear/reset/shrink ( 0 with bounds_none )
+            ///--- ( Items closer than ( probe extent + query_margin() ) / 2 on the key axis may collide with probe )
+            inline int64_t
+                query_margin(){
+                return _smap_ext_max;
+            };
+            ///Slots prefetched ahead by for_each() and range queries ( 0 if disabled )
+            inline size_t
+                prefetch_distance(){
+                return _smap_prefetch_dist;
+            };
+            ///Returns true if items or stripes still live in a snapshot mapping ( open_mapped() or a stripe_reader )
+            inline bool
+                is_mapped(){
+                return _smap_items_mapped || _smap_stripes_mapped;
+            };
+            ///Stripe_map begin iterator ( iterators step over tombstoned items )
             auto
                 begin(){
-                return iterator(this, 0);
+                return iterator(this, live_index(0));
             };
             ///Stripe_map end iterator
             auto
@@ -971,19 +3777,22 @@ namespace qmap
             {   using namespace implem;
 
                 const size_t adjindex = find_start_index_adj_match_depth(_smap_stripes,
+                                                                         _smap_occupancy,
                                                                          depthMatch);
 
-                return iterator(this, adjindex);
+                return iterator(this, live_index(adjindex));
             };
             ///Returns iterator to the end index of stripe matching given depthMatch
+            ///--- ( Moved past tombstones closing the stripe, to where an iterator stepping over them lands )
             auto
                 end(const size_t depthMatch)
             {   using namespace implem;
 
                 const size_t adjindex = find_end_index_adj_match_depth(_smap_stripes,
+                                                                       _smap_occupancy,
                                                                        depthMatch);
 
-                return iterator(this, adjindex);
+                return iterator(this, live_index(adjindex));
             };
 
         private:
@@ -995,9 +3804,9 @@ namespace qmap
                 using iterator_category = std::random_access_iterator_tag;
                 using difference_type   = std::ptrdiff_t;
                 using controller        = stripe_map*;
-                using value_type        = Prs::tpsPr<size_t, V>;
-                using pointer           = Prs::tpsPr<size_t, V>*;
-                using reference         = Prs::tpsPr<size_t, V>&;
+                using value_type        = typename stripe_map::value_type;
+                using pointer           = typename item_store::pointer;
+                using reference         = typename item_store::reference;
 
                 reference
                     operator*(){
@@ -1005,12 +3814,12 @@ namespace qmap
                 };
                 pointer
                     operator->(){
-                    return &(*sm_ctrl)[sm_index];
+                    return sm_ctrl->_smap_items.ptr(sm_ctrl->find_slot(sm_index));
                 };
                 iterator&
                     operator--()
                 {
-                    sm_index--;
+                    sm_index = sm_ctrl->live_index_before(sm_index);
                     return *this;
                 };
                 iterator
@@ -1023,7 +3832,7 @@ namespace qmap
                 iterator&
                     operator++()
                 {
-                    sm_index++;
+                    sm_index = sm_ctrl->live_index(sm_index + 1);
                     return *this;
                 };
                 iterator
@@ -1036,32 +3845,38 @@ namespace qmap
                 iterator&
                     operator+=(int i)
                 {
-                    iterator tmp = *this;
-                    (*this)+= i;
-                    return tmp;
+                    //Without tombstones every index below the end is an item
+                    if ( sm_ctrl->_smap_tomb_count == 0 )
+                        sm_index += i;
+                    else
+                    {
+                        for ( ; i > 0; i-- )
+                            ++(*this);
+                        for ( ; i < 0; i++ )
+                            --(*this);
+                    }
+
+                    return *this;
                 };
                 iterator
                     operator+(int i)
                 {
-                    sm_index += i;
-                    return *this;
+                    iterator tmp = *this;
+                    return tmp += i;
                 };
                 iterator&
-                    operator-=(int i)
-                {
-                    iterator tmp = *this;
-                    (*this)-= i;
-                    return tmp;
+                    operator-=(int i){
+                    return (*this) += -i;
                 };
                 iterator
                     operator-(int i)
                 {
-                    sm_index -= i;
-                    return *this;
+                    iterator tmp = *this;
+                    return tmp -= i;
                 };
                 reference
                     operator[](int i){
-                    return (*sm_ctrl)[sm_index + i];
+                    return *((*this) + i);
                 }
 
                 friend bool
@@ -1084,78 +3899,547 @@ namespace qmap
                     operator<(const iterator& a,
                               const iterator& b)
                 {
-                    return a.sm_index < b.sm_index;
-                };
+                    return a.sm_index < b.sm_index;
+                };
+
+                iterator(controller ctrl,
+                        const size_t index = 0):
+                    sm_ctrl(ctrl),
+                    sm_index(index)
+                {};
+                virtual ~iterator(){};
+
+                protected:
+                    controller sm_ctrl;
+                    size_t sm_index;
+            };
+
+            ///Calls func(slotIndex) on every slot of occupied stripe s ( keys within [depthMin, depthMax] if KeyFilter ) - returns amount passed
+            ///--- ( Prefetches slots _smap_prefetch_dist ahead and pointees of pointer values half as far, plus the first slot of nextStripe )
+            ///--- ( Hot storage skips pointee prefetch - its tests exist so rejected values are never read )
+            ///--- ( File backed storage also asks the kernel to read nextStripe's pages in while this stripe is scanned )
+            ///--- ( Tombstoned slots are skipped - only stripes marked in _smap_tomb_stripes test the slot bitmap )
+            template <bool KeyFilter, typename F>
+            inline size_t
+                scan_stripe(const size_t s,
+                            const size_t nextStripe,
+                            const size_t depthMin,
+                            const size_t depthMax,
+                            F&& func)
+            {   using namespace implem;
+
+                constexpr bool POINTEES = std::is_pointer<V>::value && !item_store::HOT;
+
+                const size_t slotbegin = _smap_stripes[s].get_start();
+                const size_t slotend   = _smap_stripes[s].get_position();
+                const size_t slotahead = _smap_prefetch_dist;
+                const size_t valahead  = slotahead >> 1;
+                const bool tombed      = is_tombed_stripe(s);
+
+                if constexpr ( item_store::FILE_BACKED )
+                {
+                    if ( nextStripe != stripe_occupancy::npos )
+                        _smap_items.advise_willneed(_smap_stripes[nextStripe].get_start(),
+                                                    _smap_stripes[nextStripe].get_position());
+                }
+
+                if ( slotahead != 0 )
+                {
+                    //Start of the next stripe lands while this one is scanned
+                    if ( nextStripe != stripe_occupancy::npos )
+                        _smap_items.prefetch(_smap_stripes[nextStripe].get_start());
+
+                    if constexpr ( POINTEES )
+                    {
+                        for ( size_t i = slotbegin; i < slotend && i < slotbegin + valahead; i++ )
+                            prefetch_pointee(_smap_items.value(i));
+                    }
+                }
+
+                size_t found = 0;
+                for ( size_t i = slotbegin; i < slotend; i++ )
+                {
+                    if ( slotahead != 0 )
+                    {
+                        if ( i + slotahead < slotend )
+                            _smap_items.prefetch(i + slotahead);
+
+                        if constexpr ( POINTEES )
+                        {
+                            if ( i + valahead < slotend )
+                                prefetch_pointee(_smap_items.value(i + valahead));
+                        }
+                    }
+
+                    if ( tombed && _smap_tombs.test(i) )
+                        continue;
+
+                    if constexpr ( KeyFilter )
+                    {
+                        const size_t key = _smap_items.key(i);
+                        if ( key < depthMin || key > depthMax )
+                            continue;
+                    }
+
+                    func(i);
+                    found++;
+                }
+
+                return found;
+            };
+            ///Returns bool for success and
+            ///--- ( WILL PERFORM RESTRIPE ON STRIPE ADD ATTEMPT FAILURE )
+            ///--- ( Slot is reserved but not yet written - callers put the item, then bound_added() )
+            inline const auto
+                attempt_add(const size_t depthKey)
+            {
+                if ( !_smap_is_reserved )
+                    init_reserve();
+
+                const auto attempt1 = find_attempt_add(depthKey);
+
+                //Add to stripe slot index viable
+                if ( attempt1._1 )
+                    return attempt1;
+
+                //If add fails, attempt to re-stripe
+                if ( !restripe() )
+                    return Prs::tpsPr<bool, size_t>(false, 0);
+
+                return find_attempt_add(depthKey);
+            };
+            ///Attempts to find stripe and request add
+            ///--- ( DOES NOT ATTEMPT TO RESTRIPE )
+            inline const auto
+                find_attempt_add(const size_t depthKey)
+            {   using namespace implem;
+
+                auto stripefind = find_stripe_jump_depth(_smap_stripes,
+                                                         depthKey,
+                                                         _smap_depth_max,
+                                                         _smap_stripe_stripes);
+
+                #if DEBUG_SMAP > 0
+                    assert(stripefind != nullptr);
+                #endif
+
+                const auto attemptadd = stripefind->add();
+
+                if ( attemptadd._1 )
+                {
+                    _smap_items_count++;
+                    _smap_occupancy.set(stripefind - _smap_stripes);
+
+                    #if DEBUG_SMAP > 1
+                        std::cout << "ADDED TO [" << attemptadd._2 << "]" << std::endl;
+                    #endif
+                };
+
+                //Returns <bool, size_t> pair for success and viable add index
+                return attemptadd;
+            };
+            ///Grows bounds of the stripe holding depthKey to include the item just written to slot ( only while tracked )
+            inline void
+                bound_added(const size_t depthKey,
+                            const size_t slotIndex)
+            {
+                if constexpr ( BoundsPolicy::TRACKED )
+                    expand_bounds(stripe_index(depthKey), _smap_items.value(slotIndex));
+            };
+            ///Grows stripe and map bounds to include value
+            inline void
+                expand_bounds(const size_t stripeIndex,
+                              const V& value)
+            {
+                const int64_t extent = BoundsPolicy::ext(value);
+
+                _smap_bounds[stripeIndex].expand(BoundsPolicy::sec(value),
+                                                 extent);
+
+                if ( extent > _smap_ext_max )
+                    _smap_ext_max = extent;
+            };
+            ///Stripe index holding depthKey
+            inline size_t
+                stripe_index(const size_t depthKey){
+                return implem::find_stripe_jump_depth(_smap_stripes, depthKey, _smap_depth_max, _smap_stripe_stripes) - _smap_stripes;
+            };
+            ///Key of an item as add() takes it
+            static inline size_t
+                key_of(const item_type& item)
+            {
+                if constexpr ( item_store::PROJECTED )
+                    return item_store::project(item);
+                else
+                    return item._1;
+            };
+            ///Value of an item as add() takes it
+            static inline const V&
+                value_of(const item_type& item)
+            {
+                if constexpr ( item_store::PROJECTED )
+                    return item;
+                else
+                    return item._2;
+            };
+            ///Writes held items plus stagedTotal new ones into a fresh shrunk layout in one pass
+            ///--- ( counts holds new items per stripe, emit(place) must call place(stripeIndex, item) exactly that often )
+            ///--- ( Returns false and leaves stripe_map untouched if slot indices would overflow stripe_index_t )
+            template <typename E>
+            inline bool
+                merge_staged(const size_t* counts,
+                             const size_t stagedTotal,
+                             E&& emit)
+            {   using namespace implem;
+
+                //Held items are read per stripe, so a gapped layout is written shrunk in the same pass
+                compact();
+
+                const size_t newtotal = _smap_items_count + stagedTotal;
+                if ( newtotal > STRIPE_INDEX_MAX )
+                    return false;
+
+                //Every stripe sized to exactly its held plus staged items
+                stripe* newstripes = new stripe[_smap_stripe_stripes];
+                size_t slotindex = 0;
+                for ( size_t s = 0; s < _smap_stripe_stripes; s++ )
+                {
+                    newstripes[s] = _smap_stripes[s];  //THIS IS NOT POINTER ASSIGNMENT
+
+                    if ( s != 0 )
+                        newstripes[s].set_stripe_prev(&newstripes[s-1]);
+                    if ( s != _smap_stripe_stripes - 1 )
+                        newstripes[s].set_stripe_next(&newstripes[s+1]);
+
+                    const size_t stripeused = newstripes[s].used();
+
+                    newstripes[s].set_stripe_start(slotindex, stripeused);
+                    newstripes[s].set_stripe_end(slotindex + stripeused + counts[s]);
+
+                    slotindex += stripeused + counts[s];
+                }
+
+                item_store newitems;
+                newitems.make(newtotal);
+
+                for ( size_t s = _smap_occupancy.first(); s != stripe_occupancy::npos; s = _smap_occupancy.next(s + 1) )
+                {
+                    const size_t oldstart = _smap_stripes[s].get_start();
+                    const size_t newstart = newstripes[s].get_start();
+                    for ( size_t i = 0; i < _smap_stripes[s].used(); i++ )
+                        newitems.move_from(newstart + i, _smap_items, oldstart + i);
+                }
+
+                emit([&](const size_t stripeIndex, auto&& item)
+                {
+                    const auto slot = newstripes[stripeIndex].add();
+
+                    if constexpr ( BoundsPolicy::TRACKED )
+                        expand_bounds(stripeIndex, value_of(item));
+
+                    newitems.put(slot._2, std::forward<decltype(item)>(item));
+                });
+
+                delete_both();
+                _smap_stripes = newstripes;
+                _smap_items   = newitems;
+
+                _smap_items_count = newtotal;
+                _smap_slots_count = newtotal;
+
+                for ( size_t s = 0; s < _smap_stripe_stripes; s++ )
+                {
+                    if ( !_smap_stripes[s].is_empty() )
+                        _smap_occupancy.set(s);
+                }
+
+                _smap_is_shrunk = true;
+
+                sweep_handles();
+
+                return true;
+            };
+            ///Takes items, holding total items sorted by stripe with counts[s] of them in stripe s, as the shrunk item array
+            ///--- ( stripe_builder finish : held items must already be moved into items - items is left empty )
+            ///--- ( Tracked bounds are rebuilt from the items, as open_mapped() does )
+            inline void
+                adopt_sorted(item_store& items,
+                             const size_t* counts,
+                             const size_t total)
+            {   using namespace implem;
+
+                delete_items();
+                _smap_items = items;
+                items       = item_store();
+
+                size_t slotindex = 0;
+                for ( size_t s = 0; s < _smap_stripe_stripes; s++ )
+                {
+                    _smap_stripes[s].set_stripe_start(slotindex, counts[s]);
+                    _smap_stripes[s].set_stripe_end(slotindex + counts[s]);
+
+                    if ( counts[s] != 0 )
+                        _smap_occupancy.set(s);
+                    else
+                        _smap_occupancy.unset(s);
+
+                    slotindex += counts[s];
+                }
+
+                _smap_items_count = total;
+                _smap_slots_count = total;
+
+                _smap_is_shrunk = true;
+
+                if constexpr ( BoundsPolicy::TRACKED )
+                    _smap_ext_max = recalc_stripe_bounds<BoundsPolicy>(_smap_items,
+                                                                       _smap_stripes,
+                                                                       _smap_bounds);
+
+                sweep_handles();
+            };
+            ///Delete entire item array ( or detach it from the snapshot mapping )
+            inline void
+                delete_items()
+            {
+                if ( !_smap_items_mapped )
+                {
+                    _smap_items.release();
+                    return;
+                }
+
+                _smap_items         = item_store();
+                _smap_items_mapped  = false;
+                release_mapping();
+            };
+            ///Delete entire stripe array ( or detach it from the snapshot mapping )
+            inline void
+                delete_stripes()
+            {
+                if ( !_smap_stripes_mapped )
+                {
+                    delete[] _smap_stripes;
+                    return;
+                }
+
+                _smap_stripes         = nullptr;
+                _smap_stripes_mapped  = false;
+                release_mapping();
+            };
+            ///Sets header fields describing this map's stripe and item store layout
+            inline void
+                fill_snapshot_layout(implem::snapshot_header& header)
+            {   using namespace implem;
+
+                header.version       = SMAP_SNAPSHOT_VERSION;
+                header.header_bytes  = sizeof(snapshot_header);
+                header.stripe_bytes  = sizeof(stripe);
+                header.key_bytes     = sizeof(key_type);
+                header.value_bytes   = sizeof(V);
+                header.storage_flags = ( item_store::PROJECTED ? 1u : 0u ) | ( item_store::HOT ? 2u : 0u );
+                header.array_count   = item_store::ARRAY_COUNT;
+
+                for ( size_t a = 0; a < item_store::ARRAY_COUNT; a++ )
+                    header.array_stride[a] = item_store::array_stride(a);
+            };
+            ///Returns true if header describes a snapshot of this map type whose sections fit in fileBytes and whose checksums match
+            inline bool
+                valid_snapshot(const implem::snapshot_header& header,
+                               const char* base,
+                               const size_t fileBytes,
+                               const bool verifyItems)
+            {   using namespace implem;
+
+                snapshot_header expect;
+                std::memset(&expect, 0, sizeof(expect));
+                fill_snapshot_layout(expect);
+
+                if ( std::memcmp(header.magic, SMAP_SNAPSHOT_MAGIC, sizeof(header.magic)) != 0
+                  || header.version       != expect.version
+                  || header.header_bytes  != expect.header_bytes
+                  || header.stripe_bytes  != expect.stripe_bytes
+                  || header.key_bytes     != expect.key_bytes
+                  || header.value_bytes   != expect.value_bytes
+                  || header.storage_flags != expect.storage_flags
+                  || header.array_count   != expect.array_count
+                  || header.file_bytes    != fileBytes )
+                    return false;
+
+                if ( header.stripe_amount == 0
+                  || header.items_count > STRIPE_INDEX_MAX
+                  || header.stripes_offset % SMAP_SNAPSHOT_ALIGN != 0
+                  || header.stripes_offset > fileBytes
+                  || header.stripe_amount > ( fileBytes - header.stripes_offset ) / sizeof(stripe) )
+                    return false;
+
+                for ( size_t a = 0; a < item_store::ARRAY_COUNT; a++ )
+                {
+                    if ( header.array_stride[a] != expect.array_stride[a]
+                      || header.array_offset[a] % SMAP_SNAPSHOT_ALIGN != 0
+                      || header.array_offset[a] > fileBytes
+                      || header.items_count > ( fileBytes - header.array_offset[a] ) / header.array_stride[a] )
+                        return false;
+                }
 
-                iterator(controller ctrl,
-                        const size_t index = 0):
-                    sm_ctrl(ctrl),
-                    sm_index(index)
-                {};
-                virtual ~iterator(){};
+                const stripe* stripes = reinterpret_cast<const stripe*>(base + header.stripes_offset);
+                if ( snapshot_directory_checksum(header, stripes, header.stripe_amount) != header.directory_checksum )
+                    return false;
 
-                protected:
-                    controller sm_ctrl;
-                    size_t sm_index;
+                if ( verifyItems )
+                {
+                    uint64_t itemsum = SMAP_SNAPSHOT_SEED;
+                    for ( size_t a = 0; a < item_store::ARRAY_COUNT; a++ )
+                        itemsum = snapshot_checksum(base + header.array_offset[a],
+                                                    header.items_count * header.array_stride[a],
+                                                    itemsum);
+
+                    if ( itemsum != header.items_checksum )
+                        return false;
+                }
+
+                return true;
             };
+            ///Shrinks map and fills header with its geometry, section offsets and checksums ( file_bytes is the snapshot size )
+            ///--- ( itemsChecksum false leaves items_checksum 0 and skips reading every item - for buffers never opened with verifyItems )
+            inline void
+                make_snapshot_header(implem::snapshot_header& header,
+                                     const bool itemsChecksum = true)
+            {   using namespace implem;
 
-            ///Returns bool for success and
-            ///--- ( WILL PERFORM RESTRIPE ON STRIPE ADD ATTEMPT FAILURE )
-            inline const auto
-                attempt_add(const Prs::tpsPr<size_t, V>& aItem)
-            {
-                (this->*_smap_init_func_)();
+                static_assert(std::is_trivially_copyable<V>::value, "stripe_map snapshots need trivially copyable values");
 
-                const auto attempt1 = find_attempt_add(aItem);
+                if ( !_smap_is_reserved )
+                    init_reserve();
 
-                //Add to stripe slot index viable
-                if ( attempt1._1 )
-                    return attempt1;
+                shrink();
 
-                //If add fails, attempt to re-stripe
-                restripe();
+                std::memset(&header, 0, sizeof(header));
+                std::memcpy(header.magic, SMAP_SNAPSHOT_MAGIC, sizeof(header.magic));
+                fill_snapshot_layout(header);
+
+                header.depth_max     = _smap_depth_max;
+                header.stripe_amount = _smap_stripe_stripes;
+                header.stripe_depth  = _smap_stripe_depth;
+                header.slots_width   = _smap_slots_width;
+                header.items_count   = _smap_items_count;
+                header.ext_max       = _smap_ext_max;
+
+                //Every section starts on its own page
+                size_t offset = snapshot_align(sizeof(header));
+                header.stripes_offset = offset;
+                offset = snapshot_align(offset + _smap_stripe_stripes * sizeof(stripe));
+
+                uint64_t itemsum = SMAP_SNAPSHOT_SEED;
+                for ( size_t a = 0; a < item_store::ARRAY_COUNT; a++ )
+                {
+                    const size_t arraybytes = _smap_items_count * item_store::array_stride(a);
 
-                return find_attempt_add(aItem);
+                    header.array_offset[a] = offset;
+                    offset = snapshot_align(offset + arraybytes);
+                    if ( itemsChecksum )
+                        itemsum = snapshot_checksum(_smap_items.array_data(a), arraybytes, itemsum);
+                }
+                header.file_bytes         = offset;
+                header.items_checksum     = itemsChecksum ? itemsum : 0;
+                header.directory_checksum = snapshot_directory_checksum(header,
+                                                                        _smap_stripes,
+                                                                        _smap_stripe_stripes);
             };
-            ///Attempts to find stripe and request add
-            ///--- ( DOES NOT ATTEMPT TO RESTRIPE )
-            inline const auto
-                find_attempt_add(const Prs::tpsPr<size_t, V>& aItem)
+            ///Copies header, stripe directory and slot arrays to dst ( header.file_bytes from make_snapshot_header - gaps are left as is )
+            inline void
+                write_snapshot(char* dst,
+                               const implem::snapshot_header& header)
+            {
+                std::memcpy(dst, &header, sizeof(header));
+                std::memcpy(dst + header.stripes_offset, _smap_stripes, _smap_stripe_stripes * sizeof(implem::stripe));
+
+                for ( size_t a = 0; a < item_store::ARRAY_COUNT; a++ )
+                    std::memcpy(dst + header.array_offset[a],
+                                _smap_items.array_data(a),
+                                _smap_items_count * item_store::array_stride(a));
+            };
+            ///Points stripes and items into a snapshot at base of fileBytes - returns false and leaves map untouched if invalid
+            ///--- ( base is not owned : the caller sets _smap_mapped if the map should unmap it, release_mapping() skips nullptr )
+            inline bool
+                attach_snapshot(char* base,
+                                const size_t fileBytes,
+                                const bool verifyItems)
             {   using namespace implem;
 
-                auto stripefind = find_stripe_jump_depth(_smap_stripes,
-                                                         aItem._1,
-                                                         _smap_depth_max);
+                static_assert(!item_store::HANDLED, "snapshots do not carry handles - open them with the unhandled storage");
 
-                #if DEBUG_SMAP > 0
-                    assert(stripefind != nullptr);
-                #endif
+                snapshot_header header;
+                std::memcpy(&header, base, sizeof(header));
 
-                const auto attemptadd = stripefind->add();
+                if ( !valid_snapshot(header, base, fileBytes, verifyItems) )
+                    return false;
 
-                if ( attemptadd._1 )
+                if ( _smap_is_reserved )
+                    close_used();
+
+                _smap_depth_max      = header.depth_max;
+                _smap_stripe_stripes = header.stripe_amount;
+                _smap_stripe_depth   = header.stripe_depth;
+                _smap_slots_width    = header.slots_width;
+                _smap_items_count    = header.items_count;
+                _smap_slots_count    = header.items_count;
+                _smap_ext_max        = header.ext_max;
+
+                _smap_stripes = reinterpret_cast<stripe*>(base + header.stripes_offset);
+                for ( size_t a = 0; a < item_store::ARRAY_COUNT; a++ )
+                    _smap_items.array_attach(a, base + header.array_offset[a]);
+
+                _smap_items_mapped    = true;
+                _smap_stripes_mapped  = true;
+
+                //Occupancy is rebuilt from the directory - items stay untouched
+                _smap_occupancy.make(_smap_stripe_stripes);
+                for ( size_t s = 0; s < _smap_stripe_stripes; s++ )
                 {
-                    _smap_items_count++;
+                    if ( _smap_stripes[s].used() != 0 )
+                        _smap_occupancy.set(s);
+                }
 
-                    #if DEBUG_SMAP > 1
-                        std::cout << "ADDED TO [" << attemptadd._2 << "]" << std::endl;
-                    #endif
-                };
+                _smap_is_reserved = true;
+                _smap_is_shrunk   = true;
 
-                //Returns <bool, size_t> pair for success and viable add index
-                return attemptadd;
+                //Tracked bounds are not stored - gathering them reads every item
+                if constexpr ( BoundsPolicy::TRACKED )
+                {
+                    make_bounds();
+                    _smap_ext_max = recalc_stripe_bounds<BoundsPolicy>(_smap_items,
+                                                                       _smap_stripes,
+                                                                       _smap_bounds);
+                }
+
+                return true;
             };
-            ///Delete entire item array
+            ///Unmaps the snapshot once neither items nor stripes live in it
             inline void
-                delete_items()
+                release_mapping()
+            {
+                if ( _smap_items_mapped || _smap_stripes_mapped )
+                    return;
+
+                #if SMAP_HAS_MMAP
+                    implem::snapshot_unmap_file(_smap_mapped, _smap_mapped_bytes);
+                #endif
+
+                _smap_mapped       = nullptr;
+                _smap_mapped_bytes = 0;
+            };
+            ///Creates empty per-stripe bounds ( stripe indices never move, so restripe keeps them )
+            inline void
+                make_bounds()
             {
-                delete[] _smap_items;
+                _smap_bounds = new implem::stripe_bounds[_smap_stripe_stripes];
             };
-            ///Delete entire stripe array
+            ///Delete per-stripe bounds
             inline void
-                delete_stripes()
+                delete_bounds()
             {
-                delete[] _smap_stripes;
+                delete[] _smap_bounds;
+                _smap_bounds = nullptr;
             };
             ///Delete entirety of both item and stripe array
             inline void
@@ -1180,6 +4464,18 @@ namespace qmap
                 if ( stripeWdth < 1 )
                     stripeWdth = 1;
 
+                #if !defined(SMAP_WIDE_STRIPES)
+                    //Stripe depths are 32 bit - keys past this still land in the last stripe
+                    if ( depthMax > size_t(STRIPE_INDEX_MAX) + 1 )
+                        depthMax = size_t(STRIPE_INDEX_MAX) + 1;
+                #endif
+                //Keys can't reach past their stored type
+                if constexpr ( sizeof(key_type) < sizeof(size_t) )
+                    if ( depthMax > size_t(key_type(~key_type(0))) + 1 )
+                        depthMax = size_t(key_type(~key_type(0))) + 1;
+                if ( stripeAmnt > depthMax )
+                    stripeAmnt = depthMax;
+
                 set_values(stripeAmnt, stripeWdth, depthMax);
             };
             ///Creates enough slots+stripes to accommodate initialization size ( performed on first add to empty map )
@@ -1191,13 +4487,17 @@ namespace qmap
                 _smap_stripes = make_init_stripes(_smap_stripe_stripes,
                                                   _smap_slots_width,
                                                   _smap_stripe_depth);
+                _smap_occupancy.make(_smap_stripe_stripes);
+
+                if constexpr ( BoundsPolicy::TRACKED )
+                    make_bounds();
             };
             ///Initializes 'newSz' amount of slots given input
             ///--- ( THIS EXPECTS SMAP_ITEMS IS CLEAR OR BEEN DELETED BEFORE USE )
             inline void
                 make_slots()
             {
-                _smap_items = new Prs::tpsPr<size_t, V>[_smap_slots_count];
+                _smap_items.make(_smap_slots_count);
             };
             ///Set internal initial values to allow space for first item insertions
             ///--- ( Allows space for items to be inserted before resize and )
@@ -1225,65 +4525,166 @@ namespace qmap
                     std::cout << "Stripe depth: " << _smap_stripe_depth << std::endl;
                 #endif
             };
-            ///Set item and slot count to init values & set internal function pointers
+            ///Set item and slot count to init values
             inline void
                 reset_values()
             {
                 _smap_items_count = 0;
                 _smap_slots_count = _smap_stripe_stripes * _smap_slots_width;
-                _smap_init_func_   = &stripe_map::init_reserve;
-                _smap_shrink_func_ = &stripe_map::func_void;
+                _smap_ext_max     = 0;
             };
             ///Restripes stripe_map
-            inline void
+            ///--- ( Returns false and leaves stripe_map untouched if slot indices would overflow stripe_index_t )
+            inline bool
                 restripe()
             {   using namespace implem;
 
-                auto newstripes = setup_new_stripes(_smap_stripes,
-                                                    _smap_stripe_stripes,
-                                                    _smap_slots_count);
+                //Tombstones would be carried into the new layout - drop them while items move anyway
+                compact();
+
+                const size_t oldslotcount = _smap_slots_count;
+
+                auto newstripes = setup_new_stripes<GrowthPolicy>(_smap_stripes,
+                                                                  _smap_stripe_stripes,
+                                                                  _smap_slots_count);
+
+                if ( _smap_slots_count > STRIPE_INDEX_MAX )
+                {
+                    delete[] newstripes;
+                    _smap_slots_count = oldslotcount;
+
+                    return false;
+                }
+
+                bool inplace = false;
+                if constexpr ( item_store::FILE_BACKED )
+                {
+                    //File backed items move inside their own mapping instead of into a second array
+                    if ( !_smap_items_mapped )
+                    {
+                        if ( !restripe_items_in_place(_smap_items,
+                                                      newstripes,
+                                                      _smap_stripes,
+                                                      _smap_stripe_stripes,
+                                                      oldslotcount,
+                                                      _smap_slots_count) )
+                        {
+                            delete[] newstripes;
+                            _smap_slots_count = oldslotcount;
+
+                            return false;
+                        }
 
-                auto newitems   = setup_new_items(_smap_items,
-                                                  newstripes,
-                                                  _smap_stripes,
-                                                  _smap_slots_count);
+                        delete_stripes();
+                        inplace = true;
+                    }
+                }
 
                 #if DEBUG_SMAP > 2
                     std::cout << "New slot count:    " << _smap_slots_count << std::endl << std::endl;
                 #endif // DEBUG_SMAP
 
-                //Delete items and stripe previous arrays
-                delete_both();
-                //Assign new items and stripes to stripe_map members
+                if ( !inplace )
+                {
+                    auto newitems = setup_new_items(_smap_items,
+                                                    newstripes,
+                                                    _smap_stripes,
+                                                    _smap_slots_count);
+
+                    //Delete items and stripe previous arrays
+                    delete_both();
+                    _smap_items = newitems;
+                }
+                //Assign new stripes to stripe_map members
                 _smap_stripes = newstripes;
-                _smap_items   = newitems;
 
-                _smap_index_search_ = find_stripe_from_adjd_index;
-                _smap_shrink_func_  = &stripe_map::shrink_map;
-                _smap_is_shrunk     = false;
+                _smap_is_shrunk = false;
+
+                sweep_handles();
+
+                return true;
             };
             ///Shrinks entire stripe_map to single array of contiguous memory
             inline void
                 shrink_map()
             {   using namespace implem;
 
-                auto newitems = shrink_items(_smap_items,
-                                             _smap_stripes,
-                                             _smap_items_count);
-
                 #if DEBUG_SMAP > 2
                     std::cout << "before slot count: " << _smap_slots_count
                               << " after slot count: " << _smap_items_count << std::endl;
                 #endif
 
+                bool inplace = false;
+                if constexpr ( item_store::FILE_BACKED )
+                {
+                    //File backed items compact inside their own mapping and the file is cut to fit
+                    if ( !_smap_items_mapped )
+                    {
+                        shrink_items_in_place(_smap_items,
+                                              _smap_stripes,
+                                              _smap_items_count);
+                        inplace = true;
+                    }
+                }
+
+                if ( !inplace )
+                {
+                    auto newitems = shrink_items(_smap_items,
+                                                 _smap_stripes,
+                                                 _smap_items_count);
+
+                    delete_items();
+                    _smap_items = newitems;
+                }
+
                 _smap_slots_count   = _smap_items_count;
 
-                delete_items();
-                _smap_items = newitems;
+                //Erased items may have left stripe bounds loose
+                if constexpr ( BoundsPolicy::TRACKED )
+                    _smap_ext_max = recalc_stripe_bounds<BoundsPolicy>(_smap_items,
+                                                                       _smap_stripes,
+                                                                       _smap_bounds);
+
+                _smap_is_shrunk = true;
+
+                sweep_handles();
+            };
+            ///Switches index search and shrink back on after items leave gaps in a shrunk map
+            inline void
+                mark_gapped(){
+                _smap_is_shrunk = false;
+            };
+            ///Item array slot of adjusted index ( per IndexPolicy )
+            inline size_t
+                find_slot(const size_t smIndex)
+            {
+                //Tombstones hold their slots until compact(), which would move items under live indices and iterators
+                if constexpr ( IndexPolicy::SHRINK_ON_LOOKUP )
+                {
+                    if ( _smap_tomb_count == 0 )
+                        shrink();
+                }
 
-                _smap_index_search_ = find_stripe_nogap_index;
-                _smap_shrink_func_  = &stripe_map::func_void;
-                _smap_is_shrunk     = true;
+                return IndexPolicy::find_slot(_smap_stripes,
+                                              _smap_occupancy,
+                                              smIndex,
+                                              _smap_is_shrunk);
+            };
+            ///Stripe and item array slot of adjusted index ( per IndexPolicy )
+            inline const Prs::tpsPr<implem::stripe*, size_t>
+                find_stripe(const size_t smIndex)
+            {
+                //Tombstones hold their slots until compact(), which would move items under live indices and iterators
+                if constexpr ( IndexPolicy::SHRINK_ON_LOOKUP )
+                {
+                    if ( _smap_tomb_count == 0 )
+                        shrink();
+                }
+
+                return IndexPolicy::find_stripe(_smap_stripes,
+                                                _smap_occupancy,
+                                                smIndex,
+                                                _smap_is_shrunk);
             };
             ///Erases item at given adjusted index
             inline bool
@@ -1291,38 +4692,287 @@ namespace qmap
             {   using namespace implem;
 
                 //Get correct stripe and aligned index to
-                auto stripefind = _smap_index_search_(_smap_stripes,
-                                                      eraseIndex);
+                auto stripefind = find_stripe(eraseIndex);
+
+                //Index past held items
+                if ( stripefind._1 == nullptr )
+                    return false;
+
+                #if DEBUG_SMAP > 1
+                    std::cout << "Erasing item at index [" << eraseIndex << "]" << std::endl;
+                #endif
+
+                return erase_slot(stripefind._1,
+                                  stripefind._2);
+            };
+            ///Erases item at slot of given stripe ( frees its handle with handled storage )
+            inline bool
+                erase_slot(implem::stripe* stripePtr,
+                           const size_t slotIndex)
+            {   using namespace implem;
+
+                if ( _smap_is_deferred )
+                    return tombstone_slot(stripePtr - _smap_stripes,
+                                          slotIndex);
+
+                if constexpr ( item_store::HANDLED )
+                {
+                    if ( _smap_items._handles[slotIndex] != SMAP_HANDLE_NONE )
+                        _smap_handles.free(_smap_items._handles[slotIndex]);
+                }
 
                 const auto destroysucc = erase_item_from_stripe(_smap_items,
-                                                                stripefind._1,
-                                                                stripefind._2);
+                                                                stripePtr,
+                                                                slotIndex);
                 //Erase attempt failed
                 if ( !destroysucc )
                     return false;
 
+                if ( stripePtr->is_empty() )
+                    _smap_occupancy.unset(stripePtr - _smap_stripes);
+
                 //Decrement count of total held items
                 _smap_items_count--;
 
-                #if DEBUG_SMAP > 1
-                    std::cout << "Erased item at index [" << eraseIndex << "]"
-                              << " new item count is: " << _smap_items_count << std::endl;
-                #endif
-
-                _smap_index_search_  = find_stripe_from_adjd_index;
-                _smap_is_shrunk     = false;
+                mark_gapped();
 
                 //Erase attempt succeeded
                 return true;
             };
+            ///Marks slot of stripe s erased without moving any item ( frees its handle with handled storage )
+            ///--- ( Bitmaps are sized on first use - slot and stripe counts only change after a compact() )
+            inline bool
+                tombstone_slot(const size_t s,
+                               const size_t slotIndex)
+            {   using namespace implem;
+
+                if ( _smap_tombs.size() != _smap_slots_count )
+                    _smap_tombs.make(_smap_slots_count);
+                if ( _smap_tomb_stripes.size() != _smap_stripe_stripes )
+                    _smap_tomb_stripes.make(_smap_stripe_stripes);
+
+                if ( _smap_tombs.test(slotIndex) )
+                    return false;
+
+                if constexpr ( item_store::HANDLED )
+                {
+                    if ( _smap_items._handles[slotIndex] != SMAP_HANDLE_NONE )
+                        _smap_handles.free(_smap_items._handles[slotIndex]);
+
+                    _smap_items._handles[slotIndex] = SMAP_HANDLE_NONE;
+                }
+
+                _smap_tombs.set(slotIndex);
+                _smap_tomb_stripes.set(s);
+                _smap_tomb_count++;
+
+                return true;
+            };
+            ///Tombstones every untombstoned item matching check from slot rmvIndStart to rmvIndEnd, starting at stripe index stripeFirst
+            template <typename F>
+            inline bool
+                tombstone_items(const size_t stripeFirst,
+                                const size_t rmvIndStart,
+                                const size_t rmvIndEnd,
+                                F&& check)
+            {   using namespace implem;
+
+                bool marked = false;
+                for ( size_t s = _smap_occupancy.next(stripeFirst); s != stripe_occupancy::npos; s = _smap_occupancy.next(s + 1) )
+                {
+                    const size_t stripestart = std::max<size_t>(_smap_stripes[s].get_start(), rmvIndStart);
+                    const size_t stripepos   = std::min<size_t>(_smap_stripes[s].get_position(), rmvIndEnd);
+
+                    for ( size_t i = stripestart; i < stripepos; i++ )
+                    {
+                        if ( is_tombed_stripe(s) && _smap_tombs.test(i) )
+                            continue;
+
+                        if ( check(_smap_items[i]) )
+                            marked |= tombstone_slot(s, i);
+                    }
+                }
+
+                return marked;
+            };
+            ///Returns true if stripe s holds tombstones
+            inline bool
+                is_tombed_stripe(const size_t s){
+                return _smap_tomb_count != 0 && _smap_tomb_stripes.test(s);
+            };
+            ///First adjusted index from index on that names an untombstoned item ( _smap_items_count if none )
+            ///--- ( One index lookup, then slots and stripes are walked directly - tombed runs cost a bit test per slot )
+            inline size_t
+                live_index(size_t index)
+            {   using namespace implem;
+
+                if ( _smap_tomb_count == 0 || index >= _smap_items_count )
+                    return index;
+
+                const auto stripefind = find_stripe(index);
+                if ( stripefind._1 == nullptr )
+                    return _smap_items_count;
+
+                size_t s    = stripefind._1 - _smap_stripes;
+                size_t slot = stripefind._2;
+                while ( is_tombed_stripe(s) && _smap_tombs.test(slot) )
+                {
+                    index++;
+                    if ( ++slot == _smap_stripes[s].get_position() )
+                    {
+                        s = _smap_occupancy.next(s + 1);
+                        if ( s == stripe_occupancy::npos )
+                            return _smap_items_count;
+
+                        slot = _smap_stripes[s].get_start();
+                    }
+                }
+
+                return index;
+            };
+            ///Last adjusted index below index that names an untombstoned item ( 0 if none )
+            inline size_t
+                live_index_before(size_t index)
+            {
+                while ( index != 0 )
+                {
+                    index--;
+
+                    if ( _smap_tomb_count == 0 )
+                        break;
+
+                    const auto stripefind = find_stripe(index);
+                    if ( stripefind._1 == nullptr
+                      || !is_tombed_stripe(stripefind._1 - _smap_stripes)
+                      || !_smap_tombs.test(stripefind._2) )
+                        break;
+                }
+
+                return index;
+            };
+            ///Moves survivors of stripe s down over its tombstones in order and clears its slot bits
+            inline void
+                purge_tombs(const size_t s)
+            {
+                implem::stripe& currstripe = _smap_stripes[s];
+
+                const size_t stripestart = currstripe.get_start();
+                size_t kept = stripestart;
+                for ( size_t i = stripestart; i < currstripe.get_position(); i++ )
+                {
+                    if ( _smap_tombs.test(i) )
+                    {
+                        _smap_tombs.unset(i);
+                        continue;
+                    }
+
+                    if ( kept != i )
+                        _smap_items.move_within(kept, i);
+                    kept++;
+                }
+
+                currstripe.set_stripe_start(stripestart, kept - stripestart);
+                if ( currstripe.is_empty() )
+                    _smap_occupancy.unset(s);
+            };
+            ///Drops tombstones of stripe s about to be cleared - returns amount dropped
+            inline size_t
+                drop_tombs(const size_t s)
+            {
+                if ( !is_tombed_stripe(s) )
+                    return 0;
+
+                size_t dropped = 0;
+                for ( size_t i = _smap_stripes[s].get_start(); i < _smap_stripes[s].get_position(); i++ )
+                {
+                    if ( _smap_tombs.test(i) )
+                    {
+                        _smap_tombs.unset(i);
+                        dropped++;
+                    }
+                }
+
+                _smap_tomb_stripes.unset(s);
+                _smap_tomb_count -= dropped;
+
+                return dropped;
+            };
+            ///Issues handle for the item just put in slot
+            inline handle_type
+                issue_handle(const size_t slotIndex)
+            {
+                _smap_items._table = &_smap_handles;
+
+                const handle_type handle  = _smap_handles.issue(slotIndex);
+                _smap_items._handles[slotIndex] = handle._index;
+
+                return handle;
+            };
+            ///Slot of the item handle names ( SIZE_MAX if the handle is stale or never issued )
+            inline size_t
+                handle_slot(const handle_type& handle)
+            {
+                if ( !_smap_is_reserved || handle._index >= _smap_handles.size() )
+                    return SIZE_MAX;
+
+                const auto& entry = _smap_handles[handle._index];
+                if ( entry._gen != handle._gen || ( entry._gen & 1 ) == 0 )
+                    return SIZE_MAX;
+
+                //Entry outlived its item through clear(), remove() or reset() - sweep_handles() frees these
+                const size_t slot = entry._slot;
+                if ( slot >= _smap_slots_count || _smap_items._handles[slot] != handle._index )
+                    return SIZE_MAX;
+
+                implem::stripe& stripe = _smap_stripes[stripe_index(_smap_items.key(slot))];
+                if ( slot < stripe.get_start() || slot >= stripe.get_position() )
+                    return SIZE_MAX;
+
+                return slot;
+            };
+            ///Rebinds the item store to the handle table and frees entries whose item is gone
+            ///--- ( Bulk erases skip handles - their entries are swept on the next restripe or shrink )
+            inline void
+                sweep_handles()
+            {
+                if constexpr ( item_store::HANDLED )
+                {
+                    _smap_items._table = &_smap_handles;
+
+                    if ( !_smap_handles_stale )
+                        return;
+
+                    _smap_handles_stale = false;
+
+                    for ( size_t i = 0; i < _smap_handles.size(); i++ )
+                    {
+                        if ( !_smap_handles.live(i) )
+                            continue;
+
+                        handle_type handle;
+                        handle._index = uint32_t(i);
+                        handle._gen   = _smap_handles[i]._gen;
+
+                        if ( handle_slot(handle) == SIZE_MAX )
+                            _smap_handles.free(uint32_t(i));
+                    }
+                }
+            };
             ///Clears items from stripe matching given depthMatch
             inline bool
                 clear_stripe(const size_t depthMatch)
             {   using namespace implem;
 
+                //Nothing held ( stripes may not be reserved yet )
+                if ( _smap_items_count == 0 )
+                    return false;
+
                 auto stripefind = find_stripe_jump_depth(_smap_stripes,
                                                          depthMatch,
-                                                         _smap_depth_max);
+                                                         _smap_depth_max,
+                                                         _smap_stripe_stripes);
+
+                drop_tombs(stripefind - _smap_stripes);
 
                 const auto clearsucc = clear_entire_stripe(stripefind);
 
@@ -1332,6 +4982,12 @@ namespace qmap
 
                 //Update total items count from what was removed
                 _smap_items_count -= clearsucc._2;
+                _smap_occupancy.unset(stripefind - _smap_stripes);
+                if ( _smap_bounds != nullptr )
+                    _smap_bounds[stripefind - _smap_stripes].reset();
+
+                _smap_handles_stale = true;
+                mark_gapped();
 
                 return true;
             };
@@ -1341,19 +4997,30 @@ namespace qmap
                 remove_items(const size_t rmvIndStart,
                               const size_t rmvIndEnd,
                               F&& check)
-            {
-                auto stripefindstart = _smap_index_search_(_smap_stripes,
-                                                           rmvIndStart);
-                auto stripefindend   = _smap_index_search_(_smap_stripes,
-                                                           rmvIndEnd);
+            {   using namespace implem;
+
+                auto stripefindstart = find_stripe(rmvIndStart);
+                auto stripefindend   = find_stripe(rmvIndEnd);
+
+                //Nothing held at or after rmvIndStart
+                if ( stripefindstart._1 == nullptr )
+                    return false;
 
                 size_t endfix = stripefindend._2;
                 //Index search will return 0 if requesting past max usable index
                 if ( rmvIndEnd == _smap_items_count )
                     endfix = _smap_slots_count;
 
+                if ( _smap_is_deferred )
+                    return tombstone_items(stripefindstart._1 - _smap_stripes,
+                                           stripefindstart._2,
+                                           endfix,
+                                           check);
+
                 auto removesuccess = remove_values_from_stripes(_smap_items,
-                                                                stripefindstart._1,
+                                                                _smap_stripes,
+                                                                _smap_occupancy,
+                                                                stripefindstart._1 - _smap_stripes,
                                                                 stripefindstart._2,
                                                                 endfix,
                                                                 check);
@@ -1363,48 +5030,49 @@ namespace qmap
 
                 _smap_items_count -= removesuccess._2;
 
+                _smap_handles_stale = true;
+                mark_gapped();
+
                 return true;
             };
 
             ///-------------------------------------------------------------------------------------------------------
-            ///SWAPPABLE FUNCTIONS
+            ///RESERVE FUNCTIONS
 
-            ///Empty void function
-            inline void
-                func_void()
-            {};
-            ///Performs initial reserve of stripe_map allocations and updates swappable functions to post-reserve
+            ///Performs initial reserve of stripe_map allocations on first add
             inline void
                 init_reserve()
             {
                 reserve();
 
-                _smap_close_func_  = &stripe_map::close_used;
-                _smap_init_func_   = &stripe_map::func_void;
-                _smap_shrink_func_ = &stripe_map::shrink_map;
+                _smap_is_reserved = true;
+                _smap_is_shrunk   = false;
             };
             ///Performs deletion of item and stripe arrays if stripe_map is post-reserve
             inline void
                 close_used()
             {
                 delete_both();
-
-                _smap_close_func_ = &stripe_map::func_void;
+                delete_bounds();
+                _smap_occupancy.release();
+                _smap_handles.clear();
+                _smap_handles_stale = false;
+                _smap_tombs.release();
+                _smap_tomb_stripes.release();
+                _smap_tomb_count = 0;
+
+                _smap_is_reserved = false;
             }
 
             ///-------------------------------------------------------------------------------------------------------
             ///INTERNAL STRIPE_MAP VARIABLES
-            typedef void
-                (stripe_map::*initFunc)();
-            typedef void
-                (stripe_map::*closeFunc)();
-            typedef void
-                (stripe_map::*shrinkFunc)();
-            typedef const Prs::tpsPr<implem::stripe*, size_t>
-                (*findFunc)(implem::stripe*, const size_t);
-
-            Prs::tpsPr<size_t, V>* _smap_items;                             ///< internal stripe_map items
-            implem::stripe* _smap_stripes;                                          ///< stripe_map stripe information
+            item_store _smap_items;                                                 ///< internal stripe_map items ( per StoragePolicy )
+            implem::stripe* _smap_stripes = nullptr;                                ///< stripe_map stripe information
+            implem::stripe_occupancy _smap_occupancy;                               ///< non-empty stripe bitmap
+            implem::stripe_bounds* _smap_bounds = nullptr;                          ///< cold per-stripe bounds ( bounds_tracked only )
+            implem::handle_table _smap_handles;                                     ///< handle index -> slot ( only issued with handled storage )
+            implem::stripe_occupancy _smap_tombs;                                   ///< one bit per tombstoned slot ( made on first deferred erase )
+            implem::stripe_occupancy _smap_tomb_stripes;                            ///< stripes holding tombstones
 
             size_t _smap_items_count      = 0;                              ///< total items currently held in stripe_map
             size_t _smap_slots_count      = implem::SMAP_INIT_SLOT_COUNT;           ///< total slots including empty in stripe_map
@@ -1413,13 +5081,20 @@ namespace qmap
             size_t _smap_stripe_stripes   = implem::SMAP_INIT_STRIPE_AMOUNT;        ///< total stripes held within stripe_map
             size_t _smap_slots_width      = implem::SMAP_INIT_WIDTH;
             size_t _smap_stripe_depth     = _smap_depth_max;                ///< search depth increment (granularity)
+            int64_t _smap_ext_max         = 0;                              ///< largest tracked extent ( see query_margin )
+            size_t _smap_prefetch_dist    = implem::SMAP_INIT_PREFETCH_DISTANCE;    ///< slots prefetched ahead of scans
+            size_t _smap_tomb_count       = 0;                              ///< tombstoned items still held in slots
 
             bool _smap_is_shrunk          = false;                          ///< determines if stripe_map currently shrunk
+            bool _smap_is_reserved        = false;                          ///< determines if item and stripe arrays are allocated
+            bool _smap_handles_stale      = false;                          ///< determines if bulk erases left live handles to sweep
+            bool _smap_is_deferred        = false;                          ///< determines if erases tombstone instead of swapping
+
 
-            initFunc _smap_init_func_     = &stripe_map::init_reserve;      ///< function used to init stripe_map if uninit
-            closeFunc _smap_close_func_   = &stripe_map::func_void;         ///< function for cleaning stripe_map if in use
-            shrinkFunc _smap_shrink_func_ = &stripe_map::func_void;
-            findFunc _smap_index_search_  = implem::find_stripe_from_adjd_index;    ///< stripe_map index search func pointer
+            void* _smap_mapped            = nullptr;                        ///< owned snapshot mapping ( nullptr unless open_mapped() )
+            size_t _smap_mapped_bytes     = 0;                              ///< size of snapshot mapping
+            bool _smap_items_mapped       = false;                          ///< determines if item arrays live in the mapping
+            bool _smap_stripes_mapped     = false;                          ///< determines if stripe array lives in the mapping
     };
 
 };  //end of qmap namespace
@@ -0,0 +1,301 @@
+#ifndef STRIPE_MAP_2D_HPP
+#define STRIPE_MAP_2D_HPP
+
+#include <algorithm>
+#include <stdint.h>
+#include <vector>
+
+#if defined(__BMI2__)
+    #include <immintrin.h>
+#endif
+
+#include <stripe_map.hpp>
+
+namespace qmap
+{
+    namespace implem
+    {
+        ///Bits per axis of 2D curve codes ( codes span [0, 2^32) )
+        static constexpr uint32_t CURVE_AXIS_BITS = 16;
+        static constexpr uint32_t CURVE_AXIS_MAX  = ( 1u << CURVE_AXIS_BITS ) - 1;
+
+        ///Default refinement levels below the covering quadtree level during rect decomposition
+        static constexpr uint32_t CURVE_REFINE_LEVELS = 2;
+
+        ///-------------------------------------------------------------------------------------------------------
+        ///CURVE ENCODERS
+
+        ///Spreads low 16 bits of v to even bit positions
+        static inline uint32_t
+            spread_bits_16(uint32_t v)
+        {
+            v &= 0x0000ffff;
+            v = ( v | ( v << 8 ) ) & 0x00ff00ff;
+            v = ( v | ( v << 4 ) ) & 0x0f0f0f0f;
+            v = ( v | ( v << 2 ) ) & 0x33333333;
+            v = ( v | ( v << 1 ) ) & 0x55555555;
+
+            return v;
+        };
+
+        ///Morton ( Z-order ) curve - x on even bits, y on odd bits
+        struct curve_morton
+        {
+            static inline uint32_t
+                encode(const uint32_t x,
+                       const uint32_t y)
+            {
+            #if defined(__BMI2__)
+                return _pdep_u32(x, 0x55555555) | _pdep_u32(y, 0xaaaaaaaa);
+            #else
+                return spread_bits_16(x) | ( spread_bits_16(y) << 1 );
+            #endif
+            };
+        };
+
+        ///Hilbert curve of order CURVE_AXIS_BITS ( better locality, slower encode )
+        struct curve_hilbert
+        {
+            static inline uint32_t
+                encode(uint32_t x,
+                       uint32_t y)
+            {
+                uint32_t code = 0;
+                for ( uint32_t s = 1u << ( CURVE_AXIS_BITS - 1 ); s > 0; s >>= 1 )
+                {
+                    const uint32_t rx = ( x & s ) > 0;
+                    const uint32_t ry = ( y & s ) > 0;
+                    code += s * s * ( ( 3 * rx ) ^ ry );
+
+                    //Rotate quadrant
+                    if ( ry == 0 )
+                    {
+                        if ( rx == 1 )
+                        {
+                            x = s - 1 - ( x & ( s - 1 ) );
+                            y = s - 1 - ( y & ( s - 1 ) );
+                        }
+                        const uint32_t t = x;
+                        x = y;
+                        y = t;
+                    }
+                }
+
+                return code;
+            };
+        };
+
+        ///-------------------------------------------------------------------------------------------------------
+        ///RECT DECOMPOSITION
+
+        ///Emits code range of every quadtree cell overlapping [xmin,xmax]x[ymin,ymax] ( cell coords )
+        ///--- ( Cells fully inside or at minLevel emit their whole range - aligned cells are contiguous on both curves )
+        template <typename Curve>
+        static inline void
+            decompose_cell(const uint32_t cellx,
+                           const uint32_t celly,
+                           const uint32_t level,
+                           const uint32_t minLevel,
+                           const uint32_t xmin, const uint32_t ymin,
+                           const uint32_t xmax, const uint32_t ymax,
+                           std::vector<Prs::tpsPr<size_t, size_t>>& ranges)
+        {
+            const uint32_t x0 = cellx << level;
+            const uint32_t y0 = celly << level;
+            const uint32_t x1 = x0 + ( ( 1u << level ) - 1 );
+            const uint32_t y1 = y0 + ( ( 1u << level ) - 1 );
+
+            //Disjoint from query
+            if ( x0 > xmax || x1 < xmin || y0 > ymax || y1 < ymin )
+                return;
+
+            const bool inside = x0 >= xmin && x1 <= xmax && y0 >= ymin && y1 <= ymax;
+            if ( inside || level <= minLevel )
+            {
+                const size_t span  = size_t(1) << ( 2 * level );
+                const size_t first = ( Curve::encode(x0, y0) / span ) * span;
+                ranges.push_back(Prs::tpsPr<size_t, size_t>(first, first + span - 1));
+                return;
+            }
+
+            for ( uint32_t child = 0; child < 4; child++ )
+                decompose_cell<Curve>(( cellx << 1 ) | ( child & 1 ),
+                                      ( celly << 1 ) | ( child >> 1 ),
+                                      level - 1, minLevel,
+                                      xmin, ymin, xmax, ymax, ranges);
+        };
+
+        ///Decomposes rect ( cell coords ) into sorted, merged curve code ranges
+        template <typename Curve>
+        static inline void
+            decompose_rect(const uint32_t xmin, const uint32_t ymin,
+                           const uint32_t xmax, const uint32_t ymax,
+                           const uint32_t refineLevels,
+                           std::vector<Prs::tpsPr<size_t, size_t>>& ranges)
+        {
+            ranges.clear();
+
+            //Smallest level whose cells are at least as wide as the rect
+            const uint32_t extent = std::max(xmax - xmin, ymax - ymin);
+            uint32_t coverlevel = 0;
+            while ( coverlevel < CURVE_AXIS_BITS && ( 1u << coverlevel ) <= extent )
+                coverlevel++;
+
+            const uint32_t minlevel = coverlevel > refineLevels ? coverlevel - refineLevels : 0;
+
+            //At most 2x2 covering cells overlap the rect
+            for ( uint32_t cy = ymin >> coverlevel; cy <= ( ymax >> coverlevel ); cy++ )
+                for ( uint32_t cx = xmin >> coverlevel; cx <= ( xmax >> coverlevel ); cx++ )
+                    decompose_cell<Curve>(cx, cy, coverlevel, minlevel,
+                                          xmin, ymin, xmax, ymax, ranges);
+
+            std::sort(ranges.begin(), ranges.end(),
+                      [](const Prs::tpsPr<size_t, size_t>& a, const Prs::tpsPr<size_t, size_t>& b)
+                          { return a._1 < b._1; });
+
+            //Merge touching ranges
+            size_t merged = 0;
+            for ( size_t i = 1; i < ranges.size(); i++ )
+            {
+                if ( ranges[i]._1 <= ranges[merged]._2 + 1 )
+                    ranges[merged]._2 = std::max(ranges[merged]._2, ranges[i]._2);
+                else
+                    ranges[++merged] = ranges[i];
+            }
+            if ( !ranges.empty() )
+                ranges.resize(merged + 1);
+        };
+
+        ///Returns shift that maps [0, axisMax) onto CURVE_AXIS_BITS bits
+        static inline uint32_t
+            calc_curve_shift(const size_t axisMax)
+        {
+            uint32_t shift = 0;
+            while ( shift < 32 && ( ( axisMax > 0 ? axisMax - 1 : 0 ) >> shift ) > CURVE_AXIS_MAX )
+                shift++;
+
+            return shift;
+        };
+
+    };  //end of helper namespace
+
+    ///-------------------------------------------------------------------------------------------------------
+    ///BEGIN OF STRIPE_MAP_2D CLASS
+    ///--- ( Keys items by a Morton or Hilbert code of ( x, y ) so rect queries only touch spatially local stripes )
+    template <typename V, typename Curve = implem::curve_morton>
+    class stripe_map_2d
+    {
+        public:
+            ///MAKE STRIPE_MAP_2D
+            ///--- ( axisMax : exclusive bound of both axes - coordinates are quantized to 2^16 cells per axis )
+            ///--- ( stripeAmnt : a power of 4 keeps every stripe aligned to one quadtree node )
+            stripe_map_2d(const size_t axisMax = implem::CURVE_AXIS_MAX + 1,
+                          const size_t stripeAmnt = 1024,
+                          const size_t stripeWdth = implem::SMAP_INIT_WIDTH):
+                _s2d_map(size_t(1) << ( 2 * implem::CURVE_AXIS_BITS ), stripeAmnt, stripeWdth),
+                _s2d_shift(implem::calc_curve_shift(axisMax))
+            {};
+
+            ///-------------------------------------------------------------------------------------------------------
+            ///OPERATIONAL FUNCTIONS
+
+            ///Add value at location ( x, y )
+            inline bool
+                add(const int x,
+                    const int y,
+                    const V& value)
+            {
+                return _s2d_map.add(Prs::tpsPr<size_t, V>(encode(x, y), value));
+            };
+            ///Shrink underlying stripe_map
+            inline void
+                shrink(){
+                _s2d_map.shrink();
+            };
+            ///Clears items yet retains current size
+            inline auto
+                clear(){
+                return _s2d_map.clear();
+            };
+            ///Resets underlying stripe_map
+            inline void
+                reset(){
+                _s2d_map.reset();
+            };
+
+            ///-------------------------------------------------------------------------------------------------------
+            ///LOOKUP FUNCTIONS
+
+            ///Calls func on every item in the curve cells overlapping rect [xmin,xmax]x[ymin,ymax] - returns 0 if the rect is inverted
+            ///--- ( Candidates may lie up to a few cells outside the rect - perform exact test in func )
+            template <typename F>
+            inline size_t
+                query(const int xmin,
+                      const int ymin,
+                      const int xmax,
+                      const int ymax,
+                      F&& func,
+                      const uint32_t refineLevels = implem::CURVE_REFINE_LEVELS)
+            {   using namespace implem;
+
+                //Inverted rect would wrap in decompose_rect
+                if ( xmin > xmax || ymin > ymax )
+                {
+                    _s2d_ranges.clear();
+                    return 0;
+                }
+
+                decompose_rect<Curve>(quantize(xmin), quantize(ymin),
+                                      quantize(xmax), quantize(ymax),
+                                      refineLevels, _s2d_ranges);
+
+                return _s2d_map.query_ranges(_s2d_ranges.data(),
+                                             _s2d_ranges.size(),
+                                             func);
+            };
+            ///Curve code for location ( x, y )
+            inline size_t
+                encode(const int x,
+                       const int y){
+                return Curve::encode(quantize(x), quantize(y));
+            };
+
+            ///-------------------------------------------------------------------------------------------------------
+            ///INFO FUNCTIONS
+
+            ///Current stored items in stripe_map_2d
+            inline size_t
+                size(){
+                return _s2d_map.size();
+            };
+            ///Code ranges produced by the last query
+            inline const std::vector<Prs::tpsPr<size_t, size_t>>&
+                last_ranges(){
+                return _s2d_ranges;
+            };
+            ///Underlying stripe_map keyed by curve code
+            inline stripe_map<V>&
+                map(){
+                return _s2d_map;
+            };
+
+        private:
+            ///Maps world coordinate onto curve cell coordinate ( clamped to axis )
+            inline uint32_t
+                quantize(const int loc)
+            {
+                if ( loc <= 0 )
+                    return 0;
+
+                return std::min<uint32_t>(static_cast<uint32_t>(loc) >> _s2d_shift,
+                                          implem::CURVE_AXIS_MAX);
+            };
+
+            stripe_map<V> _s2d_map;                                     ///< items keyed by curve code
+            uint32_t _s2d_shift = 0;                                    ///< world to cell coordinate shift
+            std::vector<Prs::tpsPr<size_t, size_t>> _s2d_ranges;        ///< scratch ranges for queries
+    };
+
+};  //end of qmap namespace
+
+#endif // STRIPE_MAP_2D_HPP
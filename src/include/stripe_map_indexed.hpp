@@ -0,0 +1,243 @@
+#ifndef STRIPE_MAP_INDEXED_HPP
+#define STRIPE_MAP_INDEXED_HPP
+
+#include <stdint.h>
+
+#include <stripe_map.hpp>
+
+namespace qmap
+{
+    namespace implem
+    {
+        ///Set of ColAmnt column pointers ( bound columns are read by item index, gathered columns by row )
+        template <typename T, size_t ColAmnt>
+        struct column_set
+        {
+            ///Returns column col
+            inline const T*
+                operator[](const size_t col) const {
+                return _cols[col];
+            };
+
+            const T* _cols[ColAmnt] = {};      ///< column pointers ( nullptr if unbound )
+        };
+
+    };  //end of helper namespace
+
+    ///-------------------------------------------------------------------------------------------------------
+    ///BEGIN OF STRIPE_MAP_INDEXED CLASS
+    ///--- ( Items are 32 bit indices into user columns of T ( e.g. x, y, w ) - shrink() gathers bound columns into stripe order )
+    ///--- ( Candidate tests then stream contiguous column copies instead of chasing a pointer per item )
+    template <typename T, size_t ColAmnt>
+    class stripe_map_indexed
+    {
+        typedef stripe_map<uint32_t, growth_double, index_adaptive, storage_soa<uint32_t>> map_type;
+
+        public:
+            typedef implem::column_set<T, ColAmnt> columns;
+
+            ///MAKE STRIPE_MAP_INDEXED
+            stripe_map_indexed(const size_t depthMax = implem::SMAP_INIT_MAX_DEPTH,
+                               const size_t stripeAmnt = implem::SMAP_INIT_STRIPE_AMOUNT,
+                               const size_t stripeWdth = implem::SMAP_INIT_WIDTH):
+                _sidx_map(depthMax, stripeAmnt, stripeWdth)
+            {};
+            stripe_map_indexed(const stripe_map_indexed&) = delete;
+            stripe_map_indexed& operator=(const stripe_map_indexed&) = delete;
+            ///CLEANUP
+            virtual ~stripe_map_indexed()
+            {
+                release_rows();
+            };
+
+            ///-------------------------------------------------------------------------------------------------------
+            ///OPERATIONAL FUNCTIONS
+
+            ///Binds column col to data ( read as data[index] - must stay valid while bound )
+            inline void
+                bind_column(const size_t col,
+                            const T* data)
+            {
+                _sidx_bound._cols[col] = data;
+                _sidx_is_gathered      = false;
+            };
+            ///Add item index at key
+            inline bool
+                add(const size_t depthKey,
+                    const uint32_t index)
+            {
+                _sidx_is_gathered = false;
+
+                return _sidx_map.add(typename map_type::value_type(depthKey, index));
+            };
+            ///Shrinks map and gathers every bound column into stripe order
+            inline void
+                shrink()
+            {
+                _sidx_map.shrink();
+
+                gather();
+            };
+            ///Recopies bound columns into stripe order ( call after bound columns change while the map does not )
+            inline void
+                gather()
+            {
+                //Rows are only stripe ordered while shrunk
+                _sidx_map.shrink();
+
+                const size_t rowcount = _sidx_map.size();
+                if ( rowcount > _sidx_row_capacity )
+                    make_rows(rowcount);
+
+                //Shrunk map slots run 0..size() in stripe order
+                for ( size_t row = 0; row < rowcount; row++ )
+                    _sidx_rows[row] = _sidx_map[row]._2;
+
+                for ( size_t col = 0; col < ColAmnt; col++ )
+                {
+                    const T* bound = _sidx_bound[col];
+                    if ( bound == nullptr )
+                        continue;
+
+                    T* gathered = _sidx_gathered_data + col * _sidx_row_capacity;
+                    for ( size_t row = 0; row < rowcount; row++ )
+                        gathered[row] = bound[_sidx_rows[row]];
+                }
+
+                _sidx_is_gathered = true;
+            };
+            ///Clears items yet retains current size ( gathered rows are kept for reuse )
+            inline auto
+                clear()
+            {
+                _sidx_is_gathered = false;
+
+                return _sidx_map.clear();
+            };
+            ///Resets map to initial values and frees gathered rows
+            inline void
+                reset()
+            {
+                _sidx_map.reset();
+                release_rows();
+
+                _sidx_is_gathered = false;
+            };
+
+            ///-------------------------------------------------------------------------------------------------------
+            ///LOOKUP FUNCTIONS
+
+            ///Calls func(index, row, cols) on every item with key within [depthMin, depthMax] - returns amount of items passed to func
+            ///--- ( Once gathered cols are the stripe ordered copies read at row - otherwise the bound columns and row is index )
+            template <typename F>
+            inline size_t
+                query(const size_t depthMin,
+                      const size_t depthMax,
+                      F&& func)
+            {
+                if ( _sidx_is_gathered )
+                    return _sidx_map.query_slots(depthMin,
+                                                 depthMax,
+                                                 [&](const size_t slotIndex, const auto& item)
+                                                     { func(item._2, slotIndex, _sidx_gathered); });
+
+                return _sidx_map.query(depthMin,
+                                       depthMax,
+                                       [&](const auto& item)
+                                           { func(item._2, size_t(item._2), _sidx_bound); });
+            };
+            ///Calls func(rowBegin, rowEnd, cols) once per stripe covering [depthMin, depthMax] - returns amount of rows spanned
+            ///--- ( Gathers first if needed - rows inside a span are whole stripes and NOT key filtered )
+            template <typename F>
+            inline size_t
+                query_spans(const size_t depthMin,
+                            const size_t depthMax,
+                            F&& func)
+            {
+                if ( !_sidx_is_gathered )
+                    gather();
+
+                return _sidx_map.query_spans(depthMin,
+                                             depthMax,
+                                             [&](const size_t rowBegin, const size_t rowEnd)
+                                                 { func(rowBegin, rowEnd, _sidx_gathered); });
+            };
+
+            ///-------------------------------------------------------------------------------------------------------
+            ///INFO FUNCTIONS
+
+            ///Current stored items
+            inline size_t
+                size(){
+                return _sidx_map.size();
+            };
+            ///Item index held at gathered row
+            inline uint32_t
+                index_of(const size_t row){
+                return _sidx_rows[row];
+            };
+            ///Returns true if gathered columns match the map and bound columns as of the last gather()
+            inline bool
+                gathered(){
+                return _sidx_is_gathered;
+            };
+            ///Stripe ordered column copies ( valid while gathered() )
+            inline const columns&
+                gathered_columns(){
+                return _sidx_gathered;
+            };
+            ///Columns as bound
+            inline const columns&
+                bound_columns(){
+                return _sidx_bound;
+            };
+            ///Underlying stripe_map of key -> index ( changing it directly requires gather() before gathered queries )
+            inline map_type&
+                map(){
+                return _sidx_map;
+            };
+
+        private:
+            ///Allocates row index and gathered columns for rowCapacity rows ( contents are rebuilt by gather )
+            inline void
+                make_rows(const size_t rowCapacity)
+            {
+                release_rows();
+
+                _sidx_row_capacity  = rowCapacity;
+                _sidx_rows          = new uint32_t[rowCapacity];
+                _sidx_gathered_data = new T[rowCapacity * ColAmnt];
+
+                for ( size_t col = 0; col < ColAmnt; col++ )
+                    _sidx_gathered._cols[col] = _sidx_gathered_data + col * rowCapacity;
+            };
+            ///Deletes row index and gathered columns
+            inline void
+                release_rows()
+            {
+                delete[] _sidx_rows;
+                delete[] _sidx_gathered_data;
+
+                _sidx_rows          = nullptr;
+                _sidx_gathered_data = nullptr;
+                _sidx_row_capacity  = 0;
+                _sidx_gathered      = columns();
+            };
+
+            ///-------------------------------------------------------------------------------------------------------
+            ///INTERNAL STRIPE_MAP_INDEXED VARIABLES
+            map_type _sidx_map;                         ///< key -> item index
+
+            columns _sidx_bound;                        ///< user columns read by item index
+            columns _sidx_gathered;                     ///< stripe ordered column copies read by row
+
+            uint32_t* _sidx_rows      = nullptr;        ///< item index per gathered row
+            T* _sidx_gathered_data    = nullptr;        ///< ColAmnt * capacity gathered values
+            size_t _sidx_row_capacity = 0;              ///< rows allocated for gathering
+
+            bool _sidx_is_gathered    = false;          ///< determines if gathered columns are current
+    };
+
+};  //end of qmap namespace
+
+#endif // STRIPE_MAP_INDEXED_HPP
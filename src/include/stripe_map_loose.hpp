@@ -0,0 +1,236 @@
+#ifndef STRIPE_MAP_LOOSE_HPP
+#define STRIPE_MAP_LOOSE_HPP
+
+#include <stdint.h>
+
+#include <stripe_map.hpp>
+
+namespace qmap
+{
+    namespace implem
+    {
+        ///Default base stripe depth of the finest level if nothing is provided
+        static constexpr size_t SLOOSE_INIT_BASE_DEPTH = 64;
+        ///Upper bound on level amount ( depth doubles per level )
+        static constexpr size_t SLOOSE_MAX_LEVELS      = 32;
+        ///Coarsest automatic level keeps at least this many stripes
+        static constexpr size_t SLOOSE_MIN_STRIPES     = SMAP_INIT_STRIPE_AMOUNT;
+
+        ///Returns amount of levels from baseDepth doubling until stripes would drop below SLOOSE_MIN_STRIPES
+        static inline size_t
+            calc_loose_levels(const size_t depthMax,
+                              const size_t baseDepth)
+        {
+            size_t levels = 1;
+            while ( levels < SLOOSE_MAX_LEVELS
+                 && depthMax / ( baseDepth << levels ) >= SLOOSE_MIN_STRIPES )
+                levels++;
+
+            return levels;
+        };
+
+    };  //end of helper namespace
+
+    ///-------------------------------------------------------------------------------------------------------
+    ///BEGIN OF STRIPE_MAP_LOOSE CLASS
+    ///--- ( One stripe_map per level, stripe depth doubling per level - objects go to the level whose depth fits their extent )
+    template <typename V>
+    class stripe_map_loose
+    {
+        public:
+            ///MAKE STRIPE_MAP_LOOSE
+            ///--- ( baseDepth : stripe depth of the finest level - objects up to this extent land there )
+            ///--- ( levelAmnt : 0 picks enough levels for the coarsest to keep SLOOSE_MIN_STRIPES stripes )
+            stripe_map_loose(const size_t depthMax  = implem::SMAP_INIT_MAX_DEPTH,
+                             const size_t baseDepth = implem::SLOOSE_INIT_BASE_DEPTH,
+                             const size_t levelAmnt = 0,
+                             const size_t stripeWdth = implem::SMAP_INIT_WIDTH)
+            {
+                init(depthMax,
+                     baseDepth,
+                     levelAmnt,
+                     stripeWdth);
+            };
+            stripe_map_loose(const stripe_map_loose&) = delete;
+            stripe_map_loose& operator=(const stripe_map_loose&) = delete;
+            ///CLEANUP
+            virtual ~stripe_map_loose()
+            {
+                delete[] _sloose_levels;
+                delete[] _sloose_ext_max;
+            };
+
+            ///-------------------------------------------------------------------------------------------------------
+            ///OPERATIONAL FUNCTIONS
+
+            ///Add value at key with given extent ( object covers key +- extent / 2 )
+            inline bool
+                add(const size_t depthKey,
+                    const size_t extent,
+                    const V& value)
+            {
+                const size_t level = level_of(extent);
+
+                if ( !_sloose_levels[level].add(Prs::tpsPr<size_t, V>(depthKey, value)) )
+                    return false;
+
+                if ( extent > _sloose_ext_max[level] )
+                    _sloose_ext_max[level] = extent;
+
+                return true;
+            };
+            ///Shrink every level
+            inline void
+                shrink()
+            {
+                for ( size_t i = 0; i < _sloose_level_amnt; i++ )
+                    _sloose_levels[i].shrink();
+            };
+            ///Clears items from every level yet retains current sizes
+            inline void
+                clear()
+            {
+                for ( size_t i = 0; i < _sloose_level_amnt; i++ )
+                {
+                    _sloose_levels[i].clear();
+                    _sloose_ext_max[i] = 0;
+                }
+            };
+            ///Resets every level to initial values
+            inline void
+                reset()
+            {
+                for ( size_t i = 0; i < _sloose_level_amnt; i++ )
+                {
+                    _sloose_levels[i].reset();
+                    _sloose_ext_max[i] = 0;
+                }
+            };
+
+            ///-------------------------------------------------------------------------------------------------------
+            ///LOOKUP FUNCTIONS
+
+            ///Calls func on every item whose extent may reach [depthMin, depthMax] - returns amount of items passed to func
+            ///--- ( Each level is widened only by half the largest extent it holds - func performs the exact test )
+            ///--- ( Range should already include the probe's own half extent )
+            template <typename F>
+            inline size_t
+                query(const size_t depthMin,
+                      const size_t depthMax,
+                      F&& func)
+            {
+                //Inverted ranges would turn valid once widened by a level margin
+                if ( depthMin > depthMax )
+                    return 0;
+
+                size_t found = 0;
+                for ( size_t i = 0; i < _sloose_level_amnt; i++ )
+                {
+                    if ( _sloose_levels[i].size() == 0 )
+                        continue;
+
+                    const size_t margin = level_margin(i);
+
+                    found += _sloose_levels[i].query(depthMin > margin ? depthMin - margin : 0,
+                                                     depthMax + margin,
+                                                     func);
+                }
+
+                return found;
+            };
+            ///Level whose stripe depth fits extent ( last level takes everything larger )
+            inline size_t
+                level_of(const size_t extent)
+            {
+                size_t level = 0;
+                while ( level + 1 < _sloose_level_amnt && extent > ( _sloose_base_depth << level ) )
+                    level++;
+
+                return level;
+            };
+            ///Key-axis margin applied to queries on level ( half its largest held extent, rounded up )
+            inline size_t
+                level_margin(const size_t level){
+                return ( _sloose_ext_max[level] + 1 ) >> 1;
+            };
+
+            ///-------------------------------------------------------------------------------------------------------
+            ///INFO FUNCTIONS
+
+            ///Current stored items over all levels
+            inline size_t
+                size()
+            {
+                size_t total = 0;
+                for ( size_t i = 0; i < _sloose_level_amnt; i++ )
+                    total += _sloose_levels[i].size();
+
+                return total;
+            };
+            ///Current total slot count over all levels
+            inline size_t
+                slots()
+            {
+                size_t total = 0;
+                for ( size_t i = 0; i < _sloose_level_amnt; i++ )
+                    total += _sloose_levels[i].size() != 0 ? _sloose_levels[i].slots() : 0;
+
+                return total;
+            };
+            ///Amount of levels
+            inline size_t
+                levels(){
+                return _sloose_level_amnt;
+            };
+            ///Underlying stripe_map of level
+            inline stripe_map<V>&
+                level(const size_t level){
+                return _sloose_levels[level];
+            };
+
+        private:
+            ///Validates values and builds every level
+            inline void
+                init(size_t depthMax,
+                     size_t baseDepth,
+                     size_t levelAmnt,
+                     const size_t stripeWdth)
+            {   using namespace implem;
+
+                if ( depthMax == 0 )
+                    depthMax = SMAP_INIT_MAX_DEPTH;
+                if ( baseDepth < 1 )
+                    baseDepth = 1;
+                if ( levelAmnt == 0 )
+                    levelAmnt = calc_loose_levels(depthMax, baseDepth);
+                if ( levelAmnt > SLOOSE_MAX_LEVELS )
+                    levelAmnt = SLOOSE_MAX_LEVELS;
+
+                _sloose_base_depth = baseDepth;
+                _sloose_level_amnt = levelAmnt;
+
+                _sloose_levels  = new stripe_map<V>[_sloose_level_amnt];
+                _sloose_ext_max = new size_t[_sloose_level_amnt]();
+
+                for ( size_t i = 0; i < _sloose_level_amnt; i++ )
+                {
+                    const size_t levelstripes = depthMax / ( _sloose_base_depth << i );
+
+                    _sloose_levels[i].resize(depthMax,
+                                             levelstripes > 0 ? levelstripes : 1,
+                                             stripeWdth);
+                }
+            };
+
+            ///-------------------------------------------------------------------------------------------------------
+            ///INTERNAL STRIPE_MAP_LOOSE VARIABLES
+            stripe_map<V>* _sloose_levels = nullptr;    ///< one stripe_map per level, finest first
+            size_t* _sloose_ext_max       = nullptr;    ///< largest extent held per level
+
+            size_t _sloose_base_depth     = implem::SLOOSE_INIT_BASE_DEPTH;    ///< stripe depth of finest level
+            size_t _sloose_level_amnt     = 0;                                  ///< total levels
+    };
+
+};  //end of qmap namespace
+
+#endif // STRIPE_MAP_LOOSE_HPP
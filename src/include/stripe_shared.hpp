@@ -0,0 +1,589 @@
+#ifndef STRIPE_SHARED_HPP
+#define STRIPE_SHARED_HPP
+
+#include <atomic>
+#include <cerrno>
+#include <stdint.h>
+
+#include <signal.h>
+
+#include <stripe_map.hpp>
+
+//Publication needs POSIX shared memory ( link with -lrt on glibc older than 2.34 )
+#if SMAP_HAS_MMAP
+
+namespace qmap
+{
+    namespace implem
+    {
+        ///Shared segment layout : control object at name, one snapshot buffer per generation parity at name-0 and name-1
+        ///--- ( Buffers hold the snapshot format of save() - stripes and items are offsets and slot indices, never pointers )
+        static constexpr char SMAP_SHARED_MAGIC[8]    = { 'S', 'M', 'A', 'P', 'S', 'H', 'M', 'C' };
+        static constexpr uint32_t SMAP_SHARED_VERSION = 2;
+        static constexpr size_t SMAP_SHARED_NAME_MAX  = 256;
+        static constexpr size_t SMAP_SHARED_NO_BUFFER = 2;
+        ///Readers that may have a segment open at once ( one slot each )
+        static constexpr size_t SMAP_SHARED_READER_MAX = 64;
+
+        static_assert(std::atomic<uint64_t>::is_always_lock_free,
+                      "stripe_map shared publication needs lock free atomics");
+
+        ///Control object shared by the publisher and every reader
+        struct shared_control
+        {
+            char magic[8];                      ///< SMAP_SHARED_MAGIC ( written last on creation )
+            uint32_t version;                   ///< SMAP_SHARED_VERSION
+            std::atomic<uint64_t> generation;   ///< last published generation ( 0 before the first - held in buffer generation & 1 )
+            std::atomic<uint64_t> readers[SMAP_SHARED_READER_MAX];  ///< reader slots ( see shared_slot - 0 if free )
+        };
+
+        ///Reader slot value : owner pid << 2 | held buffer + 1 ( low bits 0 while the reader holds nothing )
+        ///--- ( Slots name their owner so a pin left by a process that died can be told apart and reclaimed )
+        static inline uint64_t
+            shared_slot(const pid_t pid,
+                        const size_t buffer){
+            return uint64_t(uint32_t(pid)) << 2 | ( buffer < 2 ? buffer + 1 : 0 );
+        };
+        ///Buffer held by slot value ( SMAP_SHARED_NO_BUFFER if none )
+        static inline size_t
+            shared_slot_buffer(const uint64_t slot){
+            return ( slot & 3 ) != 0 ? size_t(slot & 3) - 1 : SMAP_SHARED_NO_BUFFER;
+        };
+        ///Returns true if owner of slot value no longer exists ( kill() probe - a dead but unreaped child still counts as alive )
+        static inline bool
+            shared_slot_dead(const uint64_t slot){
+            return ::kill(pid_t(slot >> 2), 0) != 0 && errno == ESRCH;
+        };
+        ///Frees slots of dead readers holding buffer - returns true if a live reader still holds it
+        ///--- ( SMAP_SHARED_NO_BUFFER probes and frees every dead reader's slot instead, held buffer or not )
+        static inline bool
+            shared_reclaim(shared_control* control,
+                           const size_t buffer)
+        {
+            bool pinned = false;
+            for ( size_t i = 0; i < SMAP_SHARED_READER_MAX; i++ )
+            {
+                uint64_t slot = control->readers[i].load();
+                while ( slot != 0 )
+                {
+                    //Only pins in the way are probed - one kill() per blocking reader rather than per open one
+                    if ( buffer != SMAP_SHARED_NO_BUFFER && shared_slot_buffer(slot) != buffer )
+                        break;
+                    if ( !shared_slot_dead(slot) )
+                    {
+                        pinned = true;
+                        break;
+                    }
+
+                    //Lost race means a new reader took the slot over - look at it again
+                    if ( control->readers[i].compare_exchange_strong(slot, 0) )
+                        break;
+                }
+            }
+
+            return pinned;
+        };
+
+        ///Writes name of buffer of segment name to out - returns false if it does not fit
+        static inline bool
+            shared_buffer_name(char (&out)[SMAP_SHARED_NAME_MAX],
+                               const char* name,
+                               const size_t buffer)
+        {
+            const int written = std::snprintf(out, sizeof(out), "%s-%zu", name, buffer);
+
+            return written > 0 && size_t(written) < sizeof(out);
+        };
+        ///Maps control object of fd shared - returns nullptr on failure
+        static inline shared_control*
+            shared_map_control(const int fd)
+        {
+            void* mapping = ::mmap(nullptr, sizeof(shared_control), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            if ( mapping == MAP_FAILED )
+                return nullptr;
+
+            return static_cast<shared_control*>(mapping);
+        };
+
+    };  //end of helper namespace
+
+    ///-------------------------------------------------------------------------------------------------------
+    ///BEGIN OF STRIPE_PUBLISHER CLASS
+    ///--- ( One process publishes a shrunk Map per frame into POSIX shared memory - every stripe_reader<Map> of the same name )
+    ///--- ( maps the newest generation instead of building its own copy )
+    ///--- ( Two buffers alternate by generation parity : publish() writes the one readers are not on and then bumps the generation )
+    ///--- ( Map values must be trivially copyable and mean the same in every process - indices or ids rather than pointers )
+    template <typename Map>
+    class stripe_publisher
+    {
+        public:
+            ///MAKE STRIPE_PUBLISHER
+            stripe_publisher(){};
+            stripe_publisher(const stripe_publisher&) = delete;
+            stripe_publisher& operator=(const stripe_publisher&) = delete;
+            ///CLEANUP
+            ///--- ( Segment names are kept - see remove() )
+            virtual ~stripe_publisher()
+            {
+                close();
+            };
+
+            ///-------------------------------------------------------------------------------------------------------
+            ///OPERATIONAL FUNCTIONS
+
+            ///Creates segment name ( a POSIX shm name such as "/frame_index" ) or takes over one left by an earlier publisher
+            ///--- ( Returns false on failure - generations continue from the last one published under name )
+            inline bool
+                open(const char* name)
+            {   using namespace implem;
+
+                close();
+
+                char buffername[SMAP_SHARED_NAME_MAX];
+                if ( !shared_buffer_name(buffername, name, 1) )
+                    return false;
+
+                const int controlfd = ::shm_open(name, O_RDWR | O_CREAT, 0600);
+                if ( controlfd < 0 )
+                    return false;
+
+                if ( ::ftruncate(controlfd, off_t(sizeof(shared_control))) != 0 )
+                {
+                    ::close(controlfd);
+                    return false;
+                }
+
+                _spub_control = shared_map_control(controlfd);
+                ::close(controlfd);
+
+                if ( _spub_control == nullptr )
+                    return false;
+
+                //Fresh object reads as zero - magic goes in last so readers never see a half made control
+                if ( std::memcmp(_spub_control->magic, SMAP_SHARED_MAGIC, sizeof(SMAP_SHARED_MAGIC)) != 0
+                  || _spub_control->version != SMAP_SHARED_VERSION )
+                {
+                    _spub_control->version = SMAP_SHARED_VERSION;
+                    _spub_control->generation.store(0);
+                    for ( size_t i = 0; i < SMAP_SHARED_READER_MAX; i++ )
+                        _spub_control->readers[i].store(0);
+
+                    std::atomic_thread_fence(std::memory_order_seq_cst);
+                    std::memcpy(_spub_control->magic, SMAP_SHARED_MAGIC, sizeof(SMAP_SHARED_MAGIC));
+                }
+                else
+                {
+                    //Pins of readers that died under an earlier publisher go now
+                    shared_reclaim(_spub_control, SMAP_SHARED_NO_BUFFER);
+                }
+
+                for ( size_t b = 0; b < 2; b++ )
+                {
+                    shared_buffer_name(buffername, name, b);
+
+                    _spub_fd[b] = ::shm_open(buffername, O_RDWR | O_CREAT, 0600);
+                    if ( _spub_fd[b] < 0 )
+                    {
+                        close();
+                        return false;
+                    }
+
+                    //Buffer left by an earlier publisher is reused at its size
+                    struct stat info;
+                    if ( ::fstat(_spub_fd[b], &info) == 0 && info.st_size > 0 && !map_buffer(b, size_t(info.st_size)) )
+                    {
+                        close();
+                        return false;
+                    }
+                }
+
+                return true;
+            };
+            ///Shrinks map, writes it into the buffer of the next generation and publishes that generation
+            ///--- ( Returns false without publishing if a live reader still holds that buffer, or it could not grow - retry next frame )
+            ///--- ( Pins of readers whose process is gone are reclaimed here, so a reader dying mid frame never wedges publication )
+            inline bool
+                publish(Map& map)
+            {   using namespace implem;
+
+                if ( _spub_control == nullptr )
+                    return false;
+
+                const uint64_t next   = _spub_control->generation.load() + 1;
+                const size_t buffer   = size_t(next & 1);
+
+                //A reader pinning this buffer after the check sees the generation unchanged and lets go again
+                if ( shared_reclaim(_spub_control, buffer) )
+                    return false;
+
+                //Readers attach without verifying items, so the item checksum pass is skipped
+                snapshot_header header;
+                map.make_snapshot_header(header, false);
+
+                if ( header.file_bytes > _spub_bytes[buffer] && !grow_buffer(buffer, header.file_bytes) )
+                    return false;
+
+                map.write_snapshot(_spub_buffer[buffer], header);
+
+                _spub_control->generation.store(next);
+                _spub_published_bytes = header.file_bytes;
+
+                return true;
+            };
+            ///Unmaps and closes segment ( names stay - readers keep what they hold and a later open() takes over )
+            inline void
+                close()
+            {
+                for ( size_t b = 0; b < 2; b++ )
+                {
+                    if ( _spub_buffer[b] != nullptr )
+                        ::munmap(_spub_buffer[b], _spub_bytes[b]);
+                    if ( _spub_fd[b] >= 0 )
+                        ::close(_spub_fd[b]);
+
+                    _spub_buffer[b] = nullptr;
+                    _spub_bytes[b]  = 0;
+                    _spub_fd[b]     = -1;
+                }
+
+                if ( _spub_control != nullptr )
+                    ::munmap(_spub_control, sizeof(implem::shared_control));
+
+                _spub_control = nullptr;
+            };
+            ///Unlinks control and buffers of segment name ( processes that still have them mapped keep them until they let go )
+            static inline void
+                remove(const char* name)
+            {   using namespace implem;
+
+                char buffername[SMAP_SHARED_NAME_MAX];
+                for ( size_t b = 0; b < 2; b++ )
+                {
+                    if ( shared_buffer_name(buffername, name, b) )
+                        ::shm_unlink(buffername);
+                }
+
+                ::shm_unlink(name);
+            };
+
+            ///-------------------------------------------------------------------------------------------------------
+            ///INFO FUNCTIONS
+
+            ///Returns true if a segment is open
+            inline bool
+                is_open(){
+                return _spub_control != nullptr;
+            };
+            ///Last published generation ( 0 if none )
+            inline uint64_t
+                generation(){
+                return _spub_control != nullptr ? _spub_control->generation.load() : 0;
+            };
+            ///Snapshot bytes of the last publish()
+            inline size_t
+                published_bytes(){
+                return _spub_published_bytes;
+            };
+            ///Readers currently holding buffer ( 0 or 1 - dead ones count until the next publish() or open() reclaims them )
+            inline uint32_t
+                pins(const size_t buffer)
+            {   using namespace implem;
+
+                if ( _spub_control == nullptr )
+                    return 0;
+
+                uint32_t pinned = 0;
+                for ( size_t i = 0; i < SMAP_SHARED_READER_MAX; i++ )
+                    pinned += shared_slot_buffer(_spub_control->readers[i].load()) == buffer;
+
+                return pinned;
+            };
+
+        private:
+            ///Maps buffer b at bytes shared and writable
+            inline bool
+                map_buffer(const size_t b,
+                           const size_t bytes)
+            {
+                void* mapping = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, _spub_fd[b], 0);
+                if ( mapping == MAP_FAILED )
+                    return false;
+
+                if ( _spub_buffer[b] != nullptr )
+                    ::munmap(_spub_buffer[b], _spub_bytes[b]);
+
+                _spub_buffer[b] = static_cast<char*>(mapping);
+                _spub_bytes[b]  = bytes;
+
+                return true;
+            };
+            ///Grows buffer b to hold bytes plus a quarter ( buffers never shrink, so readers' mappings stay inside the object )
+            inline bool
+                grow_buffer(const size_t b,
+                            const size_t bytes)
+            {
+                const size_t newbytes = implem::snapshot_align(bytes + bytes / 4);
+
+                if ( ::ftruncate(_spub_fd[b], off_t(newbytes)) != 0 )
+                    return false;
+
+                return map_buffer(b, newbytes);
+            };
+
+            ///-------------------------------------------------------------------------------------------------------
+            ///INTERNAL STRIPE_PUBLISHER VARIABLES
+            implem::shared_control* _spub_control = nullptr;      ///< control object
+
+            char* _spub_buffer[2]        = { nullptr, nullptr };   ///< buffer mappings
+            size_t _spub_bytes[2]        = { 0, 0 };               ///< buffer sizes
+            int _spub_fd[2]              = { -1, -1 };             ///< buffer objects
+
+            size_t _spub_published_bytes = 0;                      ///< snapshot bytes of the last publish
+    };
+
+    ///-------------------------------------------------------------------------------------------------------
+    ///BEGIN OF STRIPE_READER CLASS
+    ///--- ( acquire() pins the newest generation and points map() straight into its buffer - nothing is copied or rebuilt )
+    ///--- ( The buffer is mapped privately : map() stays fully usable and its writes never reach the publisher or other readers )
+    ///--- ( Each open reader owns one slot of the control object tagged with its pid - open it in the process that uses it )
+    template <typename Map>
+    class stripe_reader
+    {
+        public:
+            ///MAKE STRIPE_READER
+            stripe_reader(){};
+            stripe_reader(const stripe_reader&) = delete;
+            stripe_reader& operator=(const stripe_reader&) = delete;
+            ///CLEANUP
+            virtual ~stripe_reader()
+            {
+                close();
+            };
+
+            ///-------------------------------------------------------------------------------------------------------
+            ///OPERATIONAL FUNCTIONS
+
+            ///Opens segment name made by a stripe_publisher - returns false if it does not exist yet or every reader slot is taken
+            ///--- ( Slots left by readers that died are taken over )
+            inline bool
+                open(const char* name)
+            {   using namespace implem;
+
+                close();
+
+                char buffername[SMAP_SHARED_NAME_MAX];
+                if ( !shared_buffer_name(buffername, name, 1) )
+                    return false;
+
+                const int controlfd = ::shm_open(name, O_RDWR, 0);
+                if ( controlfd < 0 )
+                    return false;
+
+                struct stat info;
+                if ( ::fstat(controlfd, &info) == 0 && size_t(info.st_size) >= sizeof(shared_control) )
+                    _sread_control = shared_map_control(controlfd);
+                ::close(controlfd);
+
+                if ( _sread_control == nullptr )
+                    return false;
+
+                if ( std::memcmp(_sread_control->magic, SMAP_SHARED_MAGIC, sizeof(SMAP_SHARED_MAGIC)) != 0
+                  || _sread_control->version != SMAP_SHARED_VERSION )
+                {
+                    close();
+                    return false;
+                }
+
+                for ( size_t b = 0; b < 2; b++ )
+                {
+                    shared_buffer_name(buffername, name, b);
+
+                    _sread_fd[b] = ::shm_open(buffername, O_RDONLY, 0);
+                    if ( _sread_fd[b] < 0 )
+                    {
+                        close();
+                        return false;
+                    }
+                }
+
+                _sread_pid = ::getpid();
+                for ( size_t i = 0; i < SMAP_SHARED_READER_MAX && _sread_slot == SMAP_SHARED_READER_MAX; i++ )
+                {
+                    uint64_t slot = _sread_control->readers[i].load();
+                    if ( ( slot == 0 || shared_slot_dead(slot) )
+                      && _sread_control->readers[i].compare_exchange_strong(slot, shared_slot(_sread_pid, SMAP_SHARED_NO_BUFFER)) )
+                        _sread_slot = i;
+                }
+
+                if ( _sread_slot == SMAP_SHARED_READER_MAX )
+                {
+                    close();
+                    return false;
+                }
+
+                return true;
+            };
+            ///Pins the newest generation and attaches map() to it - returns false if none is published or its buffer is invalid
+            ///--- ( Holding the newest already returns true at once - the pin lasts until the next acquire(), release() or close() )
+            inline bool
+                acquire()
+            {   using namespace implem;
+
+                if ( _sread_control == nullptr )
+                    return false;
+
+                uint64_t generation;
+                size_t buffer;
+                for ( ;; )
+                {
+                    generation = _sread_control->generation.load();
+                    if ( generation == 0 )
+                        return false;
+                    if ( generation == _sread_generation )
+                        return true;
+
+                    release();
+
+                    //Generation unchanged after pinning means the publisher has not started rewriting this buffer
+                    buffer = size_t(generation & 1);
+                    pin(buffer);
+                    if ( _sread_control->generation.load() == generation )
+                        break;
+
+                    pin(SMAP_SHARED_NO_BUFFER);
+                }
+
+                if ( !attach(buffer) )
+                {
+                    pin(SMAP_SHARED_NO_BUFFER);
+                    return false;
+                }
+
+                _sread_buffer     = buffer;
+                _sread_generation = generation;
+
+                return true;
+            };
+            ///Lets go of the held generation ( map() is reset - the publisher may rewrite its buffer )
+            inline void
+                release()
+            {   using namespace implem;
+
+                if ( _sread_buffer == SMAP_SHARED_NO_BUFFER )
+                    return;
+
+                _sread_map.reset();
+                snapshot_unmap_file(_sread_mapping, _sread_mapped_bytes);
+                pin(SMAP_SHARED_NO_BUFFER);
+
+                _sread_mapping      = nullptr;
+                _sread_mapped_bytes = 0;
+                _sread_buffer       = SMAP_SHARED_NO_BUFFER;
+                _sread_generation   = 0;
+            };
+            ///Releases and closes segment
+            inline void
+                close()
+            {
+                if ( _sread_control != nullptr )
+                    release();
+
+                for ( size_t b = 0; b < 2; b++ )
+                {
+                    if ( _sread_fd[b] >= 0 )
+                        ::close(_sread_fd[b]);
+
+                    _sread_fd[b] = -1;
+                }
+
+                if ( _sread_control != nullptr )
+                {
+                    if ( _sread_slot != implem::SMAP_SHARED_READER_MAX )
+                        _sread_control->readers[_sread_slot].store(0);
+
+                    ::munmap(_sread_control, sizeof(implem::shared_control));
+                }
+
+                _sread_control = nullptr;
+                _sread_slot    = implem::SMAP_SHARED_READER_MAX;
+            };
+
+            ///-------------------------------------------------------------------------------------------------------
+            ///INFO FUNCTIONS
+
+            ///Map attached to the held generation ( empty if none - valid until the next acquire(), release() or close() )
+            inline Map&
+                map(){
+                return _sread_map;
+            };
+            ///Held generation ( 0 if none )
+            inline uint64_t
+                generation(){
+                return _sread_generation;
+            };
+            ///Newest published generation ( 0 if none )
+            inline uint64_t
+                latest(){
+                return _sread_control != nullptr ? _sread_control->generation.load() : 0;
+            };
+            ///Returns true if a segment is open
+            inline bool
+                is_open(){
+                return _sread_control != nullptr;
+            };
+
+        private:
+            ///Marks buffer b held in this reader's slot ( SMAP_SHARED_NO_BUFFER marks none )
+            inline void
+                pin(const size_t b){
+                _sread_control->readers[_sread_slot].store(implem::shared_slot(_sread_pid, b));
+            };
+            ///Maps pinned buffer b privately at its snapshot size and attaches map to it
+            inline bool
+                attach(const size_t b)
+            {   using namespace implem;
+
+                snapshot_header header;
+                struct stat info;
+                if ( ::pread(_sread_fd[b], &header, sizeof(header), 0) != ssize_t(sizeof(header))
+                  || ::fstat(_sread_fd[b], &info) != 0
+                  || header.file_bytes < sizeof(header)
+                  || header.file_bytes > size_t(info.st_size) )
+                    return false;
+
+                const auto mapping = snapshot_map_fd(_sread_fd[b], header.file_bytes);
+                if ( mapping._1 == nullptr )
+                    return false;
+
+                if ( !_sread_map.attach_snapshot(static_cast<char*>(mapping._1), mapping._2, false) )
+                {
+                    snapshot_unmap_file(mapping._1, mapping._2);
+                    return false;
+                }
+
+                _sread_mapping      = mapping._1;
+                _sread_mapped_bytes = mapping._2;
+
+                return true;
+            };
+
+            ///-------------------------------------------------------------------------------------------------------
+            ///INTERNAL STRIPE_READER VARIABLES
+            Map _sread_map;                                         ///< map attached to the held generation
+
+            implem::shared_control* _sread_control = nullptr;      ///< control object
+            int _sread_fd[2]            = { -1, -1 };               ///< buffer objects
+            size_t _sread_slot          = implem::SMAP_SHARED_READER_MAX;  ///< reader slot owned ( SMAP_SHARED_READER_MAX if none )
+            pid_t _sread_pid            = 0;                        ///< pid the slot is tagged with
+
+            void* _sread_mapping        = nullptr;                  ///< private mapping of the held buffer
+            size_t _sread_mapped_bytes  = 0;                        ///< size of that mapping
+            size_t _sread_buffer        = implem::SMAP_SHARED_NO_BUFFER;   ///< held buffer ( SMAP_SHARED_NO_BUFFER if none )
+            uint64_t _sread_generation  = 0;                        ///< held generation ( 0 if none )
+    };
+
+};  //end of qmap namespace
+
+#endif // SMAP_HAS_MMAP
+
+#endif // STRIPE_SHARED_HPP
@@ -0,0 +1,195 @@
+///Differential test of the batched narrowphase kernels ( uti_FindInsideBatch.hpp )
+///--- ( Batch and 8-wide masks are compared bit for bit with the scalar _Exact tests, and the _Exact tests with )
+///--- ( FindInside_Radius_Q / FindInside_Square, over random and circle-boundary candidates )
+///
+///  g++ -std=c++17 -O2 -mavx2 -Isrc/include test/narrowphase_batch_test.cpp -o narrowphase_batch_test
+///  g++ -std=c++17 -O2 -Isrc/include test/narrowphase_batch_test.cpp -o narrowphase_batch_test_scalar
+///  ./narrowphase_batch_test --blocks 20000 --seed 11              ( exits 1 if any kernel disagrees )
+///
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include <_Utilities/uti_FindInside.hpp>
+#include <_Utilities/uti_FindInsideBatch.hpp>
+#include <_Utilities/uti_WorkloadGenerator.h>
+
+namespace
+{
+    ///Probe / candidate shape expected by the kernels
+    struct body
+    {
+        int x, y, w, h;
+    };
+
+    ///SoA candidate block
+    struct block
+    {
+        std::vector<int> x, y, w, h;
+
+        void push(const body& b){ x.push_back(b.x); y.push_back(b.y); w.push_back(b.w); h.push_back(b.h); };
+        size_t size() const { return x.size(); };
+    };
+
+    ///Returns value following --name in argv, or fallback
+    size_t
+        arg_count(int argc,
+                  char** argv,
+                  const char* name,
+                  const size_t fallback)
+    {
+        for ( int i = 1; i + 1 < argc; i++ )
+        {
+            if ( std::strcmp(argv[i], name) == 0 )
+                return std::strtoull(argv[i + 1], nullptr, 10);
+        }
+
+        return fallback;
+    };
+
+    ///Signed value in [-range, range]
+    int
+        signed_in(uti_WorkloadGenerator& gen,
+                  const int range)
+    {
+        return int(gen.NextBounded(2 * uint64_t(range) + 1)) - range;
+    };
+
+    ///Candidate somewhere around probe within spread ( widths >= 3 so the radius tests agree )
+    body
+        random_candidate(uti_WorkloadGenerator& gen,
+                         const body& probe,
+                         const int spread)
+    {
+        return { probe.x + signed_in(gen, spread), probe.y + signed_in(gen, spread),
+                 3 + int(gen.NextBounded(4000)), 3 + int(gen.NextBounded(4000)) };
+    };
+
+    ///Candidate on or next to probe's radius boundary ( d2 == limit^2 - 1, limit^2 or limit^2 + 1 region )
+    body
+        boundary_candidate(uti_WorkloadGenerator& gen,
+                           const body& probe)
+    {
+        body cand = random_candidate(gen, probe, 0);
+
+        const int64_t limit = ( ( probe.w + cand.w ) >> 1 ) + 1;
+        const int64_t dx = gen.NextBounded(limit + 1);
+        const int64_t dy = int64_t(std::sqrt(double(limit * limit - dx * dx))) + signed_in(gen, 1);
+
+        cand.x = probe.x + int( gen.NextBounded(2) ? dx : -dx );
+        cand.y = probe.y + int( gen.NextBounded(2) ? dy : -dy );
+
+        return cand;
+    };
+
+    ///Compares every kernel on one block - returns amount of mismatches
+    size_t
+        check_block(const body& probe,
+                    const block& cands,
+                    const bool compareOriginal)
+    {
+        using namespace ColliderUtils;
+
+        size_t mismatches = 0;
+        const size_t count = cands.size();
+
+        std::vector<uint64_t> radius(( count + 63 ) / 64 + 1), square(( count + 63 ) / 64 + 1);
+        const size_t radiushits = FindInside_Radius_Batch(probe, cands.x.data(), cands.y.data(), cands.w.data(), count, radius.data());
+        const size_t squarehits = FindInside_Square_Batch(probe, cands.x.data(), cands.y.data(), cands.w.data(), cands.h.data(),
+                                                          count, square.data());
+
+        size_t radiusexpect = 0;
+        size_t squareexpect = 0;
+        for ( size_t i = 0; i < count; i++ )
+        {
+            const body cand = { cands.x[i], cands.y[i], cands.w[i], cands.h[i] };
+            const bool inradius = FindInside_Radius_Exact(probe.x, probe.y, probe.w, cand.x, cand.y, cand.w);
+            const bool insquare = FindInside_Square_Exact(probe.x, probe.y, probe.w, probe.h, cand.x, cand.y, cand.w, cand.h);
+
+            radiusexpect += inradius;
+            squareexpect += insquare;
+
+            if ( bool(( radius[i >> 6] >> ( i & 63 ) ) & 1) != inradius )
+                mismatches++;
+            if ( bool(( square[i >> 6] >> ( i & 63 ) ) & 1) != insquare )
+                mismatches++;
+
+            //The original tests overflow on far coordinates, so they only see the near blocks
+            if ( compareOriginal )
+            {
+                if ( FindInside_Radius_Q(probe, cand) != inradius )
+                    mismatches++;
+                if ( FindInside_Square(probe, cand) != insquare )
+                    mismatches++;
+            }
+        }
+
+        if ( radiushits != radiusexpect || squarehits != squareexpect )
+            mismatches++;
+
+        //8-wide kernels on their own, for the first full group
+        if ( count >= 8 )
+        {
+            uint32_t radius8 = 0;
+            uint32_t square8 = 0;
+            for ( size_t i = 0; i < 8; i++ )
+            {
+                radius8 |= uint32_t(( radius[0] >> i ) & 1) << i;
+                square8 |= uint32_t(( square[0] >> i ) & 1) << i;
+            }
+
+            if ( FindInside_Radius_Q8(probe, cands.x.data(), cands.y.data(), cands.w.data()) != radius8 )
+                mismatches++;
+            if ( FindInside_Square8(probe, cands.x.data(), cands.y.data(), cands.w.data(), cands.h.data()) != square8 )
+                mismatches++;
+        }
+
+        return mismatches;
+    };
+
+};  //end of anonymous namespace
+
+int main(int argc, char** argv)
+{
+    const uint64_t seed  = arg_count(argc, argv, "--seed", 11);
+    const size_t blocks  = arg_count(argc, argv, "--blocks", 20000);
+
+    uti_WorkloadGenerator gen(seed);
+
+    size_t cases = 0;
+    size_t mismatches = 0;
+    for ( size_t b = 0; b < blocks; b++ )
+    {
+        //Near blocks stay where the original tests are exact, far ones use the full +-2^29 kernel range
+        const bool near = b % 4 != 3;
+        const int range = near ? 1 << 20 : 1 << 29;
+
+        const body probe = { signed_in(gen, range / 2), signed_in(gen, range / 2),
+                             3 + int(gen.NextBounded(4000)), 3 + int(gen.NextBounded(4000)) };
+
+        block cands;
+        const size_t count = gen.NextBounded(100);
+        for ( size_t i = 0; i < count; i++ )
+        {
+            const uint64_t kind = gen.NextBounded(3);
+            cands.push(kind == 0 ? boundary_candidate(gen, probe)
+                                 : random_candidate(gen, probe, kind == 1 ? 4000 : range / 2));
+        }
+
+        cases += count;
+        mismatches += check_block(probe, cands, near);
+    }
+
+    #if defined(COLLIDER_BATCH_AVX2)
+        const char* path = "avx2";
+    #else
+        const char* path = "scalar";
+    #endif
+
+    std::printf("path,blocks,cases,mismatches\n");
+    std::printf("%s,%zu,%zu,%zu\n", path, blocks, cases, mismatches);
+
+    return mismatches == 0 ? 0 : 1;
+}
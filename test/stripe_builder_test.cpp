@@ -0,0 +1,273 @@
+///Differential test of stripe_builder against load()
+///--- ( Maps already holding items are extended once through load() and once through a builder fed in random chunks under )
+///--- ( several budgets ( down to one item per block ), with finish() called midway now and then - both must end shrunk with )
+///--- ( the same contents, query() / query_bounded() must match a map loaded from scratch, and handles issued before the )
+///--- ( build must still resolve )
+///
+///  g++ -std=c++17 -O1 -g -fsanitize=address,undefined -Isrc/include test/stripe_builder_test.cpp -o stripe_builder_test
+///  ./stripe_builder_test --trials 20 --items 20000 --seed 11     ( exits 1 if any built map differs from its loaded twin )
+///
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include <stripe_builder.hpp>
+#include <_Utilities/uti_WorkloadGenerator.h>
+
+namespace
+{
+    ///Sorted ( key, id ) pairs
+    typedef std::vector<std::pair<size_t, int>> pair_list;
+
+    ///Secondary coordinate and extent of an id for the tracked set
+    struct IdSec
+    {
+        inline int64_t
+            operator()(const int id) const {
+            return ( int64_t(id) * 7919 ) % 100000;
+        };
+    };
+    struct IdExt
+    {
+        inline int64_t
+            operator()(const int id) const {
+            return id & 63;
+        };
+    };
+
+    typedef qmap::stripe_map<int> map_aos;
+    typedef qmap::stripe_map<int, qmap::growth_double, qmap::index_adaptive, qmap::storage_soa<uint32_t>> map_soa_u32;
+    typedef qmap::stripe_map<int, qmap::growth_double, qmap::index_adaptive, qmap::storage_handles<qmap::storage_soa<uint32_t>>> map_handles;
+    typedef qmap::stripe_map<int, qmap::growth_double, qmap::index_adaptive, qmap::storage_aos<>,
+                             qmap::bounds_tracked<IdSec, IdExt>> map_tracked;
+    typedef qmap::stripe_map<int, qmap::growth_double, qmap::index_adaptive, qmap::storage_mapped<>> map_mapped;
+
+    ///Builder budgets in bytes ( 1 gives one item per block )
+    static const size_t BUDGETS[] = { 0, 1, 700, 20000, 1 << 20 };
+
+    ///Test run settings
+    struct config
+    {
+        uint64_t seed  = 11;        ///< workload generator seed
+        size_t trials  = 20;        ///< item sets built per policy set
+        size_t items   = 20000;     ///< most items fed per build
+    };
+
+    ///Returns value following --name in argv, or fallback
+    size_t
+        arg_count(int argc,
+                  char** argv,
+                  const char* name,
+                  const size_t fallback)
+    {
+        for ( int i = 1; i + 1 < argc; i++ )
+        {
+            if ( std::strcmp(argv[i], name) == 0 )
+                return std::strtoull(argv[i + 1], nullptr, 10);
+        }
+
+        return fallback;
+    };
+
+    ///Sorted ( key, id ) pairs reached by for_each
+    template <typename Map>
+    pair_list
+        contents(Map& map)
+    {
+        pair_list pairs;
+        map.for_each([&](const auto& item){ pairs.push_back({ size_t(item._1), int(item._2) }); });
+
+        std::sort(pairs.begin(), pairs.end());
+
+        return pairs;
+    };
+    ///Sorted ( key, id ) pairs passed to func by query ( a query / query_bounded call on map )
+    template <typename Q>
+    pair_list
+        collect(Q&& query)
+    {
+        pair_list pairs;
+        query([&](const auto& item){ pairs.push_back({ size_t(item._1), int(item._2) }); });
+
+        std::sort(pairs.begin(), pairs.end());
+
+        return pairs;
+    };
+
+    ///Adds held items to map and erases some of them - ids count down from -1, Handled maps issue a handle per item
+    template <typename Map, bool Handled>
+    void
+        fill_held(Map& map,
+                  const std::vector<size_t>& keys,
+                  const int drop,
+                  std::vector<typename Map::handle_type>& handles)
+    {
+        for ( size_t i = 0; i < keys.size(); i++ )
+        {
+            const typename Map::value_type item(keys[i], -1 - int(i));
+
+            if constexpr ( Handled )
+            {
+                handles.push_back(typename Map::handle_type());
+                map.add(item, handles.back());
+            }
+            else
+                map.add(item);
+        }
+
+        map.remove_if(map.begin(), map.end(), [drop](const auto& item){ return -item._2 % 5 == drop; });
+    };
+
+    ///Runs cfg.trials builds of Map for every budget - returns amount of mismatches
+    template <typename Map, bool Handled = false>
+    size_t
+        run_trials(const config& cfg,
+                   const char* name)
+    {
+        typedef std::vector<typename Map::handle_type> handle_list;
+
+        uti_WorkloadGenerator gen(cfg.seed);
+        size_t mismatches = 0;
+
+        for ( size_t trial = 0; trial < cfg.trials; trial++ )
+        {
+            const size_t depthMax = 1000 + gen.NextBounded(1000000);
+            const size_t stripes  = 1 + gen.NextBounded(2000);
+            const size_t width    = 1 + gen.NextBounded(8);
+
+            //Keys reach past the axis end, and every 4th set piles half its items into one stripe
+            std::vector<size_t> held(gen.NextBounded(cfg.items / 4 + 1));
+            std::vector<typename Map::value_type> fed(gen.NextBounded(cfg.items + 1));
+            const size_t pile = gen.NextBounded(depthMax);
+
+            for ( auto & key : held )
+                key = gen.NextBounded(depthMax + 100);
+            for ( size_t i = 0; i < fed.size(); i++ )
+            {
+                const size_t key = trial % 4 == 3 && i % 2 == 0 ? pile : gen.NextBounded(depthMax + 100);
+                fed[i] = typename Map::value_type(key, int(i));
+            }
+
+            const int drop = int(gen.NextBounded(5));
+
+            Map loaded(depthMax, stripes, width);
+            handle_list loadedhandles;
+            fill_held<Map, Handled>(loaded, held, drop, loadedhandles);
+
+            if ( !loaded.load(fed.data(), fed.size()) )
+            {
+                mismatches++;
+                continue;
+            }
+
+            const pair_list expect = contents(loaded);
+
+            //Erased held items leave loaded's tracked bounds loose - queries compare with a map loaded from scratch
+            std::vector<typename Map::value_type> survivors;
+            for ( const auto & pair : expect )
+                survivors.push_back(typename Map::value_type(pair.first, pair.second));
+
+            Map exact(depthMax, stripes, width);
+            exact.load(survivors.data(), survivors.size());
+
+            for ( const size_t budget : BUDGETS )
+            {
+                Map built(depthMax, stripes, width);
+                handle_list handles;
+                fill_held<Map, Handled>(built, held, drop, handles);
+
+                const size_t heldsize = built.size();
+
+                {
+                    qmap::stripe_builder<Map> builder(built, budget);
+
+                    mismatches += budget == 1 && builder.block_items() != 1;
+
+                    size_t at = 0;
+                    size_t finished = 0;
+                    while ( at < fed.size() )
+                    {
+                        const size_t chunk = std::min(fed.size() - at, size_t(1 + gen.NextBounded(3000)));
+                        mismatches += !builder.feed(fed.data() + at, chunk);
+                        at += chunk;
+
+                        //The map only changes at finish()
+                        mismatches += builder.staged() != at - finished || built.size() != heldsize + finished;
+
+                        if ( gen.NextBounded(8) == 0 )
+                        {
+                            mismatches += !builder.finish() || builder.staged() != 0 || built.size() != heldsize + at
+                                       || built.slots() != built.size();
+                            finished = at;
+                        }
+                    }
+
+                    //Even and odd trials leave the last items to finish() and to the destructor
+                    if ( trial % 2 == 0 )
+                        mismatches += !builder.finish();
+                }
+
+                mismatches += contents(built) != expect
+                           || built.size() != expect.size()
+                           || built.slots() != built.size()
+                           || built.query_margin() != exact.query_margin();
+
+                for ( size_t q = 0; q < 30; q++ )
+                {
+                    const size_t depthMin = gen.NextBounded(depthMax + 200);
+                    const size_t rangeMax = depthMin + gen.NextBounded(depthMax / 8 + 1);
+                    const int64_t secMin  = int64_t(gen.NextBounded(100000));
+                    const int64_t secMax  = secMin + int64_t(gen.NextBounded(20000));
+
+                    mismatches += collect([&](auto&& f){ return built.query(depthMin, rangeMax, f); })
+                               != collect([&](auto&& f){ return exact.query(depthMin, rangeMax, f); });
+                    mismatches += collect([&](auto&& f){ return built.query_bounded(depthMin, rangeMax, secMin, secMax, f); })
+                               != collect([&](auto&& f){ return exact.query_bounded(depthMin, rangeMax, secMin, secMax, f); });
+                }
+
+                //Handles of held items follow them through the build, erased ones stay dead
+                if constexpr ( Handled )
+                {
+                    for ( size_t i = 0; i < handles.size(); i++ )
+                    {
+                        const int* value = built.get(handles[i]);
+                        const bool live  = ( int(i) + 1 ) % 5 != drop;
+
+                        mismatches += live ? value == nullptr || *value != -1 - int(i) : value != nullptr;
+                    }
+                }
+
+                //Built map keeps working as any other
+                built.add(typename Map::value_type(depthMax / 2, 1 << 30));
+                mismatches += built.size() != expect.size() + 1;
+            }
+        }
+
+        std::printf("%s,%zu,%zu,%zu\n", name, cfg.trials, cfg.items, mismatches);
+
+        return mismatches;
+    };
+
+};  //end of anonymous namespace
+
+int main(int argc, char** argv)
+{
+    config cfg;
+    cfg.seed   = arg_count(argc, argv, "--seed", cfg.seed);
+    cfg.trials = arg_count(argc, argv, "--trials", cfg.trials);
+    cfg.items  = arg_count(argc, argv, "--items", cfg.items);
+
+    std::printf("maps,trials,items,mismatches\n");
+
+    size_t mismatches = 0;
+    mismatches += run_trials<map_aos>(cfg, "aos");
+    mismatches += run_trials<map_soa_u32>(cfg, "soa_u32");
+    mismatches += run_trials<map_handles, true>(cfg, "handles soa_u32");
+    mismatches += run_trials<map_tracked>(cfg, "aos tracked");
+    mismatches += run_trials<map_mapped>(cfg, "mapped");
+
+    return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,174 @@
+///Differential test of stripe_grid cell queries against a brute force scan
+///--- ( Interleaves adds ( inside, outside and on the edges of the world ), restripes, shrink() and clear() with )
+///--- ( query_rect / query_neighbours / query_cell, which must visit exactly the items of the cells they cover )
+///
+///  g++ -std=c++17 -O1 -g -fsanitize=address,undefined -Isrc/include test/stripe_grid_test.cpp -o stripe_grid_test
+///  ./stripe_grid_test --trials 20 --steps 2000 --seed 11          ( exits 1 if any query disagrees with the scan )
+///
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include <stripe_grid.hpp>
+#include <_Utilities/uti_WorkloadGenerator.h>
+
+namespace
+{
+    ///Test run settings
+    struct config
+    {
+        uint64_t seed  = 11;        ///< workload generator seed
+        size_t trials  = 20;        ///< grids built
+        size_t steps   = 2000;      ///< random operations per trial
+    };
+
+    ///Returns value following --name in argv, or fallback
+    size_t
+        arg_count(int argc,
+                  char** argv,
+                  const char* name,
+                  const size_t fallback)
+    {
+        for ( int i = 1; i + 1 < argc; i++ )
+        {
+            if ( std::strcmp(argv[i], name) == 0 )
+                return std::strtoull(argv[i + 1], nullptr, 10);
+        }
+
+        return fallback;
+    };
+
+    ///Compares ids visited by a query over cells [col0, col1] x [row0, row1] with a scan - returns amount of mismatches
+    template <typename Q>
+    size_t
+        check_cells(qmap::stripe_grid<int>& grid,
+                    const std::vector<Prs::xyPr<int>>& points,
+                    const long col0,
+                    const long row0,
+                    const long col1,
+                    const long row1,
+                    Q&& query)
+    {
+        std::vector<int> seen(points.size(), 0);
+        size_t calls = 0;
+        const size_t visited = query([&](const auto& item){ seen[item._2]++; calls++; });
+
+        size_t mismatches = visited != calls;
+        for ( size_t i = 0; i < points.size(); i++ )
+        {
+            const long col = long(grid.cell_col(points[i].x));
+            const long row = long(grid.cell_row(points[i].y));
+            const int expect = col >= col0 && col <= col1 && row >= row0 && row <= row1;
+
+            mismatches += seen[i] != expect;
+        }
+
+        return mismatches;
+    };
+
+    ///Runs cfg.trials random operation sequences - returns amount of mismatches
+    size_t
+        run_trials(const config& cfg)
+    {
+        uti_WorkloadGenerator gen(cfg.seed);
+        size_t mismatches = 0;
+
+        for ( size_t trial = 0; trial < cfg.trials; trial++ )
+        {
+            const int width  = 1000 + int(gen.NextBounded(100000));
+            const int height = 1000 + int(gen.NextBounded(100000));
+            const size_t cols = 1 + gen.NextBounded(40);
+            const size_t rows = 1 + gen.NextBounded(40);
+
+            //Narrow cells so adds restripe often
+            qmap::stripe_grid<int> grid(width, height, cols, rows, 1 + gen.NextBounded(4));
+            std::vector<Prs::xyPr<int>> points;
+
+            for ( size_t step = 0; step < cfg.steps; step++ )
+            {
+                const uint64_t op = gen.NextBounded(100);
+
+                ///ADD ( a few land outside the world and clamp into edge cells )
+                if ( op < 60 )
+                {
+                    const int x = int(gen.NextBounded(width + 400)) - 200;
+                    const int y = int(gen.NextBounded(height + 400)) - 200;
+
+                    if ( !grid.add(x, y, int(points.size())) )
+                        mismatches++;
+                    points.push_back({ x, y });
+                }
+                ///QUERY_RECT ( every 8th one inverted )
+                else if ( op < 80 )
+                {
+                    int x0 = int(gen.NextBounded(width + 400)) - 200;
+                    int y0 = int(gen.NextBounded(height + 400)) - 200;
+                    int x1 = x0 + int(gen.NextBounded(width / 3 + 1));
+                    int y1 = y0 + int(gen.NextBounded(height / 3 + 1));
+                    if ( op % 8 == 0 )
+                        std::swap(x0, x1);
+
+                    mismatches += check_cells(grid, points,
+                                              long(grid.cell_col(x0)), long(grid.cell_row(y0)),
+                                              long(grid.cell_col(x1)), long(grid.cell_row(y1)),
+                                              [&](auto&& f){ return grid.query_rect(x0, y0, x1, y1, f); });
+                }
+                ///QUERY_NEIGHBOURS
+                else if ( op < 90 )
+                {
+                    const int x = int(gen.NextBounded(width));
+                    const int y = int(gen.NextBounded(height));
+                    const long col = long(grid.cell_col(x));
+                    const long row = long(grid.cell_row(y));
+
+                    mismatches += check_cells(grid, points, col - 1, row - 1, col + 1, row + 1,
+                                              [&](auto&& f){ return grid.query_neighbours(x, y, f); });
+                }
+                ///QUERY_CELL
+                else if ( op < 95 )
+                {
+                    const size_t col = gen.NextBounded(grid.cols());
+                    const size_t row = gen.NextBounded(grid.rows());
+
+                    mismatches += check_cells(grid, points, long(col), long(row), long(col), long(row),
+                                              [&](auto&& f){ return grid.query_cell(col, row, f); });
+                }
+                ///SHRINK
+                else if ( op < 99 )
+                {
+                    grid.shrink();
+                    if ( grid.slots() != grid.size() )
+                        mismatches++;
+                }
+                ///CLEAR
+                else
+                {
+                    grid.clear();
+                    points.clear();
+                }
+
+                if ( grid.size() != points.size() )
+                    mismatches++;
+            }
+        }
+
+        std::printf("stripe_grid,%zu,%zu,%zu\n", cfg.trials, cfg.steps, mismatches);
+
+        return mismatches;
+    };
+
+};  //end of anonymous namespace
+
+int main(int argc, char** argv)
+{
+    config cfg;
+    cfg.seed   = arg_count(argc, argv, "--seed", cfg.seed);
+    cfg.trials = arg_count(argc, argv, "--trials", cfg.trials);
+    cfg.steps  = arg_count(argc, argv, "--steps", cfg.steps);
+
+    std::printf("map,trials,steps,mismatches\n");
+
+    return run_trials(cfg) == 0 ? 0 : 1;
+}
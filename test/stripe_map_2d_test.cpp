@@ -0,0 +1,154 @@
+///Differential test of stripe_map_2d rect queries against a brute force scan
+///--- ( Every point inside a rect must be reported exactly once, the curve ranges of a query must be sorted and disjoint, )
+///--- ( and inverted rects must report nothing - for both curves, before and after shrink() and clear() )
+///
+///  g++ -std=c++17 -O1 -g -fsanitize=address,undefined -Isrc/include test/stripe_map_2d_test.cpp -o stripe_map_2d_test
+///  ./stripe_map_2d_test --trials 20 --queries 300 --seed 11       ( exits 1 if any query misses or repeats a point )
+///
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include <stripe_map_2d.hpp>
+#include <_Utilities/uti_WorkloadGenerator.h>
+
+namespace
+{
+    ///Test run settings
+    struct config
+    {
+        uint64_t seed  = 11;        ///< workload generator seed
+        size_t trials  = 20;        ///< maps built per curve
+        size_t queries = 300;       ///< rect queries per trial
+    };
+
+    ///Returns value following --name in argv, or fallback
+    size_t
+        arg_count(int argc,
+                  char** argv,
+                  const char* name,
+                  const size_t fallback)
+    {
+        for ( int i = 1; i + 1 < argc; i++ )
+        {
+            if ( std::strcmp(argv[i], name) == 0 )
+                return std::strtoull(argv[i + 1], nullptr, 10);
+        }
+
+        return fallback;
+    };
+
+    ///Runs one rect query on map and compares it with points - returns amount of mismatches
+    template <typename Map>
+    size_t
+        check_rect(Map& map,
+                   const std::vector<Prs::xyPr<int>>& points,
+                   const int xmin,
+                   const int ymin,
+                   const int xmax,
+                   const int ymax)
+    {
+        size_t mismatches = 0;
+
+        std::vector<int> seen(points.size(), 0);
+        size_t calls = 0;
+        const size_t found = map.query(xmin, ymin, xmax, ymax, [&](const auto& item){ seen[item._2]++; calls++; });
+
+        if ( found != calls )
+            mismatches++;
+
+        //Inverted rects report nothing and leave no ranges behind
+        if ( xmin > xmax || ymin > ymax )
+            return mismatches + ( found != 0 ) + !map.last_ranges().empty();
+
+        for ( size_t i = 0; i < points.size(); i++ )
+        {
+            const bool inside = points[i].x >= xmin && points[i].x <= xmax && points[i].y >= ymin && points[i].y <= ymax;
+            if ( seen[i] > 1 || ( inside && seen[i] == 0 ) )
+                mismatches++;
+        }
+
+        const auto & ranges = map.last_ranges();
+        for ( size_t r = 0; r < ranges.size(); r++ )
+        {
+            if ( ranges[r]._1 > ranges[r]._2 || ( r != 0 && ranges[r]._1 <= ranges[r - 1]._2 ) )
+                mismatches++;
+        }
+
+        return mismatches;
+    };
+
+    ///Runs cfg.trials maps of Curve - returns amount of mismatches
+    template <typename Curve>
+    size_t
+        run_trials(const config& cfg,
+                   const char* name)
+    {
+        uti_WorkloadGenerator gen(cfg.seed);
+        size_t mismatches = 0;
+
+        for ( size_t trial = 0; trial < cfg.trials; trial++ )
+        {
+            const int axis = 1000 + int(gen.NextBounded(1000000));
+            qmap::stripe_map_2d<int, Curve> map(axis, size_t(1) << ( 2 * ( 2 + gen.NextBounded(5) ) ));
+
+            //Clustered points so some cells hold many items and most hold none
+            uti_WorkloadGenerator::Settings settings;
+            settings.distribution = trial % 2 == 0 ? uti_WorkloadGenerator::Distribution::Clusters
+                                                   : uti_WorkloadGenerator::Distribution::Uniform;
+            settings.depthMax = axis;
+
+            std::vector<Prs::xyPr<int>> points(200 + gen.NextBounded(3000));
+            gen.GeneratePoints(settings, points.data(), points.size());
+            for ( size_t i = 0; i < points.size(); i++ )
+                map.add(points[i].x, points[i].y, int(i));
+
+            if ( map.size() != points.size() )
+                mismatches++;
+
+            for ( size_t q = 0; q < cfg.queries; q++ )
+            {
+                //Rects reach past both axis ends, and every 16th one is inverted
+                const int x0 = int(gen.NextBounded(axis + 200)) - 100;
+                const int y0 = int(gen.NextBounded(axis + 200)) - 100;
+                const int x1 = x0 + int(gen.NextBounded(axis / 4 + 1));
+                const int y1 = y0 + int(gen.NextBounded(axis / 4 + 1));
+
+                if ( q % 16 == 15 )
+                    mismatches += check_rect(map, points, x1 + 1, y0, x0, y1);
+                else
+                    mismatches += check_rect(map, points, x0, y0, x1, y1);
+
+                if ( q == cfg.queries / 2 )
+                    map.shrink();
+            }
+
+            map.clear();
+            if ( map.size() != 0 || map.query(0, 0, axis, axis, [](const auto&){}) != 0 )
+                mismatches++;
+        }
+
+        std::printf("%s,%zu,%zu,%zu\n", name, cfg.trials, cfg.queries, mismatches);
+
+        return mismatches;
+    };
+
+};  //end of anonymous namespace
+
+int main(int argc, char** argv)
+{
+    config cfg;
+    cfg.seed    = arg_count(argc, argv, "--seed", cfg.seed);
+    cfg.trials  = arg_count(argc, argv, "--trials", cfg.trials);
+    cfg.queries = arg_count(argc, argv, "--queries", cfg.queries);
+
+    std::printf("curve,trials,queries,mismatches\n");
+
+    size_t mismatches = 0;
+    mismatches += run_trials<qmap::implem::curve_morton>(cfg, "morton");
+    mismatches += run_trials<qmap::implem::curve_hilbert>(cfg, "hilbert");
+
+    return mismatches == 0 ? 0 : 1;
+}
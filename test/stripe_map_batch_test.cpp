@@ -0,0 +1,177 @@
+///Brute force test of stripe_map::query_batch
+///--- ( Random maps, some holding tombstones, answer batches of ranges that overlap, repeat, come sorted or not, reach past the )
+///--- ( axis end or are inverted - every range must get exactly the items a scan of the held items finds in it, and nothing else )
+///
+///  g++ -std=c++17 -O1 -g -fsanitize=address,undefined -Isrc/include test/stripe_map_batch_test.cpp -o stripe_map_batch_test
+///  ./stripe_map_batch_test --trials 40 --items 5000 --seed 11    ( exits 1 if any range disagrees with the scan )
+///
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include <stripe_map.hpp>
+#include <_Utilities/uti_WorkloadGenerator.h>
+
+namespace
+{
+    ///Sorted ( key, id ) pairs
+    typedef std::vector<std::pair<size_t, int>> pair_list;
+    ///Query range [first, last]
+    typedef Prs::tpsPr<size_t, size_t> range_type;
+
+    typedef qmap::stripe_map<int> map_aos;
+    typedef qmap::stripe_map<int, qmap::growth_double, qmap::index_adaptive, qmap::storage_soa<uint32_t>> map_soa_u32;
+    typedef qmap::stripe_map<int, qmap::growth_double, qmap::index_shrunk, qmap::storage_handles<qmap::storage_aos<>>> map_handles_shrunk;
+
+    ///Test run settings
+    struct config
+    {
+        uint64_t seed  = 11;        ///< workload generator seed
+        size_t trials  = 40;        ///< maps built per policy set
+        size_t items   = 5000;      ///< most items per map
+    };
+
+    ///Returns value following --name in argv, or fallback
+    size_t
+        arg_count(int argc,
+                  char** argv,
+                  const char* name,
+                  const size_t fallback)
+    {
+        for ( int i = 1; i + 1 < argc; i++ )
+        {
+            if ( std::strcmp(argv[i], name) == 0 )
+                return std::strtoull(argv[i + 1], nullptr, 10);
+        }
+
+        return fallback;
+    };
+
+    ///Sorted ( key, id ) pairs of held with key within range
+    pair_list
+        scan(const pair_list& held,
+             const range_type& range)
+    {
+        pair_list pairs;
+        for ( const auto & pair : held )
+        {
+            if ( pair.first >= range._1 && pair.first <= range._2 )
+                pairs.push_back(pair);
+        }
+
+        return pairs;
+    };
+
+    ///Random range of a batch - short ones, ones spanning many stripes, inverted ones and ones past the axis end
+    range_type
+        make_range(uti_WorkloadGenerator& gen,
+                   const size_t depthMax)
+    {
+        const uint64_t kind = gen.NextBounded(16);
+        const size_t first  = gen.NextBounded(depthMax + depthMax / 4 + 1);
+
+        if ( kind == 0 )
+            return range_type(first + 1 + gen.NextBounded(100), first);
+        if ( kind == 1 )
+            return range_type(first, SIZE_MAX);
+        if ( kind < 4 )
+            return range_type(first, first + gen.NextBounded(depthMax / 2 + 1));
+
+        return range_type(first, first + gen.NextBounded(depthMax / 64 + 1));
+    };
+
+    ///Runs cfg.trials maps of Map, each answering several batches - returns amount of mismatches
+    template <typename Map>
+    size_t
+        run_trials(const config& cfg,
+                   const char* name)
+    {
+        uti_WorkloadGenerator gen(cfg.seed);
+        size_t mismatches = 0;
+
+        for ( size_t trial = 0; trial < cfg.trials; trial++ )
+        {
+            const size_t depthMax = 1000 + gen.NextBounded(1000000);
+
+            //Keys reach past the axis end, where they pile into the last stripe
+            Map map(depthMax, 1 + gen.NextBounded(2000), 1 + gen.NextBounded(8));
+            const size_t count = gen.NextBounded(cfg.items + 1);
+            for ( size_t i = 0; i < count; i++ )
+                map.add(typename Map::value_type(gen.NextBounded(depthMax + depthMax / 8), int(i)));
+
+            //Every other map erases some items, half of those keeping tombstones
+            const int drop = int(gen.NextBounded(6));
+            if ( trial % 2 == 1 )
+            {
+                map.set_deferred_erase(trial % 4 == 1);
+                map.remove_if(map.begin(), map.end(), [drop](const auto& item){ return item._2 % 6 == drop; });
+            }
+
+            pair_list held;
+            map.for_each([&](const auto& item){ held.push_back({ size_t(item._1), int(item._2) }); });
+            std::sort(held.begin(), held.end());
+
+            for ( size_t batch = 0; batch < 8; batch++ )
+            {
+                std::vector<range_type> ranges(gen.NextBounded(200));
+                for ( auto & range : ranges )
+                    range = make_range(gen, depthMax);
+
+                //Some batches come sorted by start, some hold one range many times
+                if ( batch % 4 == 1 )
+                    std::sort(ranges.begin(), ranges.end(),
+                              [](const range_type& a, const range_type& b){ return a._1 < b._1; });
+                if ( batch % 4 == 2 && !ranges.empty() )
+                    std::fill(ranges.begin() + ranges.size() / 2, ranges.end(), ranges[0]);
+
+                std::vector<pair_list> reported(ranges.size());
+                size_t calls = 0;
+                const size_t found = map.query_batch(ranges.data(), ranges.size(), [&](const size_t r, const auto& item)
+                {
+                    calls++;
+                    if ( r >= ranges.size() )
+                        mismatches++;
+                    else
+                        reported[r].push_back({ size_t(item._1), int(item._2) });
+                });
+
+                size_t expected = 0;
+                for ( size_t r = 0; r < ranges.size(); r++ )
+                {
+                    const pair_list inrange = scan(held, ranges[r]);
+                    expected += inrange.size();
+
+                    std::sort(reported[r].begin(), reported[r].end());
+                    mismatches += reported[r] != inrange;
+                }
+
+                mismatches += found != calls || found != expected;
+            }
+        }
+
+        std::printf("%s,%zu,%zu,%zu\n", name, cfg.trials, cfg.items, mismatches);
+
+        return mismatches;
+    };
+
+};  //end of anonymous namespace
+
+int main(int argc, char** argv)
+{
+    config cfg;
+    cfg.seed   = arg_count(argc, argv, "--seed", cfg.seed);
+    cfg.trials = arg_count(argc, argv, "--trials", cfg.trials);
+    cfg.items  = arg_count(argc, argv, "--items", cfg.items);
+
+    std::printf("maps,trials,items,mismatches\n");
+
+    size_t mismatches = 0;
+    mismatches += run_trials<map_aos>(cfg, "aos");
+    mismatches += run_trials<map_soa_u32>(cfg, "soa_u32");
+    mismatches += run_trials<map_handles_shrunk>(cfg, "handles shrunk");
+
+    return mismatches == 0 ? 0 : 1;
+}
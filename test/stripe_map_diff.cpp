@@ -0,0 +1,344 @@
+///Differential test of stripe_map against std::multimap
+///--- ( Runs seeded random add / erase / remove_if / clear / clear_depth / shrink / compact sequences on several policy sets, )
+///--- ( switching deferred erase on and off as they go, and )
+///--- ( compares contents, size(), query(), for_each() and begin(depth)/end(depth) with a multimap at every check step )
+///--- ( storage_handles sets also erase, re-key and resolve items through handles - stale handles must stop resolving )
+///
+///  g++ -std=c++17 -O1 -g -fsanitize=address,undefined -Isrc/include test/stripe_map_diff.cpp -o stripe_map_diff
+///  ./stripe_map_diff --trials 40 --steps 3000 --seed 11          ( exits 1 if any map disagrees with the reference )
+///
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include <stripe_map.hpp>
+#include <_Utilities/uti_WorkloadGenerator.h>
+
+namespace
+{
+    ///Reference contents ( key -> id )
+    typedef std::multimap<size_t, int> reference;
+    ///Sorted ( key, id ) pairs
+    typedef std::vector<std::pair<size_t, int>> pair_list;
+
+    ///Differential run settings
+    struct config
+    {
+        uint64_t seed  = 11;        ///< workload generator seed
+        size_t trials  = 40;        ///< maps built per policy set
+        size_t steps   = 3000;      ///< random operations per trial
+        size_t depth   = 100000;    ///< depthMax of every map
+    };
+
+    ///Returns value following --name in argv, or fallback
+    size_t
+        arg_count(int argc,
+                  char** argv,
+                  const char* name,
+                  const size_t fallback)
+    {
+        for ( int i = 1; i + 1 < argc; i++ )
+        {
+            if ( std::strcmp(argv[i], name) == 0 )
+                return std::strtoull(argv[i + 1], nullptr, 10);
+        }
+
+        return fallback;
+    };
+
+    ///Sorted ( key, id ) pairs of the reference
+    pair_list
+        contents(const reference& ref)
+    {
+        pair_list pairs(ref.begin(), ref.end());
+        std::sort(pairs.begin(), pairs.end());
+
+        return pairs;
+    };
+    ///Sorted ( key, id ) pairs reached by iterating map
+    template <typename Map>
+    pair_list
+        contents(Map& map)
+    {
+        pair_list pairs;
+        for ( auto && item : map )
+            pairs.push_back({ size_t(item._1), item._2 });
+
+        std::sort(pairs.begin(), pairs.end());
+
+        return pairs;
+    };
+    ///Erases one ( key, id ) pair from the reference - returns false if it was not there
+    bool
+        erase_reference(reference& ref,
+                        const size_t key,
+                        const int id)
+    {
+        const auto range = ref.equal_range(key);
+        for ( auto i = range.first; i != range.second; i++ )
+        {
+            if ( i->second == id )
+            {
+                ref.erase(i);
+                return true;
+            }
+        }
+
+        return false;
+    };
+
+    ///Returns true if ( key, id ) is in the reference
+    bool
+        in_reference(const reference& ref,
+                     const size_t key,
+                     const int id)
+    {
+        const auto range = ref.equal_range(key);
+        for ( auto i = range.first; i != range.second; i++ )
+        {
+            if ( i->second == id )
+                return true;
+        }
+
+        return false;
+    };
+
+    ///Compares map with ref over every read path - returns amount of mismatches
+    ///--- ( Iterators and begin(depth)/end(depth) step over tombstoned items, so every path must match ref exactly )
+    template <typename Map>
+    size_t
+        check(Map& map,
+              const reference& ref,
+              uti_WorkloadGenerator& gen)
+    {
+        size_t mismatches = 0;
+
+        const pair_list expected = contents(ref);
+        const pair_list iterated = contents(map);
+        if ( map.size() != ref.size() || iterated != expected )
+            mismatches++;
+
+        //Stepping back from end() must visit the same items
+        pair_list reversed;
+        for ( auto i = map.end(); i != map.begin(); )
+        {
+            --i;
+            reversed.push_back({ size_t(i->_1), i->_2 });
+        }
+        std::sort(reversed.begin(), reversed.end());
+        if ( reversed != expected )
+            mismatches++;
+
+        pair_list visited;
+        const size_t visitcount = map.for_each([&](const auto& item){ visited.push_back({ size_t(item._1), item._2 }); });
+        std::sort(visited.begin(), visited.end());
+        if ( visitcount != ref.size() || visited != expected )
+            mismatches++;
+
+        //Most keys sit below 2000, so ranges there cross many stripes
+        const size_t lo = gen.NextBounded(3000);
+        const size_t hi = lo + gen.NextBounded(3000);
+
+        size_t inrange = 0;
+        for ( auto & pair : ref )
+            inrange += pair.first >= lo && pair.first <= hi;
+
+        if ( map.query(lo, hi, [](const auto&){}) != inrange )
+            mismatches++;
+
+        //begin(depth)/end(depth) spans whole stripes - every key in [lo, hi] must be inside
+        size_t spanned = 0;
+        const auto end = map.end(hi);
+        for ( auto i = map.begin(lo); i != end; i++ )
+            spanned += i->_1 >= lo && i->_1 <= hi;
+
+        if ( spanned != inrange )
+            mismatches++;
+
+        return mismatches;
+    };
+
+    ///Runs cfg.trials random operation sequences on Map - returns amount of mismatches
+    ///--- ( Handled maps add through add(item, handle) and mix in handle erase / update_key / get steps )
+    template <typename Map, bool Handled = false>
+    size_t
+        run_trials(const config& cfg,
+                   const char* name)
+    {
+        typedef typename Map::value_type value_type;
+        typedef typename Map::handle_type handle_type;
+
+        uti_WorkloadGenerator gen(cfg.seed);
+        size_t mismatches = 0;
+
+        for ( size_t trial = 0; trial < cfg.trials; trial++ )
+        {
+            Map map(cfg.depth, 8 + gen.NextBounded(3000), 1 + gen.NextBounded(4));
+            reference ref;
+            int id = 0;
+            bool deferred = false;
+
+            std::vector<handle_type> handles;   //handle issued for each id
+            std::vector<size_t> keys;           //current key of each id
+
+            for ( size_t step = 0; step < cfg.steps; step++ )
+            {
+                const uint64_t op = gen.NextBounded(100);
+
+                ///HANDLE ERASE / UPDATE_KEY / GET ( ids whose item is gone must not resolve )
+                if ( Handled && op >= 62 && op < 70 && id != 0 )
+                {
+                    if constexpr ( Handled )
+                    {
+                        const int target = int(gen.NextBounded(id));
+                        const bool live  = in_reference(ref, keys[target], target);
+
+                        if ( op < 65 )
+                        {
+                            if ( map.erase(handles[target]) != live )
+                                mismatches++;
+                            if ( live )
+                                erase_reference(ref, keys[target], target);
+                        }
+                        else if ( op < 68 )
+                        {
+                            const size_t key = gen.NextBounded(100) < 80 ? gen.NextBounded(2000) : gen.NextBounded(cfg.depth);
+                            if ( map.update_key(handles[target], key) != live )
+                                mismatches++;
+                            if ( live )
+                            {
+                                erase_reference(ref, keys[target], target);
+                                ref.insert({ key, target });
+                                keys[target] = key;
+                            }
+                        }
+                        else
+                        {
+                            const int* value = map.get(handles[target]);
+                            if ( ( value != nullptr ) != live || ( value != nullptr && *value != target ) )
+                                mismatches++;
+                        }
+                    }
+                }
+                ///ADD ( mostly low keys so stripes fill and restripe )
+                else if ( op < 70 )
+                {
+                    const size_t key = gen.NextBounded(100) < 80 ? gen.NextBounded(2000) : gen.NextBounded(cfg.depth);
+                    if constexpr ( Handled )
+                    {
+                        handles.push_back(handle_type());
+                        keys.push_back(key);
+                        map.add(value_type(key, id), handles.back());
+                    }
+                    else
+                        map.add(value_type(key, id));
+
+                    ref.insert({ key, id });
+                    id++;
+                }
+                ///ERASE THROUGH ITERATOR
+                else if ( op < 78 )
+                {
+                    if ( map.size() == 0 )
+                        continue;
+
+                    auto item = map.begin() + int(gen.NextBounded(map.size()));
+                    const size_t key = item->_1;
+                    const int itemid = item->_2;
+
+                    //Iterators never land on a tombstone, so the item is always held
+                    const bool held   = erase_reference(ref, key, itemid);
+                    const auto erased = map.erase(item);
+                    if ( !held || !erased._1 || erased._2 != ref.size() )
+                        mismatches++;
+                }
+                ///REMOVE_IF
+                else if ( op < 82 )
+                {
+                    const int mod = 2 + int(gen.NextBounded(5));
+                    const auto removed = map.remove_if(map.begin(), map.end(), [&](const auto& item){ return item._2 % mod == 0; });
+
+                    for ( auto i = ref.begin(); i != ref.end(); )
+                        i = i->second % mod == 0 ? ref.erase(i) : std::next(i);
+
+                    if ( removed._2 != ref.size() )
+                        mismatches++;
+                }
+                ///CLEAR
+                else if ( op < 83 )
+                {
+                    map.clear();
+                    ref.clear();
+                }
+                ///CLEAR_DEPTH ( empties the stripe holding key )
+                else if ( op < 85 )
+                {
+                    const size_t key = gen.NextBounded(2000);
+                    const size_t stripe = std::min(key / map.depth(), map.stripes() - 1);
+
+                    const auto cleared = map.clear_depth(key);
+                    for ( auto i = ref.begin(); i != ref.end(); )
+                        i = std::min(i->first / map.depth(), map.stripes() - 1) == stripe ? ref.erase(i) : std::next(i);
+
+                    if ( cleared._2 != ref.size() )
+                        mismatches++;
+                }
+                ///DEFERRED ERASE ON / OFF ( switching off compacts )
+                else if ( op < 87 )
+                {
+                    deferred = !deferred;
+                    map.set_deferred_erase(deferred);
+                    if ( !deferred && map.tombstones() != 0 )
+                        mismatches++;
+                }
+                ///COMPACT
+                else if ( op < 88 )
+                {
+                    const size_t tombs = map.tombstones();
+                    if ( map.compact() != tombs || map.tombstones() != 0 )
+                        mismatches++;
+                }
+                ///SHRINK ( compacts first )
+                else if ( op < 90 )
+                {
+                    map.shrink();
+                    if ( map.tombstones() != 0 )
+                        mismatches++;
+                }
+                ///CHECK
+                else
+                    mismatches += check(map, ref, gen);
+            }
+
+            mismatches += check(map, ref, gen);
+        }
+
+        std::printf("%s,%zu,%zu,%zu\n", name, cfg.trials, cfg.steps, mismatches);
+
+        return mismatches;
+    };
+
+};  //end of anonymous namespace
+
+int main(int argc, char** argv)
+{
+    config cfg;
+    cfg.seed   = arg_count(argc, argv, "--seed", cfg.seed);
+    cfg.trials = arg_count(argc, argv, "--trials", cfg.trials);
+    cfg.steps  = arg_count(argc, argv, "--steps", cfg.steps);
+
+    std::printf("maps,trials,steps,mismatches\n");
+
+    size_t mismatches = 0;
+    mismatches += run_trials<qmap::stripe_map<int>>(cfg, "aos");
+    mismatches += run_trials<qmap::stripe_map<int, qmap::growth_exact, qmap::index_gapped, qmap::storage_soa<uint32_t>>>(cfg, "soa_u32 exact gapped");
+    mismatches += run_trials<qmap::stripe_map<int, qmap::growth_fixed<4>, qmap::index_shrunk, qmap::storage_aos<uint32_t>>>(cfg, "u32 fixed shrunk");
+    mismatches += run_trials<qmap::stripe_map<int, qmap::growth_double, qmap::index_adaptive, qmap::storage_handles<>>, true>(cfg, "handles");
+    mismatches += run_trials<qmap::stripe_map<int, qmap::growth_exact, qmap::index_gapped, qmap::storage_handles<qmap::storage_soa<uint32_t>>>, true>(cfg, "handles soa_u32 exact gapped");
+
+    return mismatches == 0 ? 0 : 1;
+}
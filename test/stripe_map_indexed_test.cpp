@@ -0,0 +1,236 @@
+///Differential test of stripe_map_indexed against a brute force scan of its columns
+///--- ( Interleaves adds, shrink(), gather() after column edits and clear() with query() and query_spans() - query must visit )
+///--- ( exactly the indices in range, and every column read through a row must match the bound column at that index )
+///
+///  g++ -std=c++17 -O1 -g -fsanitize=address,undefined -Isrc/include test/stripe_map_indexed_test.cpp -o stripe_map_indexed_test
+///  ./stripe_map_indexed_test --trials 20 --steps 2000 --seed 11   ( exits 1 if any query or column read disagrees )
+///
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include <stripe_map_indexed.hpp>
+#include <_Utilities/uti_WorkloadGenerator.h>
+
+namespace
+{
+    ///Bound columns ( the last one stays unbound )
+    static constexpr size_t COL_AMNT  = 3;
+    static constexpr size_t COL_BOUND = 2;
+
+    typedef qmap::stripe_map_indexed<int, COL_AMNT> indexed_map;
+
+    ///Test run settings
+    struct config
+    {
+        uint64_t seed  = 11;        ///< workload generator seed
+        size_t trials  = 20;        ///< maps built
+        size_t steps   = 2000;      ///< random operations per trial
+    };
+
+    ///Returns value following --name in argv, or fallback
+    size_t
+        arg_count(int argc,
+                  char** argv,
+                  const char* name,
+                  const size_t fallback)
+    {
+        for ( int i = 1; i + 1 < argc; i++ )
+        {
+            if ( std::strcmp(argv[i], name) == 0 )
+                return std::strtoull(argv[i + 1], nullptr, 10);
+        }
+
+        return fallback;
+    };
+
+    ///Compares column reads at row with the bound columns at index - returns amount of mismatches
+    size_t
+        check_row(const indexed_map::columns& cols,
+                  const size_t row,
+                  const uint32_t index,
+                  const std::vector<int>* data)
+    {
+        size_t mismatches = 0;
+        for ( size_t col = 0; col < COL_BOUND; col++ )
+            mismatches += cols[col][row] != data[col][index];
+
+        return mismatches;
+    };
+
+    ///Runs query() over [depthMin, depthMax] and compares it with keys - returns amount of mismatches
+    size_t
+        check_query(indexed_map& map,
+                    const std::vector<size_t>& keys,
+                    const std::vector<int>* data,
+                    const size_t depthMin,
+                    const size_t depthMax)
+    {
+        std::vector<int> seen(keys.size(), 0);
+        size_t calls = 0;
+        size_t mismatches = 0;
+
+        const bool gathered = map.gathered();
+        const size_t found = map.query(depthMin, depthMax, [&](const uint32_t index, const size_t row, const auto& cols)
+        {
+            seen[index]++;
+            calls++;
+
+            //Gathered rows point back at their index, ungathered rows are the index
+            if ( gathered ? map.index_of(row) != index : row != index )
+                mismatches++;
+            mismatches += check_row(cols, row, index, data);
+        });
+
+        mismatches += found != calls;
+        for ( size_t i = 0; i < keys.size(); i++ )
+            mismatches += seen[i] != int(keys[i] >= depthMin && keys[i] <= depthMax);
+
+        return mismatches;
+    };
+
+    ///Runs query_spans() over [depthMin, depthMax] and compares it with keys - returns amount of mismatches
+    size_t
+        check_spans(indexed_map& map,
+                    const std::vector<size_t>& keys,
+                    const std::vector<int>* data,
+                    const size_t depthMin,
+                    const size_t depthMax)
+    {
+        std::vector<int> seen(keys.size(), 0);
+        size_t rows = 0;
+        size_t last = 0;
+        size_t mismatches = 0;
+
+        const size_t spanned = map.query_spans(depthMin, depthMax, [&](const size_t rowBegin, const size_t rowEnd, const auto& cols)
+        {
+            //Spans come in row order without overlapping
+            if ( rowBegin >= rowEnd || rowBegin < last || rowEnd > map.size() )
+            {
+                mismatches++;
+                return;
+            }
+
+            for ( size_t row = rowBegin; row < rowEnd; row++ )
+            {
+                const uint32_t index = map.index_of(row);
+                seen[index]++;
+                mismatches += check_row(cols, row, index, data);
+            }
+
+            rows += rowEnd - rowBegin;
+            last  = rowEnd;
+        });
+
+        //Whole stripes are spanned, so every key in range is covered and nothing twice
+        mismatches += spanned != rows || !map.gathered();
+        for ( size_t i = 0; i < keys.size(); i++ )
+            mismatches += seen[i] > 1 || ( keys[i] >= depthMin && keys[i] <= depthMax && seen[i] == 0 );
+
+        return mismatches;
+    };
+
+    ///Runs cfg.trials random operation sequences - returns amount of mismatches
+    size_t
+        run_trials(const config& cfg)
+    {
+        uti_WorkloadGenerator gen(cfg.seed);
+        size_t mismatches = 0;
+
+        for ( size_t trial = 0; trial < cfg.trials; trial++ )
+        {
+            const size_t depthMax = 1000 + gen.NextBounded(1000000);
+
+            //Narrow stripes so adds restripe often
+            indexed_map map(depthMax, 1 + gen.NextBounded(64), 1 + gen.NextBounded(8));
+
+            //Columns never reallocate so the bound pointers stay valid
+            std::vector<size_t> keys;
+            std::vector<int> data[COL_BOUND];
+            for ( size_t col = 0; col < COL_BOUND; col++ )
+            {
+                data[col].reserve(cfg.steps);
+                map.bind_column(col, data[col].data());
+            }
+
+            for ( size_t step = 0; step < cfg.steps; step++ )
+            {
+                const uint64_t op = gen.NextBounded(100);
+
+                ///ADD
+                if ( op < 50 )
+                {
+                    const size_t key = gen.NextBounded(depthMax);
+
+                    if ( !map.add(key, uint32_t(keys.size())) || map.gathered() )
+                        mismatches++;
+
+                    keys.push_back(key);
+                    for ( size_t col = 0; col < COL_BOUND; col++ )
+                        data[col].push_back(int(gen.NextBounded(1 << 30)));
+                }
+                ///QUERY / QUERY_SPANS ( ranges reach past the axis end, every 16th one is inverted )
+                else if ( op < 85 )
+                {
+                    size_t rangeMin = gen.NextBounded(depthMax + 100);
+                    size_t rangeMax = rangeMin + gen.NextBounded(depthMax / 8 + 1);
+                    if ( op % 16 < 2 )
+                        std::swap(rangeMin, rangeMax);
+
+                    if ( op % 2 == 0 )
+                        mismatches += check_query(map, keys, data, rangeMin, rangeMax);
+                    else
+                        mismatches += check_spans(map, keys, data, rangeMin, rangeMax);
+                }
+                ///SHRINK
+                else if ( op < 92 )
+                {
+                    //Empty maps keep their slots
+                    map.shrink();
+                    mismatches += !map.gathered() || ( map.size() != 0 && map.map().slots() != map.size() );
+                }
+                ///EDIT COLUMNS THEN GATHER
+                else if ( op < 99 )
+                {
+                    for ( size_t i = 0; i < keys.size(); i += 1 + gen.NextBounded(4) )
+                        data[gen.NextBounded(COL_BOUND)][i] = int(gen.NextBounded(1 << 30));
+
+                    map.gather();
+                    mismatches += !map.gathered();
+                }
+                ///CLEAR
+                else
+                {
+                    map.clear();
+                    keys.clear();
+                    for ( size_t col = 0; col < COL_BOUND; col++ )
+                        data[col].clear();
+
+                    mismatches += map.gathered();
+                }
+
+                if ( map.size() != keys.size() )
+                    mismatches++;
+            }
+        }
+
+        std::printf("stripe_map_indexed,%zu,%zu,%zu\n", cfg.trials, cfg.steps, mismatches);
+
+        return mismatches;
+    };
+
+};  //end of anonymous namespace
+
+int main(int argc, char** argv)
+{
+    config cfg;
+    cfg.seed   = arg_count(argc, argv, "--seed", cfg.seed);
+    cfg.trials = arg_count(argc, argv, "--trials", cfg.trials);
+    cfg.steps  = arg_count(argc, argv, "--steps", cfg.steps);
+
+    std::printf("map,trials,steps,mismatches\n");
+
+    return run_trials(cfg) == 0 ? 0 : 1;
+}
@@ -0,0 +1,185 @@
+///Differential test of stripe_map_loose queries against a brute force scan
+///--- ( Mixed object extents from points to larger than the coarsest level are added, queried, shrunk and cleared - )
+///--- ( a query must visit every object whose extent overlaps the range, and exactly the items its levels' margins reach )
+///
+///  g++ -std=c++17 -O1 -g -fsanitize=address,undefined -Isrc/include test/stripe_map_loose_test.cpp -o stripe_map_loose_test
+///  ./stripe_map_loose_test --trials 20 --steps 2000 --seed 11     ( exits 1 if any query misses or repeats an object )
+///
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include <stripe_map_loose.hpp>
+#include <_Utilities/uti_WorkloadGenerator.h>
+
+namespace
+{
+    ///Test run settings
+    struct config
+    {
+        uint64_t seed  = 11;        ///< workload generator seed
+        size_t trials  = 20;        ///< maps built
+        size_t steps   = 2000;      ///< random operations per trial
+    };
+
+    ///Object as the reference sees it
+    struct object
+    {
+        size_t key;
+        size_t extent;
+        size_t level;
+    };
+
+    ///Returns value following --name in argv, or fallback
+    size_t
+        arg_count(int argc,
+                  char** argv,
+                  const char* name,
+                  const size_t fallback)
+    {
+        for ( int i = 1; i + 1 < argc; i++ )
+        {
+            if ( std::strcmp(argv[i], name) == 0 )
+                return std::strtoull(argv[i + 1], nullptr, 10);
+        }
+
+        return fallback;
+    };
+
+    ///Extent spread over every level ( points, level sized objects and a few larger than the coarsest level )
+    size_t
+        random_extent(uti_WorkloadGenerator& gen,
+                      const size_t baseDepth,
+                      const size_t levels)
+    {
+        const uint64_t kind = gen.NextBounded(16);
+        if ( kind == 0 )
+            return 0;
+        if ( kind == 1 )
+            return ( baseDepth << levels ) + gen.NextBounded(baseDepth << levels);
+
+        return 1 + gen.NextBounded(baseDepth << gen.NextBounded(levels));
+    };
+
+    ///Runs one query over [depthMin, depthMax] and compares it with objects - returns amount of mismatches
+    size_t
+        check_query(qmap::stripe_map_loose<int>& map,
+                    const std::vector<object>& objects,
+                    const std::vector<size_t>& extMax,
+                    const size_t depthMin,
+                    const size_t depthMax)
+    {
+        std::vector<int> seen(objects.size(), 0);
+        size_t calls = 0;
+        const size_t found = map.query(depthMin, depthMax, [&](const auto& item){ seen[item._2]++; calls++; });
+
+        size_t mismatches = found != calls;
+        for ( size_t i = 0; i < objects.size(); i++ )
+        {
+            const object& obj = objects[i];
+            const size_t half   = obj.extent / 2;
+            const size_t margin = ( extMax[obj.level] + 1 ) >> 1;
+
+            //Objects overlapping the range must be seen, and the level margin decides the rest
+            const bool overlaps = obj.key + half >= depthMin && obj.key <= depthMax + half;
+            const bool reached  = obj.key + margin >= depthMin && obj.key <= depthMax + margin;
+
+            if ( seen[i] != int(reached) || ( overlaps && !reached ) )
+                mismatches++;
+        }
+
+        return mismatches;
+    };
+
+    ///Runs cfg.trials random operation sequences - returns amount of mismatches
+    size_t
+        run_trials(const config& cfg)
+    {
+        uti_WorkloadGenerator gen(cfg.seed);
+        size_t mismatches = 0;
+
+        for ( size_t trial = 0; trial < cfg.trials; trial++ )
+        {
+            const size_t depthMax  = 10000 + gen.NextBounded(1000000);
+            const size_t baseDepth = 1 + gen.NextBounded(256);
+
+            //Every other map picks its own level amount
+            qmap::stripe_map_loose<int> map(depthMax, baseDepth, trial % 2 == 0 ? 0 : 1 + gen.NextBounded(6),
+                                            1 + gen.NextBounded(8));
+
+            const size_t levels = map.levels();
+            std::vector<object> objects;
+            std::vector<size_t> extMax(levels, 0);
+
+            for ( size_t step = 0; step < cfg.steps; step++ )
+            {
+                const uint64_t op = gen.NextBounded(100);
+
+                ///ADD
+                if ( op < 60 )
+                {
+                    const size_t key    = gen.NextBounded(depthMax);
+                    const size_t extent = random_extent(gen, baseDepth, levels);
+
+                    //Finest level whose stripe depth fits extent, the last one takes the rest
+                    size_t level = 0;
+                    while ( level + 1 < levels && extent > ( baseDepth << level ) )
+                        level++;
+
+                    if ( !map.add(key, extent, int(objects.size())) || map.level_of(extent) != level )
+                        mismatches++;
+
+                    objects.push_back({ key, extent, level });
+                    extMax[level] = std::max(extMax[level], extent);
+                }
+                ///QUERY ( ranges reach past both axis ends, every 16th one is inverted )
+                else if ( op < 90 )
+                {
+                    const size_t depthMin = gen.NextBounded(depthMax + 2000);
+                    const size_t span     = gen.NextBounded(depthMax / 8 + 1);
+
+                    if ( op % 16 == 0 && span != 0 )
+                        mismatches += map.query(depthMin + span, depthMin, [](const auto&){}) != 0;
+                    else
+                        mismatches += check_query(map, objects, extMax, depthMin, depthMin + span);
+                }
+                ///SHRINK
+                else if ( op < 98 )
+                {
+                    map.shrink();
+                    if ( map.slots() != map.size() )
+                        mismatches++;
+                }
+                ///CLEAR
+                else
+                {
+                    map.clear();
+                    objects.clear();
+                    std::fill(extMax.begin(), extMax.end(), 0);
+                }
+
+                if ( map.size() != objects.size() )
+                    mismatches++;
+            }
+        }
+
+        std::printf("stripe_map_loose,%zu,%zu,%zu\n", cfg.trials, cfg.steps, mismatches);
+
+        return mismatches;
+    };
+
+};  //end of anonymous namespace
+
+int main(int argc, char** argv)
+{
+    config cfg;
+    cfg.seed   = arg_count(argc, argv, "--seed", cfg.seed);
+    cfg.trials = arg_count(argc, argv, "--trials", cfg.trials);
+    cfg.steps  = arg_count(argc, argv, "--steps", cfg.steps);
+
+    std::printf("map,trials,steps,mismatches\n");
+
+    return run_trials(cfg) == 0 ? 0 : 1;
+}
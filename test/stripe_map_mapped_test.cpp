@@ -0,0 +1,332 @@
+///Differential test of storage_mapped against heap storage
+///--- ( Runs seeded random add / load / remove_if / shrink / clear sequences on a file backed map and an aos twin of the same )
+///--- ( geometry, so restripe and shrink move items inside the mapping - contents, size(), slots(), query(), query_bounded() )
+///--- ( and query_margin() must match the twin, the backing file must never show up in its directory, and the store itself must )
+///--- ( keep held slots and read zero past them as it grows and shrinks )
+///
+///  g++ -std=c++17 -O1 -g -fsanitize=address,undefined -Isrc/include test/stripe_map_mapped_test.cpp -o stripe_map_mapped_test
+///  ./stripe_map_mapped_test --trials 20 --steps 2000 --seed 11   ( exits 1 if any mapped map differs, needs POSIX mmap )
+///
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <dirent.h>
+#include <unistd.h>
+
+#include <stripe_map.hpp>
+#include <_Utilities/uti_WorkloadGenerator.h>
+
+namespace
+{
+    ///Sorted ( key, id ) pairs
+    typedef std::vector<std::pair<size_t, int>> pair_list;
+
+    ///Directory backing files are created in ( made by main, removed once empty )
+    std::string test_dir;
+
+    ///Dir policy pointing storage_mapped at test_dir
+    struct TestDir
+    {
+        inline const char*
+            operator()() const {
+            return test_dir.c_str();
+        };
+    };
+
+    ///Secondary coordinate and extent of an id for the tracked set
+    struct IdSec
+    {
+        inline int64_t
+            operator()(const int id) const {
+            return ( int64_t(id) * 7919 ) % 100000;
+        };
+    };
+    struct IdExt
+    {
+        inline int64_t
+            operator()(const int id) const {
+            return id & 63;
+        };
+    };
+
+    typedef qmap::stripe_map<int> map_aos;
+    typedef qmap::stripe_map<int, qmap::growth_double, qmap::index_adaptive, qmap::storage_mapped<size_t, TestDir>> map_mapped;
+    typedef qmap::stripe_map<int, qmap::growth_double, qmap::index_adaptive, qmap::storage_mapped<uint32_t, TestDir>> map_mapped_u32;
+    typedef qmap::stripe_map<int, qmap::growth_double, qmap::index_adaptive, qmap::storage_aos<>,
+                             qmap::bounds_tracked<IdSec, IdExt>> map_aos_tracked;
+    typedef qmap::stripe_map<int, qmap::growth_double, qmap::index_adaptive, qmap::storage_mapped<size_t, TestDir>,
+                             qmap::bounds_tracked<IdSec, IdExt>> map_mapped_tracked;
+
+    ///Test run settings
+    struct config
+    {
+        uint64_t seed  = 11;        ///< workload generator seed
+        size_t trials  = 20;        ///< maps built per policy set
+        size_t steps   = 2000;      ///< random operations per trial
+    };
+
+    ///Returns value following --name in argv, or fallback
+    size_t
+        arg_count(int argc,
+                  char** argv,
+                  const char* name,
+                  const size_t fallback)
+    {
+        for ( int i = 1; i + 1 < argc; i++ )
+        {
+            if ( std::strcmp(argv[i], name) == 0 )
+                return std::strtoull(argv[i + 1], nullptr, 10);
+        }
+
+        return fallback;
+    };
+
+    ///Amount of entries in test_dir besides . and ..
+    size_t
+        dir_entries()
+    {
+        DIR* dir = ::opendir(test_dir.c_str());
+        if ( dir == nullptr )
+            return 1;
+
+        size_t entries = 0;
+        while ( const dirent* entry = ::readdir(dir) )
+            entries += std::strcmp(entry->d_name, ".") != 0 && std::strcmp(entry->d_name, "..") != 0;
+
+        ::closedir(dir);
+
+        return entries;
+    };
+
+    ///Sorted ( key, id ) pairs reached by for_each
+    template <typename Map>
+    pair_list
+        contents(Map& map)
+    {
+        pair_list pairs;
+        map.for_each([&](const auto& item){ pairs.push_back({ size_t(item._1), int(item._2) }); });
+
+        std::sort(pairs.begin(), pairs.end());
+
+        return pairs;
+    };
+    ///Sorted ( key, id ) pairs passed to func by query ( a query / query_bounded call on map )
+    template <typename Q>
+    pair_list
+        collect(Q&& query)
+    {
+        pair_list pairs;
+        query([&](const auto& item){ pairs.push_back({ size_t(item._1), int(item._2) }); });
+
+        std::sort(pairs.begin(), pairs.end());
+
+        return pairs;
+    };
+
+    ///Grows and shrinks a bare store - returns amount of mismatches
+    size_t
+        check_store(uti_WorkloadGenerator& gen)
+    {
+        typedef qmap::implem::items_mapped<int, TestDir> store_type;
+
+        const size_t pageslots = qmap::implem::mapped_page_bytes() / sizeof(store_type::item_type);
+        size_t mismatches = 0;
+
+        store_type store;
+        store.make(1 + gen.NextBounded(3 * pageslots));
+
+        //Unlinked as soon as it is made
+        mismatches += store._fd < 0 || dir_entries() != 0;
+
+        size_t held = 1;
+        store.put(0, store_type::item_type(7, -7));
+
+        for ( size_t round = 0; round < 40; round++ )
+        {
+            const size_t slots = 1 + gen.NextBounded(8 * pageslots);
+            if ( !store.resize(slots, held) )
+            {
+                mismatches++;
+                break;
+            }
+
+            const size_t kept = std::min(held, slots);
+
+            //Held slots survive, slots past them read as zero until written
+            for ( size_t i = 0; i < kept; i++ )
+                mismatches += store.key(i) != i * 7 + 7 || store.value(i) != -int(i * 7 + 7);
+            for ( size_t i = kept; i < slots; i++ )
+                mismatches += store.key(i) != 0 || store.value(i) != 0;
+
+            mismatches += store._bytes % qmap::implem::mapped_page_bytes() != 0 || store._bytes < slots * sizeof(store_type::item_type);
+
+            for ( size_t i = kept; i < slots; i++ )
+                store.put(i, store_type::item_type(i * 7 + 7, -int(i * 7 + 7)));
+
+            //Slots cut off by a shrink are gone - a later grow must not bring them back
+            if ( slots < held )
+            {
+                const size_t pageend = store._bytes / sizeof(store_type::item_type);
+                for ( size_t i = slots; i < pageend; i++ )
+                    store.put(i, store_type::item_type(0, 0));
+            }
+
+            held = slots;
+        }
+
+        store.release();
+        mismatches += store._items != nullptr || store._fd >= 0;
+
+        return mismatches;
+    };
+
+    ///Compares mapped with twin - returns amount of mismatches
+    template <typename Mapped, typename Twin>
+    size_t
+        check_maps(Mapped& mapped,
+                   Twin& twin,
+                   uti_WorkloadGenerator& gen,
+                   const size_t depthMax)
+    {
+        size_t mismatches = contents(mapped) != contents(twin)
+                         || mapped.size() != twin.size()
+                         || mapped.slots() != twin.slots()
+                         || mapped.query_margin() != twin.query_margin();
+
+        for ( size_t q = 0; q < 8; q++ )
+        {
+            const size_t depthMin = gen.NextBounded(depthMax + 200);
+            const size_t rangeMax = depthMin + gen.NextBounded(depthMax / 8 + 1);
+            const int64_t secMin  = int64_t(gen.NextBounded(100000));
+            const int64_t secMax  = secMin + int64_t(gen.NextBounded(20000));
+
+            mismatches += collect([&](auto&& f){ return mapped.query(depthMin, rangeMax, f); })
+                       != collect([&](auto&& f){ return twin.query(depthMin, rangeMax, f); });
+            mismatches += collect([&](auto&& f){ return mapped.query_bounded(depthMin, rangeMax, secMin, secMax, f); })
+                       != collect([&](auto&& f){ return twin.query_bounded(depthMin, rangeMax, secMin, secMax, f); });
+        }
+
+        return mismatches;
+    };
+
+    ///Runs cfg.trials random operation sequences on Mapped and its Twin - returns amount of mismatches
+    template <typename Mapped, typename Twin>
+    size_t
+        run_trials(const config& cfg,
+                   const char* name)
+    {
+        uti_WorkloadGenerator gen(cfg.seed);
+        size_t mismatches = 0;
+
+        for ( size_t trial = 0; trial < cfg.trials; trial++ )
+        {
+            mismatches += check_store(gen);
+
+            const size_t depthMax = 1000 + gen.NextBounded(1000000);
+            const size_t stripes  = 1 + gen.NextBounded(256);
+            const size_t width    = 1 + gen.NextBounded(8);
+
+            //Narrow stripes so adds restripe often
+            Mapped mapped(depthMax, stripes, width);
+            Twin twin(depthMax, stripes, width);
+            int id = 0;
+
+            std::vector<typename Twin::value_type> chunk;
+
+            for ( size_t step = 0; step < cfg.steps; step++ )
+            {
+                const uint64_t op = gen.NextBounded(100);
+
+                ///ADD ( keys reach past the axis end )
+                if ( op < 60 )
+                {
+                    const size_t key = gen.NextBounded(depthMax + 100);
+
+                    mismatches += !mapped.add(typename Mapped::value_type(key, id)) != !twin.add(typename Twin::value_type(key, id));
+                    id++;
+                }
+                ///LOAD
+                else if ( op < 64 )
+                {
+                    chunk.resize(1 + gen.NextBounded(500));
+                    for ( auto & item : chunk )
+                        item = typename Twin::value_type(gen.NextBounded(depthMax + 100), id++);
+
+                    std::vector<typename Mapped::value_type> mappedchunk;
+                    for ( const auto & item : chunk )
+                        mappedchunk.push_back(typename Mapped::value_type(item._1, item._2));
+
+                    mismatches += mapped.load(mappedchunk.data(), mappedchunk.size()) != twin.load(chunk.data(), chunk.size());
+                }
+                ///REMOVE_IF
+                else if ( op < 72 )
+                {
+                    const int mod  = 2 + int(gen.NextBounded(8));
+                    const int drop = int(gen.NextBounded(mod));
+
+                    mapped.remove_if(mapped.begin(), mapped.end(), [&](const auto& item){ return item._2 % mod == drop; });
+                    twin.remove_if(twin.begin(), twin.end(), [&](const auto& item){ return item._2 % mod == drop; });
+                }
+                ///SHRINK ( empty maps keep their slots )
+                else if ( op < 78 )
+                {
+                    mapped.shrink();
+                    twin.shrink();
+
+                    mismatches += mapped.size() != 0 && mapped.slots() != mapped.size();
+                }
+                ///CLEAR
+                else if ( op < 79 )
+                {
+                    mapped.clear();
+                    twin.clear();
+                }
+                ///CHECK
+                else
+                    mismatches += check_maps(mapped, twin, gen, depthMax);
+            }
+
+            mismatches += check_maps(mapped, twin, gen, depthMax);
+            mismatches += dir_entries() != 0;
+        }
+
+        std::printf("%s,%zu,%zu,%zu\n", name, cfg.trials, cfg.steps, mismatches);
+
+        return mismatches;
+    };
+
+};  //end of anonymous namespace
+
+int main(int argc, char** argv)
+{
+    config cfg;
+    cfg.seed   = arg_count(argc, argv, "--seed", cfg.seed);
+    cfg.trials = arg_count(argc, argv, "--trials", cfg.trials);
+    cfg.steps  = arg_count(argc, argv, "--steps", cfg.steps);
+
+    //Same place storage_mapped would pick by default
+    const char* tmpdir = std::getenv("TMPDIR");
+    std::string dir = ( tmpdir != nullptr && tmpdir[0] != '\0' ? tmpdir : "/var/tmp" ) + std::string("/stripe_map_mapped_test.XXXXXX");
+    if ( ::mkdtemp(&dir[0]) == nullptr )
+    {
+        std::printf("cannot make %s\n", dir.c_str());
+        return 1;
+    }
+    test_dir = dir;
+
+    std::printf("maps,trials,steps,mismatches\n");
+
+    size_t mismatches = 0;
+    mismatches += run_trials<map_mapped, map_aos>(cfg, "mapped");
+    mismatches += run_trials<map_mapped_u32, map_aos>(cfg, "mapped u32");
+    mismatches += run_trials<map_mapped_tracked, map_aos_tracked>(cfg, "mapped tracked");
+
+    ::rmdir(test_dir.c_str());
+
+    return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,206 @@
+///Brute force test of stripe_map::nearest
+///--- ( Random maps, some holding tombstones, answer k nearest queries by key distance and by 2D distance of items keyed by x - )
+///--- ( each answer must hold min(k, size()) distinct held items nearest first, with the same distances as the k best of a scan )
+///
+///  g++ -std=c++17 -O1 -g -fsanitize=address,undefined -Isrc/include test/stripe_map_nearest_test.cpp -o stripe_map_nearest_test
+///  ./stripe_map_nearest_test --trials 40 --items 5000 --seed 11  ( exits 1 if any answer disagrees with the scan )
+///
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include <stripe_map.hpp>
+#include <_Utilities/uti_WorkloadGenerator.h>
+
+namespace
+{
+    ///Sorted ( key, id ) pairs
+    typedef std::vector<std::pair<size_t, int>> pair_list;
+
+    typedef qmap::stripe_map<int> map_aos;
+    typedef qmap::stripe_map<int, qmap::growth_double, qmap::index_adaptive, qmap::storage_soa<uint32_t>> map_soa_u32;
+    typedef qmap::stripe_map<int, qmap::growth_double, qmap::index_shrunk, qmap::storage_handles<qmap::storage_aos<>>> map_handles_shrunk;
+
+    ///Test run settings
+    struct config
+    {
+        uint64_t seed  = 11;        ///< workload generator seed
+        size_t trials  = 40;        ///< maps built per policy set
+        size_t items   = 5000;      ///< most items per map
+    };
+
+    ///Returns value following --name in argv, or fallback
+    size_t
+        arg_count(int argc,
+                  char** argv,
+                  const char* name,
+                  const size_t fallback)
+    {
+        for ( int i = 1; i + 1 < argc; i++ )
+        {
+            if ( std::strcmp(argv[i], name) == 0 )
+                return std::strtoull(argv[i + 1], nullptr, 10);
+        }
+
+        return fallback;
+    };
+
+    ///Second coordinate of an id ( items are 2D points keyed by x )
+    inline double
+        id_y(const int id){
+        return double(( int64_t(id) * 7919 ) % 20000);
+    };
+
+    ///Key distance of key from depthKey ( ties are common, so answers are compared by distance )
+    struct key_distance
+    {
+        size_t depthKey;
+
+        inline size_t
+            operator()(const size_t key, const int) const {
+            return key > depthKey ? key - depthKey : depthKey - key;
+        };
+    };
+    ///2D distance of ( key, id_y(id) ) from ( depthKey, y ) - never below the key distance, as nearest() needs
+    struct point_distance
+    {
+        size_t depthKey;
+        double y;
+
+        inline double
+            operator()(const size_t key, const int id) const
+        {
+            const double dx = double(key) - double(depthKey);
+            const double dy = id_y(id) - y;
+
+            return std::sqrt(dx * dx + dy * dy);
+        };
+    };
+
+    ///Runs one nearest query of map against held - returns amount of mismatches
+    template <typename Map, typename D>
+    size_t
+        check_nearest(Map& map,
+                      const pair_list& held,
+                      const size_t depthKey,
+                      const size_t k,
+                      const D& distance)
+    {
+        typedef decltype(distance(size_t(0), 0)) dist_type;
+
+        pair_list answer;
+        std::vector<dist_type> answered;
+        size_t mismatches = 0;
+
+        const size_t found = map.nearest(depthKey,
+                                         k,
+                                         [&](const auto& item){ return distance(size_t(item._1), int(item._2)); },
+                                         [&](const auto& item, const dist_type dist)
+                                         {
+                                             answer.push_back({ size_t(item._1), int(item._2) });
+                                             answered.push_back(dist);
+
+                                             //Reported distance is the item's own
+                                             mismatches += dist != distance(size_t(item._1), int(item._2));
+                                         });
+
+        //Nearest first, every item held and none twice
+        mismatches += found != answer.size() || found != std::min(k, held.size());
+        mismatches += !std::is_sorted(answered.begin(), answered.end());
+
+        std::sort(answer.begin(), answer.end());
+        mismatches += std::adjacent_find(answer.begin(), answer.end()) != answer.end();
+        for ( const auto & pair : answer )
+            mismatches += !std::binary_search(held.begin(), held.end(), pair);
+
+        //Same distances as the best of a scan ( which items win a tie is up to the map )
+        std::vector<dist_type> scanned;
+        for ( const auto & pair : held )
+            scanned.push_back(distance(pair.first, pair.second));
+
+        std::sort(scanned.begin(), scanned.end());
+        scanned.resize(std::min(k, scanned.size()));
+
+        mismatches += answered != scanned;
+
+        return mismatches;
+    };
+
+    ///Runs cfg.trials maps of Map, each answering several nearest queries - returns amount of mismatches
+    template <typename Map>
+    size_t
+        run_trials(const config& cfg,
+                   const char* name)
+    {
+        uti_WorkloadGenerator gen(cfg.seed);
+        size_t mismatches = 0;
+
+        for ( size_t trial = 0; trial < cfg.trials; trial++ )
+        {
+            const size_t depthMax = 1000 + gen.NextBounded(1000000);
+
+            //Keys reach past the axis end, every 4th map clusters them so most stripes stay empty
+            Map map(depthMax, 1 + gen.NextBounded(2000), 1 + gen.NextBounded(8));
+            const size_t count   = gen.NextBounded(cfg.items + 1);
+            const size_t cluster = gen.NextBounded(depthMax);
+            for ( size_t i = 0; i < count; i++ )
+            {
+                const size_t key = trial % 4 == 3 ? cluster + gen.NextBounded(depthMax / 50 + 1)
+                                                  : gen.NextBounded(depthMax + depthMax / 8);
+                map.add(typename Map::value_type(key, int(i)));
+            }
+
+            //Every other map erases some items, half of those keeping tombstones
+            const int drop = int(gen.NextBounded(6));
+            if ( trial % 2 == 1 )
+            {
+                map.set_deferred_erase(trial % 4 == 1);
+                map.remove_if(map.begin(), map.end(), [drop](const auto& item){ return item._2 % 6 == drop; });
+            }
+
+            pair_list held;
+            map.for_each([&](const auto& item){ held.push_back({ size_t(item._1), int(item._2) }); });
+            std::sort(held.begin(), held.end());
+
+            for ( size_t q = 0; q < 40; q++ )
+            {
+                //k from a single item to more than the map holds, probes at both axis ends and past them
+                const size_t k        = q % 10 == 9 ? count + 1 + gen.NextBounded(10) : 1 + gen.NextBounded(q % 2 == 0 ? 8 : 200);
+                const size_t depthKey = q % 8 == 0 ? 0
+                                      : q % 8 == 1 ? depthMax + gen.NextBounded(depthMax)
+                                      : gen.NextBounded(depthMax);
+
+                mismatches += check_nearest(map, held, depthKey, k, key_distance{ depthKey });
+                mismatches += check_nearest(map, held, depthKey, k, point_distance{ depthKey, double(gen.NextBounded(20000)) });
+            }
+
+            mismatches += check_nearest(map, held, 0, 0, key_distance{ 0 });
+        }
+
+        std::printf("%s,%zu,%zu,%zu\n", name, cfg.trials, cfg.items, mismatches);
+
+        return mismatches;
+    };
+
+};  //end of anonymous namespace
+
+int main(int argc, char** argv)
+{
+    config cfg;
+    cfg.seed   = arg_count(argc, argv, "--seed", cfg.seed);
+    cfg.trials = arg_count(argc, argv, "--trials", cfg.trials);
+    cfg.items  = arg_count(argc, argv, "--items", cfg.items);
+
+    std::printf("maps,trials,items,mismatches\n");
+
+    size_t mismatches = 0;
+    mismatches += run_trials<map_aos>(cfg, "aos");
+    mismatches += run_trials<map_soa_u32>(cfg, "soa_u32");
+    mismatches += run_trials<map_handles_shrunk>(cfg, "handles shrunk");
+
+    return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,301 @@
+///Round trip test of stripe_map snapshots ( save() / open_mapped() )
+///--- ( Random maps of several policy sets are saved and opened into maps already holding other items - contents, query(), )
+///--- ( query_bounded() and query_margin() must match the saved map, edits to the opened map must never reach the file, and )
+///--- ( corrupt, truncated or foreign files must be rejected with the target map left untouched )
+///
+///  g++ -std=c++17 -O1 -g -fsanitize=address,undefined -Isrc/include test/stripe_map_snapshot_test.cpp -o stripe_map_snapshot_test
+///  ./stripe_map_snapshot_test --trials 20 --items 5000 --seed 11  ( exits 1 if any snapshot disagrees, needs POSIX mmap )
+///
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <unistd.h>
+
+#include <stripe_map.hpp>
+#include <_Utilities/uti_WorkloadGenerator.h>
+
+namespace
+{
+    ///Sorted ( key, id ) pairs
+    typedef std::vector<std::pair<size_t, int>> pair_list;
+
+    ///Secondary coordinate and extent of an id for the tracked set
+    struct IdSec
+    {
+        inline int64_t
+            operator()(const int id) const {
+            return ( int64_t(id) * 7919 ) % 100000;
+        };
+    };
+    struct IdExt
+    {
+        inline int64_t
+            operator()(const int id) const {
+            return id & 63;
+        };
+    };
+
+    typedef qmap::stripe_map<int> map_aos;
+    typedef qmap::stripe_map<int, qmap::growth_double, qmap::index_adaptive, qmap::storage_soa<uint32_t>> map_soa_u32;
+    typedef qmap::stripe_map<int, qmap::growth_double, qmap::index_adaptive, qmap::storage_aos<>,
+                             qmap::bounds_tracked<IdSec, IdExt>> map_tracked;
+
+    ///Test run settings
+    struct config
+    {
+        uint64_t seed  = 11;        ///< workload generator seed
+        size_t trials  = 20;        ///< maps saved per policy set
+        size_t items   = 5000;      ///< most items added per map
+        std::string dir;            ///< directory snapshot files are written to
+    };
+
+    ///Returns value following --name in argv, or fallback
+    size_t
+        arg_count(int argc,
+                  char** argv,
+                  const char* name,
+                  const size_t fallback)
+    {
+        for ( int i = 1; i + 1 < argc; i++ )
+        {
+            if ( std::strcmp(argv[i], name) == 0 )
+                return std::strtoull(argv[i + 1], nullptr, 10);
+        }
+
+        return fallback;
+    };
+
+    ///Sorted ( key, id ) pairs reached by for_each
+    template <typename Map>
+    pair_list
+        contents(Map& map)
+    {
+        pair_list pairs;
+        map.for_each([&](const auto& item){ pairs.push_back({ size_t(item._1), int(item._2) }); });
+
+        std::sort(pairs.begin(), pairs.end());
+
+        return pairs;
+    };
+    ///Sorted ( key, id ) pairs passed to func by query ( a query / query_bounded call on map )
+    template <typename Q>
+    pair_list
+        collect(Q&& query)
+    {
+        pair_list pairs;
+        query([&](const auto& item){ pairs.push_back({ size_t(item._1), int(item._2) }); });
+
+        std::sort(pairs.begin(), pairs.end());
+
+        return pairs;
+    };
+
+    ///Reads whole file at path
+    std::vector<char>
+        read_file(const std::string& path)
+    {
+        std::vector<char> bytes;
+
+        std::FILE* file = std::fopen(path.c_str(), "rb");
+        if ( file == nullptr )
+            return bytes;
+
+        char buffer[4096];
+        size_t amount;
+        while ( ( amount = std::fread(buffer, 1, sizeof(buffer), file) ) != 0 )
+            bytes.insert(bytes.end(), buffer, buffer + amount);
+
+        std::fclose(file);
+
+        return bytes;
+    };
+    ///Writes first amount bytes to file at path
+    bool
+        write_file(const std::string& path,
+                   const std::vector<char>& bytes,
+                   const size_t amount)
+    {
+        std::FILE* file = std::fopen(path.c_str(), "wb");
+        if ( file == nullptr )
+            return false;
+
+        const bool written = std::fwrite(bytes.data(), 1, amount, file) == amount;
+
+        return std::fclose(file) == 0 && written;
+    };
+
+    ///Fills map with count random items keyed in [0, depthMax) and erases some - ids count up from firstId
+    template <typename Map>
+    void
+        fill_map(Map& map,
+                 uti_WorkloadGenerator& gen,
+                 const size_t depthMax,
+                 const size_t count,
+                 const int firstId)
+    {
+        for ( size_t i = 0; i < count; i++ )
+            map.add(typename Map::value_type(gen.NextBounded(depthMax), firstId + int(i)));
+
+        const int drop = int(gen.NextBounded(8));
+        map.remove_if(map.begin(), map.end(), [drop](const auto& item){ return item._2 % 8 == drop; });
+    };
+
+    ///Opens bytes ( written to path ) into a map holding other items - returns amount of mismatches unless it is rejected untouched
+    template <typename Map>
+    size_t
+        check_rejected(const std::string& path,
+                       const std::vector<char>& bytes,
+                       const size_t amount,
+                       const bool verifyItems)
+    {
+        if ( !write_file(path, bytes, amount) )
+            return 1;
+
+        Map map(1000, 4, 2);
+        for ( int i = 0; i < 50; i++ )
+            map.add(typename Map::value_type(size_t(i) * 17, -i));
+
+        const pair_list before = contents(map);
+
+        return map.open_mapped(path.c_str(), verifyItems) || map.is_mapped() || contents(map) != before;
+    };
+
+    ///Runs cfg.trials snapshot round trips of Map - returns amount of mismatches
+    template <typename Map>
+    size_t
+        run_trials(const config& cfg,
+                   const char* name)
+    {
+        uti_WorkloadGenerator gen(cfg.seed);
+        size_t mismatches = 0;
+
+        const std::string path = cfg.dir + "/stripe_map_snapshot_test." + std::to_string(::getpid()) + ".snap";
+        const std::string bad  = path + ".bad";
+
+        for ( size_t trial = 0; trial < cfg.trials; trial++ )
+        {
+            const size_t depthMax = 1000 + gen.NextBounded(1000000);
+
+            //Every 8th map is saved empty
+            Map map(depthMax, 1 + gen.NextBounded(2000), 1 + gen.NextBounded(8));
+            if ( trial % 8 != 7 )
+                fill_map(map, gen, depthMax, 1 + gen.NextBounded(cfg.items), 0);
+
+            if ( !map.save(path.c_str()) )
+            {
+                mismatches++;
+                continue;
+            }
+
+            const pair_list saved = contents(map);
+
+            ///OPEN ( into a map that already holds items of another geometry )
+            Map opened(500, 3, 1);
+            fill_map(opened, gen, 500, 100, -1000);
+
+            if ( !opened.open_mapped(path.c_str(), trial % 2 == 0) || !opened.is_mapped() )
+            {
+                mismatches++;
+                continue;
+            }
+
+            mismatches += contents(opened) != saved
+                       || opened.size() != map.size()
+                       || opened.slots() != map.slots()
+                       || opened.stripes() != map.stripes()
+                       || opened.query_margin() != map.query_margin();
+
+            for ( size_t q = 0; q < 50; q++ )
+            {
+                const size_t depthMin = gen.NextBounded(depthMax + 100);
+                const size_t rangeMax = depthMin + gen.NextBounded(depthMax / 8 + 1);
+                const int64_t secMin  = int64_t(gen.NextBounded(100000));
+                const int64_t secMax  = secMin + int64_t(gen.NextBounded(20000));
+
+                mismatches += collect([&](auto&& f){ return opened.query(depthMin, rangeMax, f); })
+                           != collect([&](auto&& f){ return map.query(depthMin, rangeMax, f); });
+                mismatches += collect([&](auto&& f){ return opened.query_bounded(depthMin, rangeMax, secMin, secMax, f); })
+                           != collect([&](auto&& f){ return map.query_bounded(depthMin, rangeMax, secMin, secMax, f); });
+            }
+
+            ///EDIT THE OPENED MAP ( writes land in private pages - erase and shrink first, as adds restripe items out of the mapping )
+            opened.remove_if(opened.begin(), opened.end(), [](const auto& item){ return item._2 % 3 == 0; });
+            opened.shrink();
+            fill_map(opened, gen, depthMax, gen.NextBounded(cfg.items / 4 + 1), 1 << 20);
+            opened.shrink();
+
+            Map reopened;
+            if ( !reopened.open_mapped(path.c_str(), true) || contents(reopened) != saved )
+                mismatches++;
+
+            ///REJECTED FILES
+            std::vector<char> bytes = read_file(path);
+            qmap::implem::snapshot_header header;
+            std::memcpy(&header, bytes.data(), sizeof(header));
+
+            mismatches += check_rejected<Map>(bad, bytes, bytes.size() - 1, false);
+            mismatches += check_rejected<Map>(bad, bytes, sizeof(header) - 1, false);
+
+            std::vector<char> corrupt = bytes;
+            corrupt[gen.NextBounded(sizeof(header.magic))] ^= 1;
+            mismatches += check_rejected<Map>(bad, corrupt, corrupt.size(), false);
+
+            corrupt = bytes;
+            corrupt[header.stripes_offset + gen.NextBounded(header.stripe_amount * header.stripe_bytes)] ^= 0x10;
+            mismatches += check_rejected<Map>(bad, corrupt, corrupt.size(), false);
+
+            //Item damage only shows with verifyItems
+            if ( header.items_count != 0 )
+            {
+                corrupt = bytes;
+                corrupt[header.array_offset[0] + gen.NextBounded(header.items_count * header.array_stride[0])] ^= 0x10;
+                mismatches += check_rejected<Map>(bad, corrupt, corrupt.size(), true);
+
+                Map unverified;
+                mismatches += !write_file(bad, corrupt, corrupt.size()) || !unverified.open_mapped(bad.c_str(), false);
+            }
+
+            //Files of another policy set carry other layout sizes
+            if constexpr ( !std::is_same<Map, map_soa_u32>::value )
+                mismatches += check_rejected<map_soa_u32>(bad, bytes, bytes.size(), false);
+            else
+                mismatches += check_rejected<map_aos>(bad, bytes, bytes.size(), false);
+        }
+
+        Map missing;
+        mismatches += missing.open_mapped(( path + ".missing" ).c_str());
+
+        std::remove(path.c_str());
+        std::remove(bad.c_str());
+
+        std::printf("%s,%zu,%zu,%zu\n", name, cfg.trials, cfg.items, mismatches);
+
+        return mismatches;
+    };
+
+};  //end of anonymous namespace
+
+int main(int argc, char** argv)
+{
+    config cfg;
+    cfg.seed   = arg_count(argc, argv, "--seed", cfg.seed);
+    cfg.trials = arg_count(argc, argv, "--trials", cfg.trials);
+    cfg.items  = arg_count(argc, argv, "--items", cfg.items);
+
+    const char* tmpdir = std::getenv("TMPDIR");
+    cfg.dir = tmpdir != nullptr && tmpdir[0] != '\0' ? tmpdir : "/tmp";
+
+    std::printf("maps,trials,items,mismatches\n");
+
+    size_t mismatches = 0;
+    mismatches += run_trials<map_aos>(cfg, "aos");
+    mismatches += run_trials<map_soa_u32>(cfg, "soa_u32");
+    mismatches += run_trials<map_tracked>(cfg, "aos tracked");
+
+    return mismatches == 0 ? 0 : 1;
+}
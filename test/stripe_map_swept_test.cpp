@@ -0,0 +1,186 @@
+///Brute force test of stripe_map::query_swept
+///--- ( Random maps, some holding tombstones, answer sweeps forward, backward and standing still with extents from 0 to past the )
+///--- ( axis - every sweep must visit exactly the held items within extent of the swept keys, stripe by stripe in travel order, and )
+///--- ( report each item's time of entry as the first time the moving probe reaches it )
+///
+///  g++ -std=c++17 -O1 -g -fsanitize=address,undefined -Isrc/include test/stripe_map_swept_test.cpp -o stripe_map_swept_test
+///  ./stripe_map_swept_test --trials 40 --items 5000 --seed 11    ( exits 1 if any sweep disagrees with the scan )
+///
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include <stripe_map.hpp>
+#include <_Utilities/uti_WorkloadGenerator.h>
+
+namespace
+{
+    ///Sorted ( key, id ) pairs
+    typedef std::vector<std::pair<size_t, int>> pair_list;
+
+    typedef qmap::stripe_map<int> map_aos;
+    typedef qmap::stripe_map<int, qmap::growth_double, qmap::index_adaptive, qmap::storage_soa<uint32_t>> map_soa_u32;
+    typedef qmap::stripe_map<int, qmap::growth_double, qmap::index_shrunk, qmap::storage_handles<qmap::storage_aos<>>> map_handles_shrunk;
+
+    ///Test run settings
+    struct config
+    {
+        uint64_t seed  = 11;        ///< workload generator seed
+        size_t trials  = 40;        ///< maps built per policy set
+        size_t items   = 5000;      ///< most items per map
+    };
+
+    ///Returns value following --name in argv, or fallback
+    size_t
+        arg_count(int argc,
+                  char** argv,
+                  const char* name,
+                  const size_t fallback)
+    {
+        for ( int i = 1; i + 1 < argc; i++ )
+        {
+            if ( std::strcmp(argv[i], name) == 0 )
+                return std::strtoull(argv[i + 1], nullptr, 10);
+        }
+
+        return fallback;
+    };
+
+    ///First time in [0, 1] a probe of half extent moving from keyStart to keyEnd covers key ( key must be swept over )
+    double
+        entry_time(const size_t keyStart,
+                   const size_t keyEnd,
+                   const size_t extent,
+                   const size_t key)
+    {
+        const double distance = std::fabs(double(key) - double(keyStart));
+        if ( distance <= double(extent) || keyStart == keyEnd )
+            return 0.0;
+
+        return std::min(( distance - double(extent) ) / std::fabs(double(keyEnd) - double(keyStart)), 1.0);
+    };
+
+    ///Runs one sweep of map against held - returns amount of mismatches
+    template <typename Map>
+    size_t
+        check_sweep(Map& map,
+                    const pair_list& held,
+                    const size_t keyStart,
+                    const size_t keyEnd,
+                    const size_t extent)
+    {
+        const size_t sweepmin = std::min(keyStart, keyEnd);
+        const size_t sweepmax = std::max(keyStart, keyEnd);
+        const size_t depthmin = sweepmin > extent ? sweepmin - extent : 0;
+        const size_t depthmax = sweepmax < SIZE_MAX - extent ? sweepmax + extent : SIZE_MAX;
+
+        pair_list expect;
+        for ( const auto & pair : held )
+        {
+            if ( pair.first >= depthmin && pair.first <= depthmax )
+                expect.push_back(pair);
+        }
+
+        //Stripes come in travel order - keys past the axis end sit in the last stripe
+        const auto stripe_of = [&](const size_t key){ return std::min(key / map.depth(), map.stripes() - 1); };
+        const bool forward = keyEnd >= keyStart;
+
+        pair_list visited;
+        size_t laststripe = forward ? 0 : SIZE_MAX;
+        size_t mismatches = 0;
+
+        const size_t found = map.query_swept(keyStart, keyEnd, extent, [&](const auto& item, const double tEntry)
+        {
+            const size_t key    = size_t(item._1);
+            const size_t stripe = stripe_of(key);
+            visited.push_back({ key, int(item._2) });
+
+            mismatches += forward ? stripe < laststripe : stripe > laststripe;
+            laststripe = stripe;
+
+            mismatches += !( tEntry >= 0.0 && tEntry <= 1.0 )
+                       || std::fabs(tEntry - entry_time(keyStart, keyEnd, extent, key)) > 1e-9;
+        });
+
+        std::sort(visited.begin(), visited.end());
+        mismatches += found != visited.size() || visited != expect;
+
+        //Without a time argument func sees the same items
+        size_t plain = 0;
+        mismatches += map.query_swept(keyStart, keyEnd, extent, [&](const auto&){ plain++; }) != expect.size() || plain != expect.size();
+
+        return mismatches;
+    };
+
+    ///Runs cfg.trials maps of Map, each answering several sweeps - returns amount of mismatches
+    template <typename Map>
+    size_t
+        run_trials(const config& cfg,
+                   const char* name)
+    {
+        uti_WorkloadGenerator gen(cfg.seed);
+        size_t mismatches = 0;
+
+        for ( size_t trial = 0; trial < cfg.trials; trial++ )
+        {
+            const size_t depthMax = 1000 + gen.NextBounded(1000000);
+
+            //Keys reach past the axis end
+            Map map(depthMax, 1 + gen.NextBounded(2000), 1 + gen.NextBounded(8));
+            const size_t count = gen.NextBounded(cfg.items + 1);
+            for ( size_t i = 0; i < count; i++ )
+                map.add(typename Map::value_type(gen.NextBounded(depthMax + depthMax / 8), int(i)));
+
+            //Every other map erases some items, half of those keeping tombstones
+            const int drop = int(gen.NextBounded(6));
+            if ( trial % 2 == 1 )
+            {
+                map.set_deferred_erase(trial % 4 == 1);
+                map.remove_if(map.begin(), map.end(), [drop](const auto& item){ return item._2 % 6 == drop; });
+            }
+
+            pair_list held;
+            map.for_each([&](const auto& item){ held.push_back({ size_t(item._1), int(item._2) }); });
+            std::sort(held.begin(), held.end());
+
+            for ( size_t q = 0; q < 60; q++ )
+            {
+                //Sweeps of a few stripes up to the whole axis, some standing still, some past the axis end
+                const size_t keyStart = gen.NextBounded(depthMax + depthMax / 4);
+                const size_t travel   = q % 8 == 0 ? 0 : gen.NextBounded(q % 4 == 1 ? depthMax : depthMax / 16 + 1);
+                const size_t keyEnd   = q % 2 == 0 ? keyStart + travel : ( keyStart > travel ? keyStart - travel : 0 );
+                const size_t extent   = q % 16 == 3 ? SIZE_MAX - gen.NextBounded(4)
+                                      : q % 8 == 5 ? depthMax + gen.NextBounded(depthMax)
+                                      : gen.NextBounded(q % 3 == 0 ? 4 : depthMax / 100 + 1);
+
+                mismatches += check_sweep(map, held, keyStart, keyEnd, extent);
+            }
+        }
+
+        std::printf("%s,%zu,%zu,%zu\n", name, cfg.trials, cfg.items, mismatches);
+
+        return mismatches;
+    };
+
+};  //end of anonymous namespace
+
+int main(int argc, char** argv)
+{
+    config cfg;
+    cfg.seed   = arg_count(argc, argv, "--seed", cfg.seed);
+    cfg.trials = arg_count(argc, argv, "--trials", cfg.trials);
+    cfg.items  = arg_count(argc, argv, "--items", cfg.items);
+
+    std::printf("maps,trials,items,mismatches\n");
+
+    size_t mismatches = 0;
+    mismatches += run_trials<map_aos>(cfg, "aos");
+    mismatches += run_trials<map_soa_u32>(cfg, "soa_u32");
+    mismatches += run_trials<map_handles_shrunk>(cfg, "handles shrunk");
+
+    return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,318 @@
+///Fork test of stripe_publisher / stripe_reader
+///--- ( A publisher process publishes random maps while forked readers acquire them and compare contents and query() with the )
+///--- ( map they were published from - readers that _exit() or are SIGKILLed while pinned must not keep publish() from reusing )
+///--- ( their buffer once reaped, a reopened publisher must drop their pins, and their reader slots must be taken over )
+///
+///  g++ -std=c++17 -O1 -g -fsanitize=address,undefined -Isrc/include test/stripe_shared_test.cpp -o stripe_shared_test
+///  ./stripe_shared_test --trials 10 --items 20000 --seed 11      ( exits 1 if any reader or publish disagrees, needs POSIX shm )
+///
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <stripe_shared.hpp>
+#include <_Utilities/uti_WorkloadGenerator.h>
+
+namespace
+{
+    ///Sorted ( key, id ) pairs
+    typedef std::vector<std::pair<size_t, int>> pair_list;
+
+    typedef qmap::stripe_map<int> map_aos;
+    typedef qmap::stripe_map<int, qmap::growth_double, qmap::index_adaptive, qmap::storage_soa<uint32_t>> map_soa_u32;
+
+    ///How a forked reader ends
+    enum reader_end
+    {
+        END_CLOSE,      ///< closes its reader and exits
+        END_EXIT,       ///< _exit()s while pinned
+        END_KILL        ///< waits pinned until SIGKILLed
+    };
+
+    ///Test run settings
+    struct config
+    {
+        uint64_t seed  = 11;        ///< workload generator seed
+        size_t trials  = 10;        ///< maps published per policy set
+        size_t items   = 20000;     ///< most items per map
+    };
+
+    ///Returns value following --name in argv, or fallback
+    size_t
+        arg_count(int argc,
+                  char** argv,
+                  const char* name,
+                  const size_t fallback)
+    {
+        for ( int i = 1; i + 1 < argc; i++ )
+        {
+            if ( std::strcmp(argv[i], name) == 0 )
+                return std::strtoull(argv[i + 1], nullptr, 10);
+        }
+
+        return fallback;
+    };
+
+    ///Sorted ( key, id ) pairs reached by for_each
+    template <typename Map>
+    pair_list
+        contents(Map& map)
+    {
+        pair_list pairs;
+        map.for_each([&](const auto& item){ pairs.push_back({ size_t(item._1), int(item._2) }); });
+
+        std::sort(pairs.begin(), pairs.end());
+
+        return pairs;
+    };
+    ///Sorted ( key, id ) pairs passed to func by query ( a query call on map )
+    template <typename Q>
+    pair_list
+        collect(Q&& query)
+    {
+        pair_list pairs;
+        query([&](const auto& item){ pairs.push_back({ size_t(item._1), int(item._2) }); });
+
+        std::sort(pairs.begin(), pairs.end());
+
+        return pairs;
+    };
+
+    ///Compares acquired map with published one - returns amount of mismatches
+    template <typename Map>
+    size_t
+        check_acquired(Map& acquired,
+                       Map& published,
+                       uti_WorkloadGenerator& gen,
+                       const size_t depthMax)
+    {
+        size_t mismatches = contents(acquired) != contents(published) || acquired.size() != published.size();
+
+        for ( size_t q = 0; q < 20; q++ )
+        {
+            const size_t depthMin = gen.NextBounded(depthMax + 100);
+            const size_t rangeMax = depthMin + gen.NextBounded(depthMax / 8 + 1);
+
+            mismatches += collect([&](auto&& f){ return acquired.query(depthMin, rangeMax, f); })
+                       != collect([&](auto&& f){ return published.query(depthMin, rangeMax, f); });
+        }
+
+        return mismatches;
+    };
+
+    ///Forks a reader of name that acquires generation, checks it against published and ends as told - returns its pid
+    ///--- ( ready gets one byte once the reader holds its pin, or none if it failed early - exit code is its mismatch count )
+    template <typename Map>
+    pid_t
+        fork_reader(const char* name,
+                    Map& published,
+                    const uint64_t generation,
+                    const uint64_t seed,
+                    const size_t depthMax,
+                    const reader_end end,
+                    int& ready)
+    {
+        int fds[2];
+        if ( ::pipe(fds) != 0 )
+            return -1;
+
+        const pid_t pid = ::fork();
+        if ( pid != 0 )
+        {
+            ::close(fds[1]);
+            ready = fds[0];
+
+            return pid;
+        }
+
+        ::close(fds[0]);
+
+        uti_WorkloadGenerator gen(seed);
+        qmap::stripe_reader<Map> reader;
+
+        size_t mismatches = !reader.open(name) || !reader.acquire() || reader.generation() != generation;
+        if ( mismatches == 0 )
+            mismatches = check_acquired(reader.map(), published, gen, depthMax);
+
+        const char byte = 1;
+        if ( mismatches == 0 && ::write(fds[1], &byte, 1) != 1 )
+            mismatches++;
+
+        if ( end == END_KILL && mismatches == 0 )
+        {
+            for ( ;; )
+                ::pause();
+        }
+        if ( end == END_CLOSE )
+            reader.close();
+
+        //Skips destructors and atexit handlers - the pin is left exactly as a crash would leave it
+        ::_exit(int(std::min<size_t>(mismatches, 100)));
+    };
+    ///Waits for a reader's ready byte - returns false if it failed before pinning
+    bool
+        wait_ready(const int ready)
+    {
+        char byte = 0;
+        const bool pinned = ::read(ready, &byte, 1) == 1;
+        ::close(ready);
+
+        return pinned;
+    };
+    ///Reaps reader pid - returns amount of mismatches it reported ( killed readers report none )
+    size_t
+        reap(const pid_t pid,
+             const bool killed)
+    {
+        int status = 0;
+        if ( pid < 0 || ::waitpid(pid, &status, 0) != pid )
+            return 1;
+
+        if ( killed )
+            return !WIFSIGNALED(status);
+
+        return !WIFEXITED(status) ? 1 : size_t(WEXITSTATUS(status));
+    };
+
+    ///Fills map with count random items keyed past the axis end - ids count up from firstId
+    template <typename Map>
+    void
+        fill_map(Map& map,
+                 uti_WorkloadGenerator& gen,
+                 const size_t depthMax,
+                 const size_t count,
+                 const int firstId)
+    {
+        map.clear();
+        for ( size_t i = 0; i < count; i++ )
+            map.add(typename Map::value_type(gen.NextBounded(depthMax + 100), firstId + int(i)));
+    };
+
+    ///Runs cfg.trials publications of Map with forked readers - returns amount of mismatches
+    template <typename Map>
+    size_t
+        run_trials(const config& cfg,
+                   const char* name)
+    {
+        uti_WorkloadGenerator gen(cfg.seed);
+        size_t mismatches = 0;
+
+        const std::string segment = "/stripe_shared_test." + std::to_string(::getpid());
+        qmap::stripe_publisher<Map>::remove(segment.c_str());
+
+        qmap::stripe_publisher<Map> publisher;
+        if ( !publisher.open(segment.c_str()) )
+        {
+            std::printf("%s,cannot open %s\n", name, segment.c_str());
+            return 1;
+        }
+
+        for ( size_t trial = 0; trial < cfg.trials; trial++ )
+        {
+            const size_t depthMax = 1000 + gen.NextBounded(1000000);
+            int ready;
+
+            Map map(depthMax, 1 + gen.NextBounded(2000), 1 + gen.NextBounded(8));
+            fill_map(map, gen, depthMax, gen.NextBounded(cfg.items + 1), 0);
+
+            ///PUBLISH AND ACQUIRE ( in this process and in a reader that closes cleanly )
+            mismatches += !publisher.publish(map);
+            const uint64_t pinned = publisher.generation();
+            const size_t buffer   = size_t(pinned & 1);
+
+            {
+                qmap::stripe_reader<Map> reader;
+                mismatches += !reader.open(segment.c_str()) || !reader.acquire() || reader.generation() != pinned;
+                mismatches += check_acquired(reader.map(), map, gen, depthMax);
+            }
+
+            const pid_t closing = fork_reader(segment.c_str(), map, pinned, gen.NextBounded(1 << 30), depthMax, END_CLOSE, ready);
+            mismatches += !wait_ready(ready) || reap(closing, false) != 0 || publisher.pins(buffer) != 0;
+
+            ///READER KILLED WHILE PINNED ( blocks the buffer while it lives, not once it is reaped )
+            const pid_t killed = fork_reader(segment.c_str(), map, pinned, gen.NextBounded(1 << 30), depthMax, END_KILL, ready);
+            mismatches += !wait_ready(ready) || publisher.pins(buffer) != 1;
+
+            Map next(depthMax, 1 + gen.NextBounded(2000), 1 + gen.NextBounded(8));
+            fill_map(next, gen, depthMax, gen.NextBounded(cfg.items + 1), 1 << 20);
+
+            mismatches += !publisher.publish(next);     // other buffer
+            mismatches += publisher.publish(next) || publisher.generation() != pinned + 1;
+
+            ::kill(killed, SIGKILL);
+            mismatches += reap(killed, true);
+
+            mismatches += !publisher.publish(next) || publisher.generation() != pinned + 2 || publisher.pins(buffer) != 0;
+
+            ///READER EXITING WHILE PINNED ( reclaimed by the next publish() )
+            const uint64_t exitgen = publisher.generation();
+            const pid_t exiting = fork_reader(segment.c_str(), next, exitgen, gen.NextBounded(1 << 30), depthMax, END_EXIT, ready);
+            mismatches += !wait_ready(ready) || reap(exiting, false) != 0 || publisher.pins(size_t(exitgen & 1)) != 1;
+
+            mismatches += !publisher.publish(map) || !publisher.publish(map) || publisher.pins(size_t(exitgen & 1)) != 0;
+
+            ///PUBLISHER REOPENED OVER A DEAD READER'S PIN ( open() drops it, generations carry on )
+            const uint64_t reopengen = publisher.generation();
+            const pid_t dropped = fork_reader(segment.c_str(), map, reopengen, gen.NextBounded(1 << 30), depthMax, END_EXIT, ready);
+            mismatches += !wait_ready(ready) || reap(dropped, false) != 0;
+
+            publisher.close();
+            mismatches += !publisher.open(segment.c_str()) || publisher.generation() != reopengen
+                       || publisher.pins(size_t(reopengen & 1)) != 0;
+
+            ///READER SLOTS ( all taken, then one freed by a reader that died )
+            if ( trial == 0 )
+            {
+                std::vector<std::unique_ptr<qmap::stripe_reader<Map>>> readers;
+                for ( size_t i = 0; i + 1 < qmap::implem::SMAP_SHARED_READER_MAX; i++ )
+                {
+                    readers.emplace_back(new qmap::stripe_reader<Map>());
+                    mismatches += !readers.back()->open(segment.c_str());
+                }
+
+                const pid_t last = fork_reader(segment.c_str(), map, reopengen, gen.NextBounded(1 << 30), depthMax, END_KILL, ready);
+                mismatches += !wait_ready(ready);
+
+                qmap::stripe_reader<Map> extra;
+                mismatches += extra.open(segment.c_str());
+
+                ::kill(last, SIGKILL);
+                mismatches += reap(last, true);
+                mismatches += !extra.open(segment.c_str()) || !extra.acquire() || extra.generation() != reopengen;
+            }
+        }
+
+        publisher.close();
+        qmap::stripe_publisher<Map>::remove(segment.c_str());
+
+        std::printf("%s,%zu,%zu,%zu\n", name, cfg.trials, cfg.items, mismatches);
+
+        return mismatches;
+    };
+
+};  //end of anonymous namespace
+
+int main(int argc, char** argv)
+{
+    config cfg;
+    cfg.seed   = arg_count(argc, argv, "--seed", cfg.seed);
+    cfg.trials = arg_count(argc, argv, "--trials", cfg.trials);
+    cfg.items  = arg_count(argc, argv, "--items", cfg.items);
+
+    std::printf("maps,trials,items,mismatches\n");
+
+    size_t mismatches = 0;
+    mismatches += run_trials<map_aos>(cfg, "aos");
+    mismatches += run_trials<map_soa_u32>(cfg, "soa_u32");
+
+    return mismatches == 0 ? 0 : 1;
+}